@@ -0,0 +1,313 @@
+#include "Aig.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Aig::Aig() {
+  // Node 0 is constant false
+  fanin0.push_back(NO_FANIN);
+  fanin1.push_back(NO_FANIN);
+  levels.push_back(0);
+}
+
+uint32_t Aig::addInput(const std::string &inputName) {
+  uint32_t node = nodeCount();
+  fanin0.push_back(NO_FANIN);
+  fanin1.push_back(NO_FANIN);
+  levels.push_back(0);
+  inputs.push_back(node);
+  inputNames.push_back(inputName);
+  return literal(node);
+}
+
+uint32_t Aig::addAnd(uint32_t a, uint32_t b) {
+  if (a > b) {
+    std::swap(a, b);
+  }
+
+  // Trivial cases, relying on the constant being the smallest literal
+  if (a == FALSE_LITERAL || a == (b ^ 1)) {
+    return FALSE_LITERAL;
+  }
+  if (a == TRUE_LITERAL || a == b) {
+    return b;
+  }
+
+  uint64_t key = (static_cast<uint64_t>(a) << 32) | b;
+  auto found = strash.find(key);
+  if (found != strash.end()) {
+    return literal(found->second);
+  }
+
+  uint32_t node = nodeCount();
+  fanin0.push_back(a);
+  fanin1.push_back(b);
+  levels.push_back(1 + std::max(levels[nodeOf(a)], levels[nodeOf(b)]));
+  strash.emplace(key, node);
+  return literal(node);
+}
+
+uint32_t Aig::addOr(uint32_t a, uint32_t b) {
+  return addAnd(a ^ 1, b ^ 1) ^ 1;
+}
+
+uint32_t Aig::addXor(uint32_t a, uint32_t b) {
+  // a ^ b = ~(a & b) & ~(~a & ~b)
+  return addAnd(addAnd(a, b) ^ 1, addAnd(a ^ 1, b ^ 1) ^ 1);
+}
+
+uint32_t Aig::addGate(GateType type, const uint32_t *literals, size_t count) {
+  switch (type) {
+  case GateType::CONST0:
+    return FALSE_LITERAL;
+  case GateType::CONST1:
+    return TRUE_LITERAL;
+  case GateType::NOT:
+    return literals[0] ^ 1;
+  case GateType::INPUT:
+    throw std::invalid_argument("Inputs are added with Aig::addInput");
+  default:
+    break;
+  }
+
+  // Gates other than NOT reduce their fanins with AND, OR or XOR and
+  // optionally invert the result, like the netlist simulator does
+  bool invert = type == GateType::NAND || type == GateType::NOR ||
+                type == GateType::XNOR;
+  uint32_t value;
+
+  switch (type) {
+  case GateType::AND:
+  case GateType::NAND:
+    value = TRUE_LITERAL;
+    for (size_t i = 0; i < count; i++) {
+      value = addAnd(value, literals[i]);
+    }
+    break;
+  case GateType::OR:
+  case GateType::NOR:
+    value = FALSE_LITERAL;
+    for (size_t i = 0; i < count; i++) {
+      value = addOr(value, literals[i]);
+    }
+    break;
+  default:
+    value = FALSE_LITERAL;
+    for (size_t i = 0; i < count; i++) {
+      value = addXor(value, literals[i]);
+    }
+    break;
+  }
+
+  return invert ? value ^ 1 : value;
+}
+
+std::vector<uint32_t> Aig::addNetlist(const Netlist &netlist,
+                                      const uint32_t *inputLiterals) {
+  std::vector<uint32_t> map(netlist.nodeCount());
+  for (size_t i = 0; i < netlist.inputs.size(); i++) {
+    map[netlist.inputs[i]] = inputLiterals[i];
+  }
+
+  std::vector<uint32_t> literals;
+  for (uint32_t id = 0; id < netlist.nodeCount(); id++) {
+    if (netlist.types[id] == GateType::INPUT) {
+      continue;
+    }
+
+    const uint32_t *fanin = netlist.faninBegin(id);
+    uint32_t count = netlist.faninCount(id);
+    literals.clear();
+    for (uint32_t i = 0; i < count; i++) {
+      literals.push_back(map[fanin[i]]);
+    }
+    map[id] = addGate(netlist.types[id], literals.data(), count);
+  }
+
+  std::vector<uint32_t> results;
+  for (uint32_t output : netlist.outputs) {
+    results.push_back(map[output]);
+  }
+  return results;
+}
+
+Aig Aig::fromNetlist(const Netlist &netlist) {
+  Aig aig;
+  aig.name = netlist.name;
+
+  std::vector<uint32_t> inputLiterals;
+  for (const auto &inputName : netlist.inputNames) {
+    inputLiterals.push_back(aig.addInput(inputName));
+  }
+  aig.outputs = aig.addNetlist(netlist, inputLiterals.data());
+  return aig;
+}
+
+Netlist Aig::toNetlist() const {
+  // Count how each node is used to pick the polarity it is stored in
+  std::vector<uint32_t> plainUses(nodeCount(), 0);
+  std::vector<uint32_t> invertedUses(nodeCount(), 0);
+  auto countUse = [&](uint32_t lit) {
+    (isComplemented(lit) ? invertedUses : plainUses)[nodeOf(lit)]++;
+  };
+  for (uint32_t node = 0; node < nodeCount(); node++) {
+    if (isAnd(node)) {
+      countUse(fanin0[node]);
+      countUse(fanin1[node]);
+    }
+  }
+  for (uint32_t output : outputs) {
+    countUse(output);
+  }
+
+  // ~(p & q) & ~(~p & ~q) is p ^ q. When nothing else uses the two inner
+  // ANDs, the three nodes lower to a single XOR gate.
+  std::vector<bool> isXor(nodeCount(), false);
+  std::vector<bool> absorbed(nodeCount(), false);
+  for (uint32_t node = 0; node < nodeCount(); node++) {
+    if (!isAnd(node) || !isComplemented(fanin0[node]) ||
+        !isComplemented(fanin1[node])) {
+      continue;
+    }
+    uint32_t x = nodeOf(fanin0[node]);
+    uint32_t y = nodeOf(fanin1[node]);
+    if (isAnd(x) && isAnd(y) && fanin0[y] == (fanin0[x] ^ 1) &&
+        fanin1[y] == (fanin1[x] ^ 1)) {
+      isXor[node] = true;
+      absorbed[x] = invertedUses[x] + plainUses[x] == 1;
+      absorbed[y] = invertedUses[y] + plainUses[y] == 1;
+    }
+  }
+
+  Netlist netlist;
+  netlist.name = name;
+
+  std::vector<uint32_t> ids(nodeCount());      // Netlist node of each node
+  std::vector<bool> stored(nodeCount(), false); // Stored complemented
+  std::vector<uint32_t> inverters(nodeCount(), NO_FANIN);
+
+  // Netlist node carrying the literal's value, adding a NOT gate when it is
+  // needed in the other polarity
+  auto valueOf = [&](uint32_t lit) {
+    uint32_t node = nodeOf(lit);
+    if (isComplemented(lit) == stored[node]) {
+      return ids[node];
+    }
+    if (inverters[node] == NO_FANIN) {
+      inverters[node] = netlist.addGate(GateType::NOT, &ids[node], 1);
+    }
+    return inverters[node];
+  };
+
+  ids[0] = netlist.addConstant(false);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    ids[inputs[i]] = netlist.addInput(inputNames[i]);
+  }
+
+  for (uint32_t node = 0; node < nodeCount(); node++) {
+    if (!isAnd(node) || absorbed[node]) {
+      continue;
+    }
+
+    bool invert = invertedUses[node] > plainUses[node];
+
+    if (isXor[node]) {
+      // Operands needed in the other polarity flip the XOR instead
+      uint32_t x = nodeOf(fanin0[node]);
+      uint32_t p = nodeOf(fanin0[x]);
+      uint32_t q = nodeOf(fanin1[x]);
+      bool flip = (isComplemented(fanin0[x]) != stored[p]) !=
+                  (isComplemented(fanin1[x]) != stored[q]);
+      uint32_t operands[2] = {ids[p], ids[q]};
+      GateType type = flip == invert ? GateType::XOR : GateType::XNOR;
+      ids[node] = netlist.addGate(type, operands, 2);
+      stored[node] = invert;
+      continue;
+    }
+
+    // Both fanins needed inverted relative to how they are stored turns
+    // a & b into a NOR, and ~(a & b) into an OR
+    uint32_t a = nodeOf(fanin0[node]);
+    uint32_t b = nodeOf(fanin1[node]);
+    bool flipA = isComplemented(fanin0[node]) != stored[a];
+    bool flipB = isComplemented(fanin1[node]) != stored[b];
+
+    uint32_t operands[2];
+    GateType type;
+    if (flipA && flipB) {
+      operands[0] = ids[a];
+      operands[1] = ids[b];
+      type = invert ? GateType::OR : GateType::NOR;
+    } else {
+      operands[0] = valueOf(fanin0[node]);
+      operands[1] = valueOf(fanin1[node]);
+      type = invert ? GateType::NAND : GateType::AND;
+    }
+
+    ids[node] = netlist.addGate(type, operands, 2);
+    stored[node] = invert;
+  }
+
+  for (uint32_t output : outputs) {
+    if (output == TRUE_LITERAL) {
+      netlist.outputs.push_back(netlist.addConstant(true));
+    } else {
+      netlist.outputs.push_back(valueOf(output));
+    }
+  }
+
+  return netlist;
+}
+
+Aig Aig::compact() const {
+  std::vector<bool> live(nodeCount(), false);
+  for (uint32_t output : outputs) {
+    live[nodeOf(output)] = true;
+  }
+  for (uint32_t node = nodeCount(); node-- > 0;) {
+    if (live[node] && isAnd(node)) {
+      live[nodeOf(fanin0[node])] = true;
+      live[nodeOf(fanin1[node])] = true;
+    }
+  }
+
+  Aig result;
+  result.name = name;
+
+  std::vector<uint32_t> map(nodeCount(), FALSE_LITERAL);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    map[inputs[i]] = result.addInput(inputNames[i]);
+  }
+  auto remap = [&](uint32_t lit) {
+    return map[nodeOf(lit)] ^ (lit & 1);
+  };
+
+  for (uint32_t node = 0; node < nodeCount(); node++) {
+    if (live[node] && isAnd(node)) {
+      map[node] = result.addAnd(remap(fanin0[node]), remap(fanin1[node]));
+    }
+  }
+  for (uint32_t output : outputs) {
+    result.outputs.push_back(remap(output));
+  }
+
+  return result;
+}
+
+size_t Aig::andCount() const {
+  size_t count = 0;
+  for (uint32_t node = 0; node < nodeCount(); node++) {
+    if (isAnd(node)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint32_t Aig::depth() const {
+  uint32_t deepest = 0;
+  for (uint32_t output : outputs) {
+    deepest = std::max(deepest, levels[nodeOf(output)]);
+  }
+  return deepest;
+}
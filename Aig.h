@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Netlist.h"
+
+// And-Inverter Graph: every node is constant false, a primary input or a
+// two-input AND, and every edge may be complemented. An edge is a literal,
+// 2 * node + complement, so literal 0 is false and literal 1 is true.
+//
+// Nodes are created through addAnd, which folds trivial cases (x & 0,
+// x & 1, x & x, x & ~x) and structurally hashes the ordered fanin pair, so
+// there is never more than one node for the same AND. Node IDs are
+// topologically ordered like Netlist IDs.
+class Aig {
+public:
+  static constexpr uint32_t FALSE_LITERAL = 0;
+  static constexpr uint32_t TRUE_LITERAL = 1;
+  static constexpr uint32_t NO_FANIN = UINT32_MAX;
+
+  static uint32_t literal(uint32_t node, bool complement = false) {
+    return node * 2 + complement;
+  }
+  static uint32_t nodeOf(uint32_t literal) { return literal >> 1; }
+  static bool isComplemented(uint32_t literal) { return literal & 1; }
+
+  std::string name;
+
+  // Fanin literals of AND nodes, NO_FANIN for the constant and inputs
+  std::vector<uint32_t> fanin0;
+  std::vector<uint32_t> fanin1;
+  std::vector<uint32_t> levels; // Longest path from an input, in ANDs
+
+  std::vector<uint32_t> inputs; // Input node IDs, in parameter order
+  std::vector<std::string> inputNames;
+  std::vector<uint32_t> outputs; // Output literals
+
+  Aig();
+
+  uint32_t addInput(const std::string &inputName);
+  uint32_t addAnd(uint32_t a, uint32_t b);
+  uint32_t addOr(uint32_t a, uint32_t b);
+  uint32_t addXor(uint32_t a, uint32_t b);
+  uint32_t addGate(GateType type, const uint32_t *literals, size_t count);
+
+  // Adds a netlist's logic with its inputs bound to the given literals and
+  // returns the literals of its outputs. Sharing one Aig between two
+  // netlists puts both in the same normal form.
+  std::vector<uint32_t> addNetlist(const Netlist &netlist,
+                                   const uint32_t *inputLiterals);
+
+  static Aig fromNetlist(const Netlist &netlist);
+
+  // Lowers to a netlist for the simulators. Each AND node becomes one gate,
+  // stored inverted when most of its fanouts use it complemented, so most
+  // complemented edges cost nothing.
+  Netlist toNetlist() const;
+
+  // Copy without the nodes no output depends on
+  Aig compact() const;
+
+  bool isAnd(uint32_t node) const { return fanin0[node] != NO_FANIN; }
+  size_t nodeCount() const { return fanin0.size(); }
+  size_t andCount() const;
+  uint32_t depth() const;
+
+private:
+  std::unordered_map<uint64_t, uint32_t> strash;
+};
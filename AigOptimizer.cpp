@@ -0,0 +1,444 @@
+#include "AigOptimizer.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace aigopt {
+
+namespace {
+
+// Truth tables of the four cut leaves over 16 minterms
+const uint16_t VARIABLES[4] = {0xAAAA, 0xCCCC, 0xF0F0, 0xFF00};
+const uint16_t ALL_ONES = 0xFFFF;
+
+struct Cut {
+  uint8_t size;
+  uint32_t leaves[4]; // Sorted node IDs
+  uint16_t truth;     // Function of the node over the leaves
+};
+
+// Ways to implement a function of up to four variables. All of them split
+// on one variable v and recurse into the cofactors f0 = f(v=0), f1 = f(v=1).
+enum class Split : uint8_t {
+  CONSTANT,
+  VARIABLE,
+  AND_POSITIVE, // f0 == 0: v & f1
+  AND_NEGATIVE, // f1 == 0: ~v & f0
+  OR_NEGATIVE,  // f0 == 1: ~v | f1
+  OR_POSITIVE,  // f1 == 1: v | f0
+  XOR,          // f1 == ~f0: v ^ f0
+  OR_AND_HIGH,  // f0 implies f1: f0 | (v & f1)
+  OR_AND_LOW,   // f1 implies f0: f1 | (~v & f0)
+  MUX,          // (v & f1) | (~v & f0)
+};
+
+struct Choice {
+  int8_t cost = -1; // AND nodes, not counting sharing between cofactors
+  Split split = Split::CONSTANT;
+  uint8_t variable = 0;
+};
+
+uint16_t cofactor0(uint16_t truth, int v) {
+  uint16_t low = truth & ~VARIABLES[v];
+  return low | (low << (1 << v));
+}
+
+uint16_t cofactor1(uint16_t truth, int v) {
+  uint16_t high = truth & VARIABLES[v];
+  return high | (high >> (1 << v));
+}
+
+class Rewriter {
+private:
+  const Aig &aig;
+  Aig out;
+
+  std::vector<uint32_t> map; // Old node -> literal in `out`
+  std::vector<uint32_t> references;
+  std::vector<uint32_t> cutStart{0}; // Node i's cuts: [start[i], start[i+1])
+  std::vector<Cut> cuts;
+  std::vector<Choice> choices; // Memoized by truth table
+
+  static constexpr size_t MAX_CUTS = 8; // Per node, besides the trivial cut
+
+  const Choice &choose(uint16_t truth);
+  uint32_t build(uint16_t truth, const uint32_t *leaves);
+  void enumerateCuts(uint32_t node);
+  uint16_t expand(const Cut &from, const Cut &to, bool complement) const;
+  uint32_t dereference(uint32_t node, const Cut &cut);
+  void reference(uint32_t node, const Cut &cut);
+
+public:
+  Rewriter(const Aig &aig) : aig(aig), choices(1 << 16) {}
+
+  Aig run();
+};
+
+const Choice &Rewriter::choose(uint16_t truth) {
+  Choice &choice = choices[truth];
+  if (choice.cost >= 0) {
+    return choice;
+  }
+
+  if (truth == 0 || truth == ALL_ONES) {
+    choice = {0, Split::CONSTANT, 0};
+    return choice;
+  }
+  for (int v = 0; v < 4; v++) {
+    if (truth == VARIABLES[v] || truth == static_cast<uint16_t>(~VARIABLES[v])) {
+      choice = {0, Split::VARIABLE, static_cast<uint8_t>(v)};
+      return choice;
+    }
+  }
+
+  Choice best;
+  best.cost = INT8_MAX;
+  auto consider = [&](int cost, Split split, int v) {
+    if (cost < best.cost) {
+      best = {static_cast<int8_t>(cost), split, static_cast<uint8_t>(v)};
+    }
+  };
+
+  for (int v = 0; v < 4; v++) {
+    uint16_t f0 = cofactor0(truth, v);
+    uint16_t f1 = cofactor1(truth, v);
+    if (f0 == f1) {
+      continue; // Not in the support
+    }
+
+    if (f0 == 0) {
+      consider(1 + choose(f1).cost, Split::AND_POSITIVE, v);
+    } else if (f1 == 0) {
+      consider(1 + choose(f0).cost, Split::AND_NEGATIVE, v);
+    } else if (f0 == ALL_ONES) {
+      consider(1 + choose(f1).cost, Split::OR_NEGATIVE, v);
+    } else if (f1 == ALL_ONES) {
+      consider(1 + choose(f0).cost, Split::OR_POSITIVE, v);
+    } else if (f1 == static_cast<uint16_t>(~f0)) {
+      consider(3 + choose(f0).cost, Split::XOR, v);
+    } else if ((f0 & ~f1) == 0) {
+      consider(2 + choose(f0).cost + choose(f1).cost, Split::OR_AND_HIGH, v);
+    } else if ((f1 & ~f0) == 0) {
+      consider(2 + choose(f0).cost + choose(f1).cost, Split::OR_AND_LOW, v);
+    } else {
+      consider(3 + choose(f0).cost + choose(f1).cost, Split::MUX, v);
+    }
+  }
+
+  choices[truth] = best;
+  return choices[truth];
+}
+
+uint32_t Rewriter::build(uint16_t truth, const uint32_t *leaves) {
+  Choice choice = choose(truth);
+  int v = choice.variable;
+  uint32_t var = leaves[v];
+
+  switch (choice.split) {
+  case Split::CONSTANT:
+    return truth == 0 ? Aig::FALSE_LITERAL : Aig::TRUE_LITERAL;
+  case Split::VARIABLE:
+    return truth == VARIABLES[v] ? var : var ^ 1;
+  case Split::AND_POSITIVE:
+    return out.addAnd(var, build(cofactor1(truth, v), leaves));
+  case Split::AND_NEGATIVE:
+    return out.addAnd(var ^ 1, build(cofactor0(truth, v), leaves));
+  case Split::OR_NEGATIVE:
+    return out.addOr(var ^ 1, build(cofactor1(truth, v), leaves));
+  case Split::OR_POSITIVE:
+    return out.addOr(var, build(cofactor0(truth, v), leaves));
+  case Split::XOR:
+    return out.addXor(var, build(cofactor0(truth, v), leaves));
+  case Split::OR_AND_HIGH: {
+    uint32_t high = build(cofactor1(truth, v), leaves);
+    uint32_t low = build(cofactor0(truth, v), leaves);
+    return out.addOr(low, out.addAnd(var, high));
+  }
+  case Split::OR_AND_LOW: {
+    uint32_t high = build(cofactor1(truth, v), leaves);
+    uint32_t low = build(cofactor0(truth, v), leaves);
+    return out.addOr(high, out.addAnd(var ^ 1, low));
+  }
+  case Split::MUX:
+  default: {
+    uint32_t high = build(cofactor1(truth, v), leaves);
+    uint32_t low = build(cofactor0(truth, v), leaves);
+    return out.addOr(out.addAnd(var, high), out.addAnd(var ^ 1, low));
+  }
+  }
+}
+
+// Re-expresses a cut's truth table over the leaves of a larger cut
+uint16_t Rewriter::expand(const Cut &from, const Cut &to,
+                          bool complement) const {
+  int position[4];
+  for (int i = 0; i < from.size; i++) {
+    position[i] = std::find(to.leaves, to.leaves + to.size, from.leaves[i]) -
+                  to.leaves;
+  }
+
+  uint16_t truth = 0;
+  for (int m = 0; m < 16; m++) {
+    int sub = 0;
+    for (int i = 0; i < from.size; i++) {
+      sub |= ((m >> position[i]) & 1) << i;
+    }
+    truth |= ((from.truth >> sub) & 1) << m;
+  }
+  return complement ? ~truth : truth;
+}
+
+void Rewriter::enumerateCuts(uint32_t node) {
+  size_t first = cuts.size();
+
+  if (aig.isAnd(node)) {
+    uint32_t a = aig.fanin0[node];
+    uint32_t b = aig.fanin1[node];
+    uint32_t na = Aig::nodeOf(a);
+    uint32_t nb = Aig::nodeOf(b);
+
+    for (uint32_t i = cutStart[na]; i < cutStart[na + 1]; i++) {
+      for (uint32_t j = cutStart[nb]; j < cutStart[nb + 1]; j++) {
+        // Copies, since cuts grows while merging
+        Cut ca = cuts[i];
+        Cut cb = cuts[j];
+
+        Cut merged;
+        uint32_t leaves[8];
+        uint32_t *end = std::set_union(ca.leaves, ca.leaves + ca.size,
+                                       cb.leaves, cb.leaves + cb.size, leaves);
+        if (end - leaves > 4) {
+          continue;
+        }
+        merged.size = end - leaves;
+        std::copy(leaves, end, merged.leaves);
+
+        // Skip cuts dominated by one already kept, and drop kept cuts this
+        // one dominates
+        bool dominated = false;
+        for (size_t k = first; k < cuts.size() && !dominated; k++) {
+          dominated = std::includes(merged.leaves, merged.leaves + merged.size,
+                                    cuts[k].leaves,
+                                    cuts[k].leaves + cuts[k].size);
+        }
+        if (dominated) {
+          continue;
+        }
+        for (size_t k = cuts.size(); k-- > first;) {
+          if (std::includes(cuts[k].leaves, cuts[k].leaves + cuts[k].size,
+                            merged.leaves, merged.leaves + merged.size)) {
+            cuts.erase(cuts.begin() + k);
+          }
+        }
+
+        if (cuts.size() - first >= MAX_CUTS) {
+          continue;
+        }
+
+        merged.truth = expand(ca, merged, Aig::isComplemented(a)) &
+                       expand(cb, merged, Aig::isComplemented(b));
+        cuts.push_back(merged);
+      }
+    }
+  }
+
+  // The trivial cut lets fanouts use the node itself as a leaf
+  Cut trivial;
+  if (node == 0) {
+    trivial.size = 0;
+    trivial.truth = 0;
+  } else {
+    trivial.size = 1;
+    trivial.leaves[0] = node;
+    trivial.truth = VARIABLES[0];
+  }
+  cuts.push_back(trivial);
+  cutStart.push_back(cuts.size());
+}
+
+// Size of the node's maximum fanout-free cone down to the cut: the nodes
+// that would become dead if the node were reimplemented from the leaves
+uint32_t Rewriter::dereference(uint32_t node, const Cut &cut) {
+  uint32_t count = 1;
+  for (uint32_t lit : {aig.fanin0[node], aig.fanin1[node]}) {
+    uint32_t fanin = Aig::nodeOf(lit);
+    if (!aig.isAnd(fanin) ||
+        std::find(cut.leaves, cut.leaves + cut.size, fanin) !=
+            cut.leaves + cut.size) {
+      continue;
+    }
+    if (--references[fanin] == 0) {
+      count += dereference(fanin, cut);
+    }
+  }
+  return count;
+}
+
+void Rewriter::reference(uint32_t node, const Cut &cut) {
+  for (uint32_t lit : {aig.fanin0[node], aig.fanin1[node]}) {
+    uint32_t fanin = Aig::nodeOf(lit);
+    if (!aig.isAnd(fanin) ||
+        std::find(cut.leaves, cut.leaves + cut.size, fanin) !=
+            cut.leaves + cut.size) {
+      continue;
+    }
+    if (references[fanin]++ == 0) {
+      reference(fanin, cut);
+    }
+  }
+}
+
+Aig Rewriter::run() {
+  out = Aig();
+  out.name = aig.name;
+  map.assign(aig.nodeCount(), Aig::FALSE_LITERAL);
+  for (size_t i = 0; i < aig.inputs.size(); i++) {
+    map[aig.inputs[i]] = out.addInput(aig.inputNames[i]);
+  }
+
+  references.assign(aig.nodeCount(), 0);
+  for (uint32_t node = 0; node < aig.nodeCount(); node++) {
+    if (aig.isAnd(node)) {
+      references[Aig::nodeOf(aig.fanin0[node])]++;
+      references[Aig::nodeOf(aig.fanin1[node])]++;
+    }
+  }
+  for (uint32_t output : aig.outputs) {
+    references[Aig::nodeOf(output)]++;
+  }
+
+  auto remap = [&](uint32_t lit) {
+    return map[Aig::nodeOf(lit)] ^ (lit & 1);
+  };
+
+  for (uint32_t node = 0; node < aig.nodeCount(); node++) {
+    enumerateCuts(node);
+    if (!aig.isAnd(node)) {
+      continue;
+    }
+
+    // The last cut is the trivial one
+    const Cut *best = nullptr;
+    int bestGain = 0;
+    for (uint32_t i = cutStart[node]; i + 1 < cutStart[node + 1]; i++) {
+      const Cut &cut = cuts[i];
+      int cost = choose(cut.truth).cost;
+      int freed = dereference(node, cut);
+      reference(node, cut);
+      if (freed - cost > bestGain) {
+        bestGain = freed - cost;
+        best = &cut;
+      }
+    }
+
+    if (best != nullptr) {
+      uint32_t leaves[4];
+      for (int i = 0; i < best->size; i++) {
+        leaves[i] = map[best->leaves[i]];
+      }
+      map[node] = build(best->truth, leaves);
+    } else {
+      map[node] = out.addAnd(remap(aig.fanin0[node]), remap(aig.fanin1[node]));
+    }
+  }
+
+  for (uint32_t output : aig.outputs) {
+    out.outputs.push_back(remap(output));
+  }
+
+  Aig result = out.compact();
+  if (result.andCount() > aig.andCount()) {
+    return aig.compact();
+  }
+  return result;
+}
+
+} // namespace
+
+Aig balance(const Aig &aig) {
+  // A node is inside a larger AND when its only use is an uncomplemented
+  // fanin of another AND
+  std::vector<uint32_t> uses(aig.nodeCount(), 0);
+  std::vector<uint32_t> plainAndUses(aig.nodeCount(), 0);
+  for (uint32_t node = 0; node < aig.nodeCount(); node++) {
+    if (aig.isAnd(node)) {
+      for (uint32_t lit : {aig.fanin0[node], aig.fanin1[node]}) {
+        uses[Aig::nodeOf(lit)]++;
+        if (!Aig::isComplemented(lit)) {
+          plainAndUses[Aig::nodeOf(lit)]++;
+        }
+      }
+    }
+  }
+  for (uint32_t output : aig.outputs) {
+    uses[Aig::nodeOf(output)]++;
+  }
+  auto isInternal = [&](uint32_t node) {
+    return aig.isAnd(node) && uses[node] == 1 && plainAndUses[node] == 1;
+  };
+
+  Aig out;
+  out.name = aig.name;
+  std::vector<uint32_t> map(aig.nodeCount(), Aig::FALSE_LITERAL);
+  for (size_t i = 0; i < aig.inputs.size(); i++) {
+    map[aig.inputs[i]] = out.addInput(aig.inputNames[i]);
+  }
+
+  using Operand = std::pair<uint32_t, uint32_t>; // (level, literal)
+  std::vector<uint32_t> stack;
+  std::priority_queue<Operand, std::vector<Operand>, std::greater<Operand>>
+      operands;
+
+  for (uint32_t node = 0; node < aig.nodeCount(); node++) {
+    if (!aig.isAnd(node) || isInternal(node)) {
+      continue;
+    }
+
+    // Collect the operands of the whole multi-input AND rooted here
+    stack.assign({aig.fanin0[node], aig.fanin1[node]});
+    while (!stack.empty()) {
+      uint32_t lit = stack.back();
+      stack.pop_back();
+      uint32_t fanin = Aig::nodeOf(lit);
+      if (!Aig::isComplemented(lit) && isInternal(fanin)) {
+        stack.push_back(aig.fanin0[fanin]);
+        stack.push_back(aig.fanin1[fanin]);
+      } else {
+        uint32_t mapped = map[fanin] ^ (lit & 1);
+        operands.push({out.levels[Aig::nodeOf(mapped)], mapped});
+      }
+    }
+
+    while (operands.size() > 1) {
+      uint32_t a = operands.top().second;
+      operands.pop();
+      uint32_t b = operands.top().second;
+      operands.pop();
+      uint32_t lit = out.addAnd(a, b);
+      operands.push({out.levels[Aig::nodeOf(lit)], lit});
+    }
+    map[node] = operands.top().second;
+    operands.pop();
+  }
+
+  for (uint32_t output : aig.outputs) {
+    out.outputs.push_back(map[Aig::nodeOf(output)] ^ (output & 1));
+  }
+  return out.compact();
+}
+
+Aig rewrite(const Aig &aig) {
+  Rewriter rewriter(aig);
+  return rewriter.run();
+}
+
+Aig optimize(const Aig &aig) {
+  Aig result = balance(aig);
+  result = rewrite(result);
+  result = rewrite(result);
+  return balance(result);
+}
+
+} // namespace aigopt
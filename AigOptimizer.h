@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Aig.h"
+
+// Optimization passes over And-Inverter Graphs. Each pass returns a new,
+// compacted graph with the same inputs and outputs and leaves its argument
+// untouched.
+namespace aigopt {
+
+// Rebuilds every multi-input AND (a tree of single-fanout, uncomplemented
+// AND nodes) as a balanced tree, pairing the shallowest operands first, to
+// reduce depth without adding nodes
+Aig balance(const Aig &aig);
+
+// Enumerates 4-input cuts of every node and replaces a node's cone by a
+// cheaper implementation of the cut's function when that frees more nodes
+// than it adds. Never returns a larger graph than it was given.
+Aig rewrite(const Aig &aig);
+
+// Balance, two rounds of rewriting, balance
+Aig optimize(const Aig &aig);
+
+} // namespace aigopt
@@ -0,0 +1,23 @@
+#include "Arena.h"
+
+Arena::~Arena() {
+  for (auto it = finalizers.rbegin(); it != finalizers.rend(); ++it) {
+    it->destroy(it->object);
+  }
+}
+
+// Starts a new block. Requests too big to share one get a block of their
+// own, which leaves the current block open for the small ones that follow.
+void *Arena::allocateSlow(size_t size, size_t alignment) {
+  size_t needed = size + alignment - 1;
+  if (needed > BLOCK_SIZE / 4) {
+    blocks.push_back(std::unique_ptr<std::byte[]>(new std::byte[needed]));
+    std::byte *block = blocks.back().get();
+    return block + (-reinterpret_cast<uintptr_t>(block) & (alignment - 1));
+  }
+
+  blocks.push_back(std::unique_ptr<std::byte[]>(new std::byte[BLOCK_SIZE]));
+  next = blocks.back().get();
+  limit = next + BLOCK_SIZE;
+  return allocate(size, alignment);
+}
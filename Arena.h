@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size array allocated in an Arena, used for the child lists of
+// syntax tree nodes. Elements can be replaced but not added.
+template <typename T> class ArenaList {
+private:
+  T *items = nullptr;
+  size_t count = 0;
+
+public:
+  ArenaList() = default;
+  ArenaList(T *items, size_t count) : items(items), count(count) {}
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  T &operator[](size_t i) { return items[i]; }
+  const T &operator[](size_t i) const { return items[i]; }
+  T &back() { return items[count - 1]; }
+  const T &back() const { return items[count - 1]; }
+  T *begin() { return items; }
+  T *end() { return items + count; }
+  const T *begin() const { return items; }
+  const T *end() const { return items + count; }
+};
+
+// Bump allocator that owns every node of a program's syntax tree.
+//
+// Memory is carved out of large blocks and only released when the arena
+// is destroyed, all at once. Nodes that are trivially destructible are never
+// visited again; the few that own heap memory (such as wide literals) have
+// their destructors recorded and run first.
+class Arena {
+private:
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  struct Finalizer {
+    void *object;
+    void (*destroy)(void *);
+  };
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks;
+  std::byte *next = nullptr;
+  std::byte *limit = nullptr;
+  std::vector<Finalizer> finalizers;
+
+  void *allocateSlow(size_t size, size_t alignment);
+
+public:
+  Arena() = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  ~Arena();
+
+  void *allocate(size_t size, size_t alignment) {
+    size_t padding = -reinterpret_cast<uintptr_t>(next) & (alignment - 1);
+    if (padding + size > static_cast<size_t>(limit - next)) {
+      return allocateSlow(size, alignment);
+    }
+    std::byte *start = next + padding;
+    next = start + size;
+    return start;
+  }
+
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    T *object = new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      finalizers.push_back(
+          {object, [](void *p) { static_cast<T *>(p)->~T(); }});
+    }
+    return object;
+  }
+
+  // Copies a range into a list owned by the arena
+  template <typename T, typename Iterator>
+  ArenaList<T> list(Iterator first, Iterator last) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena lists never run element destructors");
+    size_t count = std::distance(first, last);
+    if (count == 0) {
+      return ArenaList<T>();
+    }
+    T *items = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    std::uninitialized_copy(first, last, items);
+    return ArenaList<T>(items, count);
+  }
+
+  template <typename T> ArenaList<T> list(const std::vector<T> &items) {
+    return list<T>(items.begin(), items.end());
+  }
+};
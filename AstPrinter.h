@@ -8,14 +8,14 @@
 
 class AstPrinter : public ExprVisitor, public StmtVisitor {
 public:
-  std::string print(std::shared_ptr<Expr> expr) {
+  std::string print(Expr *expr) {
     std::string *result = static_cast<std::string *>(expr->accept(this));
     std::string value = *result;
     delete result;
     return value;
   }
 
-  std::string print(std::shared_ptr<Stmt> stmt) {
+  std::string print(Stmt *stmt) {
     std::string *result = static_cast<std::string *>(stmt->accept(this));
     std::string value = *result;
     delete result;
@@ -26,12 +26,12 @@ public:
   void *visitLiteralExpr(LiteralExpr *expr) override {
     std::stringstream ss;
     if (expr->value.is_bitvector) {
-      if (expr->value.bits.size() == 1) {
-        ss << (expr->value.bits[0] ? "true" : "false");
+      if (expr->value.size() == 1) {
+        ss << (expr->value.getBit(0) ? "true" : "false");
       } else {
         ss << "0b";
-        for (bool bit : expr->value.bits) {
-          ss << (bit ? "1" : "0");
+        for (size_t i = 0; i < expr->value.size(); i++) {
+          ss << (expr->value.getBit(i) ? "1" : "0");
         }
       }
     } else {
@@ -111,6 +111,11 @@ public:
     }
     ss << ")";
 
+    for (const auto &reg : stmt->registers) {
+      ss << " (register " << reg.name->lexeme << " " << print(reg.initial)
+         << " " << print(reg.next) << ")";
+    }
+
     for (const auto &expr : stmt->body) {
       std::string e = print(expr);
       ss << " " << e;
@@ -153,4 +158,39 @@ public:
     ss << "(return " << expr << ")";
     return new std::string(ss.str());
   }
+
+  void *visitTruthTableStmt(TruthTableStmt *stmt) override {
+    std::stringstream ss;
+    ss << "(truth_table " << stmt->circuit->lexeme << ")";
+    return new std::string(ss.str());
+  }
+
+  void *visitSimulateStmt(SimulateStmt *stmt) override {
+    std::stringstream ss;
+    ss << "(simulate " << stmt->circuit->lexeme << " ";
+    if (stmt->vectors.empty()) {
+      ss << stmt->cycles;
+    } else {
+      ss << stmt->vectors;
+    }
+    ss << ")";
+    return new std::string(ss.str());
+  }
+
+  void *visitBddStmt(BddStmt *stmt) override {
+    return new std::string("(bdd " + stmt->circuit->lexeme + ")");
+  }
+
+  void *visitEquivStmt(EquivStmt *stmt) override {
+    return new std::string("(equiv " + stmt->first->lexeme + " " +
+                           stmt->second->lexeme + ")");
+  }
+
+  void *visitMinimizeStmt(MinimizeStmt *stmt) override {
+    return new std::string("(minimize " + stmt->circuit->lexeme + ")");
+  }
+
+  void *visitEmitCppStmt(EmitCppStmt *stmt) override {
+    return new std::string("(emit_cpp " + stmt->circuit->lexeme + ")");
+  }
 };
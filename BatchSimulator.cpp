@@ -0,0 +1,251 @@
+#include "BatchSimulator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Aig.h"
+#include "AigOptimizer.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BEX_HAVE_AVX2_KERNELS 1
+#define BEX_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define BEX_ALWAYS_INLINE inline
+#endif
+
+namespace {
+
+using Step = BatchSimulator::Step;
+
+// The lane loops have a constant trip count, so the compiler turns each
+// case into straight SIMD code for whatever target the caller is built for
+template <size_t LANES>
+BEX_ALWAYS_INLINE void runSteps(const Step *steps, size_t count,
+                                uint64_t *values) {
+  for (size_t i = 0; i < count; i++) {
+    const Step &s = steps[i];
+    uint64_t *d = values + s.dst * LANES;
+    const uint64_t *a = values + s.a * LANES;
+    const uint64_t *b = values + s.b * LANES;
+
+    switch (s.op) {
+    case BitOp::NOT:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = ~a[l];
+      break;
+    case BitOp::AND:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = a[l] & b[l];
+      break;
+    case BitOp::OR:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = a[l] | b[l];
+      break;
+    case BitOp::XOR:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = a[l] ^ b[l];
+      break;
+    case BitOp::XNOR:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = ~(a[l] ^ b[l]);
+      break;
+    case BitOp::NAND:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = ~(a[l] & b[l]);
+      break;
+    case BitOp::NOR:
+      for (size_t l = 0; l < LANES; l++)
+        d[l] = ~(a[l] | b[l]);
+      break;
+    }
+  }
+}
+
+template <size_t LANES>
+void runScalar(const Step *steps, size_t count, uint64_t *values) {
+  runSteps<LANES>(steps, count, values);
+}
+
+#ifdef BEX_HAVE_AVX2_KERNELS
+template <size_t LANES>
+__attribute__((target("avx2"))) void runAvx2(const Step *steps, size_t count,
+                                             uint64_t *values) {
+  runSteps<LANES>(steps, count, values);
+}
+
+bool hasAvx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif
+
+} // namespace
+
+BatchSimulator::BatchSimulator(const Netlist &netlist, size_t lanes)
+    : netlist(netlist), lanes(lanes) {
+  if (lanes != 1 && lanes != 4 && lanes != 8) {
+    throw std::invalid_argument("BatchSimulator lanes must be 1, 4 or 8");
+  }
+
+  values.assign(netlist.nodeCount() * lanes, 0);
+  latched.resize(netlist.registers.size() * lanes);
+  compile();
+
+  for (size_t i = 0; i < netlist.registers.size(); i++) {
+    uint64_t *state = node(netlist.registers[i]);
+    std::fill(state, state + lanes, netlist.registerInitial[i] ? ~0ULL : 0);
+    registerWords.emplace_back(netlist.registers[i] * lanes,
+                               netlist.registerNext[i] * lanes);
+  }
+}
+
+void BatchSimulator::compile() {
+  std::vector<Step> compiled;
+  compiled.reserve(netlist.nodeCount());
+
+  for (uint32_t id = 0; id < netlist.nodeCount(); id++) {
+    const uint32_t *fanin = netlist.faninBegin(id);
+    uint32_t count = netlist.faninCount(id);
+
+    // Gates other than NOT reduce their fanins with AND, OR or XOR and
+    // optionally invert the result
+    BitOp chain = BitOp::AND;
+    bool invert = false;
+
+    switch (netlist.types[id]) {
+    case GateType::INPUT:
+    case GateType::REGISTER:
+    case GateType::CONST0:
+      continue;
+    case GateType::CONST1:
+      for (size_t l = 0; l < lanes; l++) {
+        node(id)[l] = ~0ULL;
+      }
+      continue;
+    case GateType::NOT:
+      compiled.push_back({BitOp::NOT, id, fanin[0], fanin[0]});
+      continue;
+    case GateType::AND:
+      chain = BitOp::AND;
+      break;
+    case GateType::OR:
+      chain = BitOp::OR;
+      break;
+    case GateType::XOR:
+      chain = BitOp::XOR;
+      break;
+    case GateType::NAND:
+      chain = BitOp::AND;
+      invert = true;
+      break;
+    case GateType::NOR:
+      chain = BitOp::OR;
+      invert = true;
+      break;
+    case GateType::XNOR:
+      chain = BitOp::XOR;
+      invert = true;
+      break;
+    }
+
+    if (count == 0) {
+      // Empty AND is true, empty OR and XOR are false
+      bool value = (chain == BitOp::AND) != invert;
+      for (size_t l = 0; l < lanes; l++) {
+        node(id)[l] = value ? ~0ULL : 0;
+      }
+      continue;
+    }
+
+    if (count == 2 && invert) {
+      // Two-input NAND, NOR and XNOR are single operations
+      BitOp fused = chain == BitOp::AND  ? BitOp::NAND
+                    : chain == BitOp::OR ? BitOp::NOR
+                                         : BitOp::XNOR;
+      compiled.push_back({fused, id, fanin[0], fanin[1]});
+      continue;
+    }
+
+    if (count == 1) {
+      // x op x is x for AND and OR; XOR of a single input is the input
+      BitOp copy = chain == BitOp::XOR ? BitOp::OR : chain;
+      compiled.push_back({copy, id, fanin[0], fanin[0]});
+    } else {
+      compiled.push_back({chain, id, fanin[0], fanin[1]});
+      for (uint32_t i = 2; i < count; i++) {
+        compiled.push_back({chain, id, id, fanin[i]});
+      }
+    }
+
+    if (invert) {
+      compiled.push_back({BitOp::NOT, id, id, id});
+    }
+  }
+
+  steps = std::make_shared<const std::vector<Step>>(std::move(compiled));
+}
+
+void BatchSimulator::run() {
+  const Step *code = steps->data();
+  size_t count = steps->size();
+  uint64_t *data = values.data();
+
+#ifdef BEX_HAVE_AVX2_KERNELS
+  if (hasAvx2()) {
+    switch (lanes) {
+    case 1:
+      runAvx2<1>(code, count, data);
+      return;
+    case 4:
+      runAvx2<4>(code, count, data);
+      return;
+    default:
+      runAvx2<8>(code, count, data);
+      return;
+    }
+  }
+#endif
+
+  switch (lanes) {
+  case 1:
+    runScalar<1>(code, count, data);
+    return;
+  case 4:
+    runScalar<4>(code, count, data);
+    return;
+  default:
+    runScalar<8>(code, count, data);
+    return;
+  }
+}
+
+void BatchSimulator::clock() {
+  // Registers may feed each other directly, so every next value is read
+  // before any register changes
+  uint64_t *data = values.data();
+  uint64_t *held = latched.data();
+  size_t words = registerWords.size() * lanes;
+  for (size_t i = 0, w = 0; w < words; i++) {
+    for (size_t l = 0; l < lanes; l++) {
+      held[w++] = data[registerWords[i].second + l];
+    }
+  }
+  for (size_t i = 0, w = 0; w < words; i++) {
+    for (size_t l = 0; l < lanes; l++) {
+      data[registerWords[i].first + l] = held[w++];
+    }
+  }
+}
+
+Netlist cheapestNetlist(Netlist netlist) {
+  // The And-Inverter Graph has no registers
+  if (netlist.isSequential()) {
+    return netlist;
+  }
+  Netlist optimized = aigopt::optimize(Aig::fromNetlist(netlist)).toNetlist();
+  if (BatchSimulator(optimized, 1).stepCount() <
+      BatchSimulator(netlist, 1).stepCount()) {
+    return optimized;
+  }
+  return netlist;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "BitKernels.h"
+#include "Netlist.h"
+
+// Bit-sliced simulation of a netlist: every signal holds `lanes` 64-bit
+// words and bit k of the signal is its value under test pattern k, so one
+// pass over the gates evaluates 64 * lanes input patterns at once. Four lanes
+// fill an AVX2 register and eight an AVX-512 one; the gate loop is compiled
+// for AVX2 as well and picked at runtime when the CPU supports it.
+//
+// Copies share the compiled steps, which never change after construction, and
+// get their own signal values, so threads can each simulate a copy.
+//
+// For a netlist with registers, the steps are its combinational logic in
+// topological order, computed once, so a clock cycle is one straight pass
+// over them followed by clock().
+class BatchSimulator {
+public:
+  // One two-input word operation; n-ary AND/OR gates become chains of these
+  struct Step {
+    BitOp op;
+    uint32_t dst;
+    uint32_t a;
+    uint32_t b;
+  };
+
+private:
+  const Netlist &netlist;
+  size_t lanes;
+  std::shared_ptr<const std::vector<Step>> steps;
+  std::vector<uint64_t> values; // lanes words per node, node-major
+  std::vector<uint64_t> latched; // Next register values during clock()
+  // Word offsets of each register and of its next value, lanes apart
+  std::vector<std::pair<uint32_t, uint32_t>> registerWords;
+
+public:
+  // lanes must be 1, 4 or 8
+  BatchSimulator(const Netlist &netlist, size_t lanes = 4);
+
+  size_t laneCount() const { return lanes; }
+  size_t patternsPerRun() const { return lanes * 64; }
+  size_t stepCount() const { return steps->size(); } // Word operations per run
+
+  // Words of the i-th primary input or output, `laneCount()` of them
+  uint64_t *input(size_t i) { return node(netlist.inputs[i]); }
+  const uint64_t *output(size_t i) const {
+    return values.data() + netlist.outputs[i] * lanes;
+  }
+
+  void run();
+
+  // Loads every register with its next value, as computed by the last run()
+  void clock();
+
+private:
+  uint64_t *node(uint32_t id) { return values.data() + id * lanes; }
+  void compile();
+};
+
+// Every simulated pattern pays for every step, so returns the optimized
+// And-Inverter Graph of a combinational netlist when it lowers to fewer
+// steps, and the netlist itself otherwise
+Netlist cheapestNetlist(Netlist netlist);
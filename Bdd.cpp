@@ -0,0 +1,546 @@
+#include "Bdd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+#include "Elaborator.h"
+
+BddManager::BddManager(size_t varCount)
+    : varCount(varCount), subtables(varCount), levels(varCount),
+      order(varCount), cache(CACHE_SIZE) {
+  // The constant node has no variable and is never counted or collected
+  nodes.push_back({NO_NODE, ONE, ONE});
+  for (uint32_t var = 0; var < varCount; var++) {
+    subtables[var].buckets.assign(64, NO_NODE);
+    levels[var] = var;
+    order[var] = var;
+  }
+}
+
+size_t BddManager::hash(Edge high, Edge low, size_t mask) {
+  uint64_t key = uint64_t(high) << 32 | low;
+  return (key * 0x9E3779B97F4A7C15ULL) >> 32 & mask;
+}
+
+uint32_t BddManager::allocate() {
+  allocated++;
+  if (freeList != NO_NODE) {
+    uint32_t index = freeList;
+    freeList = nodes[index].next;
+    return index;
+  }
+  nodes.emplace_back();
+  return nodes.size() - 1;
+}
+
+void BddManager::insert(Subtable &table, uint32_t index) {
+  if (table.count >= table.buckets.size() * 2) {
+    grow(table);
+  }
+  size_t bucket =
+      hash(nodes[index].high, nodes[index].low, table.buckets.size() - 1);
+  nodes[index].next = table.buckets[bucket];
+  table.buckets[bucket] = index;
+  table.count++;
+}
+
+void BddManager::grow(Subtable &table) {
+  std::vector<uint32_t> old(table.buckets.size() * 2, NO_NODE);
+  old.swap(table.buckets);
+  size_t mask = table.buckets.size() - 1;
+  for (uint32_t head : old) {
+    while (head != NO_NODE) {
+      uint32_t next = nodes[head].next;
+      size_t bucket = hash(nodes[head].high, nodes[head].low, mask);
+      nodes[head].next = table.buckets[bucket];
+      table.buckets[bucket] = head;
+      head = next;
+    }
+  }
+}
+
+// The node (var ? high : low), reduced and with a regular high edge
+BddManager::Edge BddManager::makeNode(uint32_t var, Edge high, Edge low) {
+  if (high == low) {
+    return high;
+  }
+  Edge complement = high & 1;
+  high ^= complement;
+  low ^= complement;
+
+  Subtable &table = subtables[var];
+  size_t bucket = hash(high, low, table.buckets.size() - 1);
+  for (uint32_t i = table.buckets[bucket]; i != NO_NODE; i = nodes[i].next) {
+    if (nodes[i].high == high && nodes[i].low == low) {
+      return i << 1 | complement;
+    }
+  }
+
+  uint32_t index = allocate();
+  Node &node = nodes[index];
+  node.var = var;
+  node.high = high;
+  node.low = low;
+  node.ref = 0;
+  insert(table, index);
+  return index << 1 | complement;
+}
+
+bool BddManager::lookup(Op op, Edge f, Edge g, Edge &result) {
+  stats.cacheLookups++;
+  const CacheEntry &entry =
+      cache[(hash(f, g, CACHE_SIZE - 1) + uint32_t(op)) & (CACHE_SIZE - 1)];
+  if (entry.op == op && entry.f == f && entry.g == g) {
+    stats.cacheHits++;
+    result = entry.result;
+    return true;
+  }
+  return false;
+}
+
+void BddManager::remember(Op op, Edge f, Edge g, Edge result) {
+  cache[(hash(f, g, CACHE_SIZE - 1) + uint32_t(op)) & (CACHE_SIZE - 1)] = {
+      op, f, g, result};
+}
+
+BddManager::Edge BddManager::bddAnd(Edge f, Edge g) {
+  if (f == ZERO || g == ZERO || f == bddNot(g)) {
+    return ZERO;
+  }
+  if (f == ONE || f == g) {
+    return g;
+  }
+  if (g == ONE) {
+    return f;
+  }
+  if (f > g) {
+    std::swap(f, g);
+  }
+
+  Edge result;
+  if (lookup(Op::AND, f, g, result)) {
+    return result;
+  }
+
+  uint32_t top = std::min(level(f), level(g));
+  bool fTop = level(f) == top;
+  bool gTop = level(g) == top;
+  Edge then = bddAnd(fTop ? high(f) : f, gTop ? high(g) : g);
+  Edge other = bddAnd(fTop ? low(f) : f, gTop ? low(g) : g);
+  result = makeNode(order[top], then, other);
+
+  remember(Op::AND, f, g, result);
+  return result;
+}
+
+BddManager::Edge BddManager::bddXor(Edge f, Edge g) {
+  if (f == g) {
+    return ZERO;
+  }
+  if (f == bddNot(g)) {
+    return ONE;
+  }
+  // Complements factor out: not f xor g = not (f xor g)
+  Edge complement = (f ^ g) & 1;
+  f &= ~Edge(1);
+  g &= ~Edge(1);
+  if (f == ONE) {
+    return g ^ complement ^ 1;
+  }
+  if (g == ONE) {
+    return f ^ complement ^ 1;
+  }
+  if (f > g) {
+    std::swap(f, g);
+  }
+
+  Edge result;
+  if (lookup(Op::XOR, f, g, result)) {
+    return result ^ complement;
+  }
+
+  uint32_t top = std::min(level(f), level(g));
+  bool fTop = level(f) == top;
+  bool gTop = level(g) == top;
+  Edge then = bddXor(fTop ? high(f) : f, gTop ? high(g) : g);
+  Edge other = bddXor(fTop ? low(f) : f, gTop ? low(g) : g);
+  result = makeNode(order[top], then, other);
+
+  remember(Op::XOR, f, g, result);
+  return result ^ complement;
+}
+
+// A node with references holds one on each child, so reviving a node
+// revives its children and releasing the last reference releases them
+void BddManager::ref(Edge f) {
+  uint32_t index = f >> 1;
+  if (index == 0) {
+    return;
+  }
+  if (nodes[index].ref++ == 0) {
+    stats.liveNodes++;
+    stats.peakLiveNodes = std::max(stats.peakLiveNodes, stats.liveNodes);
+    ref(nodes[index].high);
+    ref(nodes[index].low);
+  }
+}
+
+void BddManager::deref(Edge f) {
+  uint32_t index = f >> 1;
+  if (index == 0) {
+    return;
+  }
+  if (--nodes[index].ref == 0) {
+    stats.liveNodes--;
+    deref(nodes[index].high);
+    deref(nodes[index].low);
+  }
+}
+
+// Moves the nodes of a table that have no references to the free list
+size_t BddManager::freeDead(Subtable &table) {
+  size_t freed = 0;
+  for (uint32_t &head : table.buckets) {
+    uint32_t *link = &head;
+    while (*link != NO_NODE) {
+      uint32_t index = *link;
+      if (nodes[index].ref == 0) {
+        *link = nodes[index].next;
+        nodes[index].next = freeList;
+        freeList = index;
+        freed++;
+      } else {
+        link = &nodes[index].next;
+      }
+    }
+  }
+  table.count -= freed;
+  allocated -= freed;
+  return freed;
+}
+
+void BddManager::collectGarbage() {
+  for (Subtable &table : subtables) {
+    freeDead(table);
+  }
+  // Cached results may name nodes that were just freed
+  std::fill(cache.begin(), cache.end(), CacheEntry());
+  stats.garbageCollections++;
+}
+
+void BddManager::checkpoint() {
+  if (stats.liveNodes >= nextReorder) {
+    reorder();
+  } else if (allocated - stats.liveNodes > std::max<size_t>(
+                                               stats.liveNodes, CACHE_SIZE)) {
+    collectGarbage();
+  }
+}
+
+// Swaps the variables at levels `upper` and `upper + 1`. A node of the upper
+// variable x that depends on the lower variable y is rewritten in place from
+// x ? (y ? f11 : f10) : (y ? f01 : f00) into y ? (x ? f11 : f01) :
+// (x ? f10 : f00), so it keeps its function and every edge to it stays
+// valid. Nodes of x that do not depend on y simply move down a level.
+void BddManager::swapLevels(uint32_t upper) {
+  uint32_t x = order[upper];
+  uint32_t y = order[upper + 1];
+  Subtable &xTable = subtables[x];
+
+  std::vector<uint32_t> kept;
+  std::vector<uint32_t> moved;
+  for (uint32_t head : xTable.buckets) {
+    for (uint32_t i = head; i != NO_NODE; i = nodes[i].next) {
+      bool dependsOnY = nodes[nodes[i].high >> 1].var == y ||
+                        nodes[nodes[i].low >> 1].var == y;
+      (dependsOnY ? moved : kept).push_back(i);
+    }
+  }
+
+  // The new nodes of x must find the ones that stay, and nothing else
+  std::fill(xTable.buckets.begin(), xTable.buckets.end(), NO_NODE);
+  xTable.count = 0;
+  for (uint32_t i : kept) {
+    insert(xTable, i);
+  }
+
+  for (uint32_t i : moved) {
+    Edge f1 = nodes[i].high;
+    Edge f0 = nodes[i].low;
+    bool f1OnY = nodes[f1 >> 1].var == y;
+    bool f0OnY = nodes[f0 >> 1].var == y;
+    Edge f11 = f1OnY ? high(f1) : f1;
+    Edge f10 = f1OnY ? low(f1) : f1;
+    Edge f01 = f0OnY ? high(f0) : f0;
+    Edge f00 = f0OnY ? low(f0) : f0;
+
+    // f11 is reached through regular high edges, so `then` is regular too
+    Edge then = makeNode(x, f11, f01);
+    Edge other = makeNode(x, f10, f00);
+    ref(then);
+    ref(other);
+    deref(f1);
+    deref(f0);
+
+    nodes[i].var = y;
+    nodes[i].high = then;
+    nodes[i].low = other;
+    insert(subtables[y], i);
+  }
+
+  // Only nodes of y can have lost their last reference
+  freeDead(subtables[y]);
+
+  levels[x] = upper + 1;
+  levels[y] = upper;
+  order[upper] = y;
+  order[upper + 1] = x;
+}
+
+// Moves a variable through every level, then back to where the diagram was
+// smallest. A direction is abandoned once the diagram grows too much.
+void BddManager::sift(uint32_t var) {
+  size_t best = stats.liveNodes;
+  uint32_t bestLevel = levels[var];
+
+  auto record = [&]() {
+    if (stats.liveNodes < best) {
+      best = stats.liveNodes;
+      bestLevel = levels[var];
+    }
+    return stats.liveNodes <= best * MAX_GROWTH;
+  };
+  auto down = [&]() {
+    while (levels[var] + 1 < varCount) {
+      swapLevels(levels[var]);
+      if (!record()) {
+        break;
+      }
+    }
+  };
+  auto up = [&]() {
+    while (levels[var] > 0) {
+      swapLevels(levels[var] - 1);
+      if (!record()) {
+        break;
+      }
+    }
+  };
+
+  // The nearer end first, so less time is spent away from the best level
+  if (levels[var] >= varCount / 2) {
+    down();
+    up();
+  } else {
+    up();
+    down();
+  }
+
+  while (levels[var] < bestLevel) {
+    swapLevels(levels[var]);
+  }
+  while (levels[var] > bestLevel) {
+    swapLevels(levels[var] - 1);
+  }
+}
+
+void BddManager::reorder() {
+  collectGarbage();
+
+  // Variables with the most nodes have the most to gain
+  std::vector<uint32_t> vars(varCount);
+  std::iota(vars.begin(), vars.end(), 0);
+  std::stable_sort(vars.begin(), vars.end(), [&](uint32_t a, uint32_t b) {
+    return subtables[a].count > subtables[b].count;
+  });
+  for (uint32_t var : vars) {
+    sift(var);
+  }
+
+  // Swapping frees nodes that cached results may still name
+  std::fill(cache.begin(), cache.end(), CacheEntry());
+  stats.reorderings++;
+  nextReorder = std::max(FIRST_REORDER, stats.liveNodes * 2);
+}
+
+size_t BddManager::nodeCount(const std::vector<Edge> &functions) const {
+  std::vector<bool> seen(nodes.size(), false);
+  std::vector<uint32_t> stack;
+  size_t count = 0;
+  for (Edge f : functions) {
+    stack.push_back(f >> 1);
+  }
+  while (!stack.empty()) {
+    uint32_t index = stack.back();
+    stack.pop_back();
+    if (index == 0 || seen[index]) {
+      continue;
+    }
+    seen[index] = true;
+    count++;
+    stack.push_back(nodes[index].high >> 1);
+    stack.push_back(nodes[index].low >> 1);
+  }
+  return count;
+}
+
+// Fraction of all input combinations that make f true. The fraction of a
+// complemented edge is one minus the node's, and skipped variables do not
+// change it, so each node is computed once.
+long double BddManager::satFraction(
+    Edge f, std::unordered_map<uint32_t, long double> &memo) const {
+  uint32_t index = f >> 1;
+  long double fraction = 1;
+  if (index != 0) {
+    auto found = memo.find(index);
+    if (found != memo.end()) {
+      fraction = found->second;
+    } else {
+      fraction = (satFraction(nodes[index].high, memo) +
+                  satFraction(nodes[index].low, memo)) /
+                 2;
+      memo.emplace(index, fraction);
+    }
+  }
+  return f & 1 ? 1 - fraction : fraction;
+}
+
+long double BddManager::satCount(Edge f) const {
+  std::unordered_map<uint32_t, long double> memo;
+  return std::ldexp(satFraction(f, memo), varCount);
+}
+
+void writeBddReport(const SymbolSource &symbols, const Token *name,
+                    std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = elaborator.elaborate(name);
+  if (netlist.isSequential()) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                 "' has registers, so it has no BDD.");
+  }
+
+  using Edge = BddManager::Edge;
+  BddManager bdd(netlist.inputs.size());
+  std::vector<Edge> values(netlist.nodeCount(), BddManager::ZERO);
+
+  // A node's BDD is released once its last fanin use is built; outputs
+  // are never released
+  std::vector<uint32_t> uses(netlist.nodeCount(), 0);
+  for (uint32_t fanin : netlist.fanins) {
+    uses[fanin]++;
+  }
+  for (uint32_t output : netlist.outputs) {
+    uses[output]++;
+  }
+  // Inputs are referenced up front, so reordering at an earlier
+  // checkpoint cannot collect them
+  for (size_t i = 0; i < netlist.inputs.size(); i++) {
+    values[netlist.inputs[i]] = bdd.variable(i);
+    bdd.ref(values[netlist.inputs[i]]);
+  }
+
+  for (uint32_t id = 0; id < netlist.nodeCount(); id++) {
+    const uint32_t *fanin = netlist.faninBegin(id);
+    uint32_t count = netlist.faninCount(id);
+    Edge value = values[id];
+
+    switch (netlist.types[id]) {
+    case GateType::INPUT:
+    case GateType::REGISTER:
+    case GateType::CONST0:
+      break;
+    case GateType::CONST1:
+      value = BddManager::ONE;
+      break;
+    case GateType::NOT:
+      value = BddManager::bddNot(values[fanin[0]]);
+      break;
+    case GateType::AND:
+    case GateType::NAND:
+      value = BddManager::ONE;
+      for (uint32_t i = 0; i < count; i++) {
+        value = bdd.bddAnd(value, values[fanin[i]]);
+      }
+      break;
+    case GateType::OR:
+    case GateType::NOR:
+      value = BddManager::ZERO;
+      for (uint32_t i = 0; i < count; i++) {
+        value = bdd.bddOr(value, values[fanin[i]]);
+      }
+      break;
+    case GateType::XOR:
+    case GateType::XNOR:
+      value = BddManager::ZERO;
+      for (uint32_t i = 0; i < count; i++) {
+        value = bdd.bddXor(value, values[fanin[i]]);
+      }
+      break;
+    }
+    GateType type = netlist.types[id];
+    if (type == GateType::NAND || type == GateType::NOR ||
+        type == GateType::XNOR) {
+      value = BddManager::bddNot(value);
+    }
+
+    if (type != GateType::INPUT) {
+      values[id] = value;
+      bdd.ref(value);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      if (--uses[fanin[i]] == 0) {
+        bdd.deref(values[fanin[i]]);
+      }
+    }
+    bdd.checkpoint();
+  }
+
+  std::vector<Edge> outputs;
+  for (uint32_t output : netlist.outputs) {
+    outputs.push_back(values[output]);
+  }
+
+  os << "BDD of " << name->lexeme << ", variable order:";
+  for (uint32_t var : bdd.variableOrder()) {
+    os << " " << netlist.inputNames[var];
+  }
+  os << "\n";
+
+  long double combinations = std::ldexp(1.0L, netlist.inputs.size());
+  os << std::fixed << std::setprecision(0);
+  for (size_t o = 0; o < outputs.size(); o++) {
+    Edge f = outputs[o];
+    os << "  output " << o + 1 << ": " << bdd.nodeCount({f}) << " nodes, "
+       << bdd.satCount(f) << " of " << combinations << " assignments";
+    if (f == BddManager::ONE) {
+      os << ", tautology";
+    } else if (f == BddManager::ZERO) {
+      os << ", unsatisfiable";
+    }
+    for (size_t earlier = 0; earlier < o; earlier++) {
+      if (outputs[earlier] == f) {
+        os << ", same as output " << earlier + 1;
+        break;
+      }
+      if (outputs[earlier] == BddManager::bddNot(f)) {
+        os << ", complement of output " << earlier + 1;
+        break;
+      }
+    }
+    os << "\n";
+  }
+
+  const BddManager::Stats &stats = bdd.statistics();
+  double hitRate = stats.cacheLookups
+                       ? 100.0 * stats.cacheHits / stats.cacheLookups
+                       : 0.0;
+  os << "  " << bdd.nodeCount(outputs) << " nodes in all, peak "
+     << stats.peakLiveNodes << " live; cache " << stats.cacheHits << " hits of "
+     << stats.cacheLookups << " lookups (" << std::setprecision(1) << hitRate
+     << "%); " << stats.reorderings << " reorderings, "
+     << stats.garbageCollections << " garbage collections\n";
+  os.unsetf(std::ios::floatfield);
+  os << std::setprecision(6);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "Environment.h"
+#include "Netlist.h"
+
+// Reduced ordered binary decision diagrams with complement edges. Every
+// function built in one manager shares its nodes, so two functions are equal
+// exactly when their edges are, and a tautology is the edge ONE.
+//
+// An edge is a node index shifted left by one, with the low bit set when the
+// edge complements the node's function. Node 0 is the constant; the high
+// (then) edge of a node is never complemented, which keeps the
+// representation canonical.
+//
+// Nodes live in one unique table per variable, so reordering can find all
+// nodes of a level. Results of AND and XOR are kept in a direct-mapped
+// computed cache. Nodes are reference counted: functions that must survive
+// are ref()'d, and everything else is collected at checkpoint(), which is
+// also where the variable order is improved by sifting once the diagram has
+// grown. Sifting swaps adjacent levels in place, so an edge keeps denoting
+// the same function across reordering.
+class BddManager {
+public:
+  using Edge = uint32_t;
+  static constexpr Edge ONE = 0;
+  static constexpr Edge ZERO = 1;
+
+  struct Stats {
+    size_t liveNodes = 0;
+    size_t peakLiveNodes = 0;
+    size_t cacheLookups = 0;
+    size_t cacheHits = 0;
+    size_t garbageCollections = 0;
+    size_t reorderings = 0;
+  };
+
+private:
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+  static constexpr size_t CACHE_SIZE = 1 << 18; // Entries, a power of 2
+  static constexpr size_t FIRST_REORDER = 4096; // Live nodes
+  static constexpr double MAX_GROWTH = 1.2; // Of the best size while sifting
+
+  struct Node {
+    uint32_t var;
+    Edge high; // Never complemented
+    Edge low;
+    uint32_t ref = 0;
+    uint32_t next = NO_NODE; // In the unique table bucket, or the free list
+  };
+
+  // The nodes of one variable, chained through Node::next
+  struct Subtable {
+    std::vector<uint32_t> buckets;
+    size_t count = 0;
+  };
+
+  enum class Op : uint32_t { NONE, AND, XOR };
+
+  struct CacheEntry {
+    Op op = Op::NONE;
+    Edge f, g;
+    Edge result;
+  };
+
+  size_t varCount;
+  std::vector<Node> nodes;
+  uint32_t freeList = NO_NODE;
+  std::vector<Subtable> subtables; // Indexed by variable
+  std::vector<uint32_t> levels;    // Level of each variable, 0 on top
+  std::vector<uint32_t> order;     // Variable at each level
+  size_t allocated = 0;            // Nodes in the unique tables, live or dead
+  std::vector<CacheEntry> cache;
+  size_t nextReorder = FIRST_REORDER;
+  Stats stats;
+
+  uint32_t level(Edge f) const {
+    uint32_t var = nodes[f >> 1].var;
+    return var == NO_NODE ? varCount : levels[var];
+  }
+  Edge high(Edge f) const { return nodes[f >> 1].high ^ (f & 1); }
+  Edge low(Edge f) const { return nodes[f >> 1].low ^ (f & 1); }
+
+  Edge makeNode(uint32_t var, Edge high, Edge low);
+  uint32_t allocate();
+  static size_t hash(Edge high, Edge low, size_t mask);
+  void insert(Subtable &table, uint32_t index);
+  void grow(Subtable &table);
+
+  bool lookup(Op op, Edge f, Edge g, Edge &result);
+  void remember(Op op, Edge f, Edge g, Edge result);
+
+  size_t freeDead(Subtable &table);
+  void swapLevels(uint32_t upper);
+  void sift(uint32_t var);
+
+  long double satFraction(Edge f,
+                          std::unordered_map<uint32_t, long double> &memo) const;
+
+public:
+  explicit BddManager(size_t varCount);
+
+  size_t variableCount() const { return varCount; }
+  Edge variable(uint32_t var) { return makeNode(var, ONE, ZERO); }
+
+  static Edge bddNot(Edge f) { return f ^ 1; }
+  Edge bddAnd(Edge f, Edge g);
+  Edge bddOr(Edge f, Edge g) { return bddNot(bddAnd(bddNot(f), bddNot(g))); }
+  Edge bddXor(Edge f, Edge g);
+
+  // Keep a function alive across checkpoints, or release it
+  void ref(Edge f);
+  void deref(Edge f);
+
+  // Call between operations, when every function still needed is ref()'d.
+  // Collects dead nodes and reorders once the diagram has outgrown its last
+  // reordering.
+  void checkpoint();
+  void collectGarbage();
+  void reorder(); // Sifts every variable
+
+  // Decision nodes reachable from the given functions
+  size_t nodeCount(const std::vector<Edge> &functions) const;
+  // Input combinations of all variables that make f true
+  long double satCount(Edge f) const;
+
+  const std::vector<uint32_t> &variableOrder() const { return order; }
+  const Stats &statistics() const { return stats; }
+};
+
+// Elaborates the named circuit, builds the BDD of each output and writes
+// their sizes, satisfying assignment counts, tautologies and equivalences
+// with the manager's statistics
+void writeBddReport(const SymbolSource &symbols, const Token *name,
+                    std::ostream &os);
@@ -1,6 +1,13 @@
 #include "BexInterpreter.h"
+
+#include <unistd.h>
+
 #include "Evaluator.h" // Include our new Evaluator
+#include "MappedFile.h"
+#include "Session.h"
+#include "StatementReader.h"
 #include "Utils.h"     // Include the header, not the cpp file
+#include "VM.h"
 
 const std::string HELP_MESSAGE =
     R"(Bex is a Boolean expression interpreter
@@ -10,38 +17,127 @@ Usage: bex [options] [script]
 Options:
   -d, --verbose
       Print verbose output
+  --engine=tree|vm
+      Execute with the tree-walking evaluator (default) or the bytecode VM
+  --truth-table CIRCUIT
+      After running the script, print the truth table of CIRCUIT
+  --simulate CIRCUIT --vectors FILE
+      After running the script, print the outputs of CIRCUIT for every input
+      vector in FILE (- for stdin), one line of 0s and 1s per vector
+  --emit-cpp CIRCUIT
+      After running the script, print CIRCUIT as a C++ function that
+      evaluates 64 input patterns per call, one per bit of each word
+  -j, --jobs N
+      Simulate vectors on N threads, or one per core if N is 0 (default 1)
+  --sim=levelized|event
+      Evaluate every gate per vector or cycle (default), or only the gates
+      whose inputs changed
+  --bitmap
+      Write truth tables and simulation outputs as packed 64-bit words
+  --memo, --memo=CIRCUIT[,CIRCUIT...]
+      Cache the results of calls to every circuit, or to the named ones
+  --memo-size=N
+      Keep at most N cached results per circuit (default 4096)
+  --stream
+      Run the script (or stdin) one statement at a time as it is read
+  -i, --interactive
+      Open the prompt after running the script, keeping its definitions
   -h, --help
       Print help
 )";
 
 void BexInterpreter::runFile(std::string fileName) {
-  std::string line;
-  std::ifstream sourceFile(fileName);
-  if (sourceFile.is_open()) {
-    std::string source;
-    while (getline(sourceFile, line)) {
-      source += line + "\n";
-    }
-    run(source);
-    sourceFile.close();
+  // The scanner reads straight out of the mapping, which only has to live
+  // until the tokens are scanned
+  MappedFile sourceFile;
+  if (sourceFile.open(fileName)) {
+    run(sourceFile.view());
   } else {
     std::cerr << "Error: Unable to open file";
   }
 }
 
-void BexInterpreter::runPrompt() {
+void BexInterpreter::runStream(StatementReader &reader, Session &session) {
+  std::string_view form;
+  int line;
+  bool ok = true;
+  while (ok && reader.next(form, line)) {
+    ok = session.run(form, line);
+  }
+
+  if (ok) {
+    Arena arena;
+    std::vector<Stmt *> statements;
+    addCommandLineStatements(arena, statements);
+    session.execute(statements);
+  }
+
+  if (opt.isDebugMode() && opt.getMemoConfig().enabled()) {
+    printMemoResults(session.memoStats());
+  }
+}
+
+// Reads statements from the terminal into one session, so circuits and bits
+// defined on earlier lines stay available. Input is collected until its
+// parentheses balance, and a statement that fails does not end the session.
+void BexInterpreter::runPrompt(Session &session) {
+  std::string input;
   std::string line;
+  int depth = 0;
+  int inputLine = 1; // Line the collected input starts on
+  int lineCount = 0;
   std::cout << ">> ";
 
   while (std::getline(std::cin, line)) {
-    if (line.empty())
+    lineCount++;
+    if (line.empty() && input.empty())
       break;
-    run(line);
-    std::cout << ">> ";
+
+    for (char c : line) {
+      if (c == '(') {
+        depth++;
+      } else if (c == ')' && depth > 0) {
+        depth--;
+      }
+    }
+    input += line;
+    input += '\n';
+
+    if (depth == 0) {
+      session.run(input, inputLine);
+      input.clear();
+      inputLine = lineCount + 1;
+    }
+    std::cout << (depth == 0 ? ">> " : ".. ");
+  }
+}
+
+// Appends the statements that run after the script: the truth table, then
+// the simulation, then the generated C++
+void BexInterpreter::addCommandLineStatements(Arena &arena,
+                                              std::vector<Stmt *> &statements) {
+  Interner &interner = Interner::global();
+  auto circuitToken = [&](const std::string &name) {
+    return arena.make<Token>(TokenType::IDENTIFIER,
+                             interner.text(interner.intern(name)), 0);
+  };
+
+  if (opt.hasTruthTableCircuit()) {
+    statements.push_back(arena.make<TruthTableStmt>(
+        circuitToken(opt.getTruthTableCircuit()), opt.isBitmapOutput()));
+  }
+  if (opt.hasSimulateCircuit()) {
+    statements.push_back(arena.make<SimulateStmt>(
+        circuitToken(opt.getSimulateCircuit()), opt.getVectorFile(),
+        opt.isBitmapOutput(), opt.getJobs()));
+  }
+  if (opt.hasEmitCppCircuit()) {
+    statements.push_back(
+        arena.make<EmitCppStmt>(circuitToken(opt.getEmitCppCircuit())));
   }
 }
 
-void BexInterpreter::run(std::string source) {
+void BexInterpreter::run(std::string_view source) {
   // Scan tokens
   Scanner scanner(source);
   auto tokens = scanner.scanTokens();
@@ -50,24 +146,74 @@ void BexInterpreter::run(std::string source) {
     printTokenStream(tokens);
   }
 
-  // Parse tokens
-  Parser parser(tokens);
+  // Parse tokens. The arena owns the syntax tree and frees it in one go
+  // when the run ends.
+  Arena arena;
+  Parser parser(tokens, arena);
   auto statements = parser.parse();
 
+  addCommandLineStatements(arena, statements);
+
   if (BexInterpreter::opt.isDebugMode() && !statements.empty()) {
     printParseResults(statements);
   }
 
+  // Fold constants and drop definitions nothing reads
+  ConstantFolder folder(arena, opt.getEngine(), opt.getMemoConfig());
+  auto folded = folder.run(statements);
+  auto memoStats = folder.memoStats();
+
+  if (BexInterpreter::opt.isDebugMode()) {
+    printConstantFoldingResults(folded);
+  }
+
+  // Share structurally identical subexpressions of circuit bodies
+  HashConser conser;
+  auto merged = conser.run(statements);
+
+  if (BexInterpreter::opt.isDebugMode() && !merged.empty()) {
+    printHashConsResults(merged);
+  }
+
   // Evaluate parsed statements if there are any
   if (!statements.empty()) {
-    Evaluator evaluator;
-    evaluator.evaluate(statements);
+    if (opt.getEngine() == Engine::VM) {
+      VM vm;
+      vm.setDebugMode(opt.isDebugMode());
+      vm.setSimulationMode(opt.getSimulationMode());
+      vm.interpret(statements);
+    } else {
+      Evaluator evaluator;
+      evaluator.setMemoConfig(opt.getMemoConfig());
+      evaluator.setSimulationMode(opt.getSimulationMode());
+      evaluator.evaluate(statements);
+
+      auto evaluated = evaluator.memoStats();
+      memoStats.insert(memoStats.end(), evaluated.begin(), evaluated.end());
+    }
+  }
+
+  if (BexInterpreter::opt.isDebugMode() && opt.getMemoConfig().enabled()) {
+    printMemoResults(memoStats);
   }
 }
 
 BexInterpreter::BexInterpreter(int argc, char **argv) {
   std::regex verbosePattern("^(-v|--verbose)$");
   std::regex helpPattern("^(-h|--help)$");
+  std::regex enginePattern("^--engine=(tree|vm)$");
+  std::regex truthTablePattern("^--truth-table$");
+  std::regex simulatePattern("^--simulate$");
+  std::regex vectorsPattern("^--vectors$");
+  std::regex emitCppPattern("^--emit-cpp$");
+  std::regex jobsPattern("^(-j|--jobs)$");
+  std::regex countPattern("^[0-9]+$");
+  std::regex simPattern("^--sim=(levelized|event)$");
+  std::regex bitmapPattern("^--bitmap$");
+  std::regex memoPattern("^--memo(=(.+))?$");
+  std::regex memoSizePattern("^--memo-size=([0-9]+)$");
+  std::regex streamPattern("^--stream$");
+  std::regex interactivePattern("^(-i|--interactive)$");
   std::regex bxFilePattern(R"(^(.+)\.bx$)");
 
   // Process all arguments
@@ -77,6 +223,60 @@ BexInterpreter::BexInterpreter(int argc, char **argv) {
 
     if (std::regex_match(arg, match, verbosePattern)) {
       opt.setDebugMode(true);
+    } else if (std::regex_match(arg, match, enginePattern)) {
+      opt.setEngine(match[1] == "vm" ? Engine::VM : Engine::TREE);
+    } else if (std::regex_match(arg, match, truthTablePattern)) {
+      if (i + 1 >= argc) {
+        std::cerr << "Error: --truth-table requires a circuit name" << "\n";
+        exit(EXIT_FAILURE);
+      }
+      opt.setTruthTableCircuit(argv[++i]);
+    } else if (std::regex_match(arg, match, simulatePattern)) {
+      if (i + 1 >= argc) {
+        std::cerr << "Error: --simulate requires a circuit name" << "\n";
+        exit(EXIT_FAILURE);
+      }
+      opt.setSimulateCircuit(argv[++i]);
+    } else if (std::regex_match(arg, match, vectorsPattern)) {
+      if (i + 1 >= argc) {
+        std::cerr << "Error: --vectors requires a file name" << "\n";
+        exit(EXIT_FAILURE);
+      }
+      opt.setVectorFile(argv[++i]);
+    } else if (std::regex_match(arg, match, emitCppPattern)) {
+      if (i + 1 >= argc) {
+        std::cerr << "Error: --emit-cpp requires a circuit name" << "\n";
+        exit(EXIT_FAILURE);
+      }
+      opt.setEmitCppCircuit(argv[++i]);
+    } else if (std::regex_match(arg, match, jobsPattern)) {
+      if (i + 1 >= argc || !std::regex_match(argv[i + 1], countPattern)) {
+        std::cerr << "Error: " << arg << " requires a thread count" << "\n";
+        exit(EXIT_FAILURE);
+      }
+      opt.setJobs(std::stoul(argv[++i]));
+    } else if (std::regex_match(arg, match, simPattern)) {
+      opt.setSimulationMode(match[1] == "event"
+                                ? SimulationMode::EVENT_DRIVEN
+                                : SimulationMode::LEVELIZED);
+    } else if (std::regex_match(arg, match, bitmapPattern)) {
+      opt.setBitmapOutput(true);
+    } else if (std::regex_match(arg, match, memoPattern)) {
+      if (!match[2].matched) {
+        opt.setMemoAll(true);
+      } else {
+        std::stringstream names(match[2]);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+          opt.addMemoCircuit(name);
+        }
+      }
+    } else if (std::regex_match(arg, match, memoSizePattern)) {
+      opt.setMemoCapacity(std::stoul(match[1]));
+    } else if (std::regex_match(arg, match, streamPattern)) {
+      opt.setStreaming(true);
+    } else if (std::regex_match(arg, match, interactivePattern)) {
+      opt.setInteractive(true);
     } else if (std::regex_match(arg, match, bxFilePattern)) {
       if (opt.hasFileName()) {
         std::cerr << "Error: Multiple .bx files specified" << "\n";
@@ -93,10 +293,51 @@ BexInterpreter::BexInterpreter(int argc, char **argv) {
       exit(EXIT_FAILURE);
     }
   }
-  // Run file or prompt based on whether a file was specified
-  if (opt.hasFileName()) {
+
+  // Run file or prompt based on whether a file was specified. Piped input
+  // has no one to prompt, so it is streamed like a script.
+  bool prompt =
+      !opt.hasFileName() && !opt.isStreaming() && isatty(STDIN_FILENO);
+  if (opt.hasTruthTableCircuit() && prompt) {
+    std::cerr << "Error: --truth-table requires a script" << "\n";
+    exit(EXIT_FAILURE);
+  }
+  if (opt.hasEmitCppCircuit() && prompt) {
+    std::cerr << "Error: --emit-cpp requires a script" << "\n";
+    exit(EXIT_FAILURE);
+  }
+  if (opt.hasSimulateCircuit() != opt.hasVectorFile()) {
+    std::cerr << "Error: --simulate and --vectors must be used together"
+              << "\n";
+    exit(EXIT_FAILURE);
+  }
+  if (opt.hasSimulateCircuit() &&
+      (prompt || (!opt.hasFileName() && opt.getVectorFile() == "-"))) {
+    std::cerr << "Error: --simulate requires a script, and only one of them "
+                 "can be read from stdin"
+              << "\n";
+    exit(EXIT_FAILURE);
+  }
+
+  Session session(opt);
+  StatementReader reader;
+  if (opt.hasFileName() && (opt.isStreaming() || opt.isInteractive())) {
+    // A script loaded for the prompt is streamed into the session, since
+    // whole-program folding would drop the definitions it does not use
+    if (!reader.open(opt.getFileName())) {
+      std::cerr << "Error: Unable to open file";
+    } else {
+      runStream(reader, session);
+      if (opt.isInteractive()) {
+        runPrompt(session);
+      }
+    }
+  } else if (opt.hasFileName()) {
     runFile(opt.getFileName());
+  } else if (!prompt) {
+    reader.openStdin();
+    runStream(reader, session);
   } else {
-    runPrompt();
+    runPrompt(session);
   }
 }
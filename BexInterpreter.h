@@ -3,20 +3,26 @@
 #include <fstream>
 #include <iostream>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Evaluator.h" // Added Evaluator header
 #include "Options.h"
 #include "Parser.h"
 #include "Scanner.h"
+#include "Session.h"
+#include "StatementReader.h"
 
 class BexInterpreter {
 private:
   Options opt;
   void runFile(std::string fileName);
-  void runPrompt();
-  void run(std::string source);
+  void runPrompt(Session &session);
+  void runStream(StatementReader &reader, Session &session);
+  void run(std::string_view source);
+  void addCommandLineStatements(Arena &arena, std::vector<Stmt *> &statements);
 
 public:
   BexInterpreter(int argc, char **argv);
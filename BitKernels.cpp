@@ -0,0 +1,126 @@
+#include "BitKernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BEX_HAVE_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <BitOp op> inline uint64_t applyWord(uint64_t a, uint64_t b) {
+  switch (op) {
+  case BitOp::NOT:
+    return ~a;
+  case BitOp::AND:
+    return a & b;
+  case BitOp::OR:
+    return a | b;
+  case BitOp::XOR:
+    return a ^ b;
+  case BitOp::XNOR:
+    return ~(a ^ b);
+  case BitOp::NAND:
+    return ~(a & b);
+  case BitOp::NOR:
+    return ~(a | b);
+  }
+  return 0;
+}
+
+template <BitOp op>
+void applyScalar(uint64_t *dst, const uint64_t *a, const uint64_t *b,
+                 size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = applyWord<op>(a[i], b[i]);
+  }
+}
+
+#ifdef BEX_HAVE_AVX2_KERNELS
+template <BitOp op>
+__attribute__((target("avx2"))) void
+applyAvx2(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  size_t i = 0;
+
+  // Four words per iteration, unaligned loads since literal storage is
+  // only 8-byte aligned
+  for (; i + 4 <= n; i += 4) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    __m256i r;
+
+    switch (op) {
+    case BitOp::NOT:
+      r = _mm256_xor_si256(va, ones);
+      break;
+    case BitOp::AND:
+      r = _mm256_and_si256(va, vb);
+      break;
+    case BitOp::OR:
+      r = _mm256_or_si256(va, vb);
+      break;
+    case BitOp::XOR:
+      r = _mm256_xor_si256(va, vb);
+      break;
+    case BitOp::XNOR:
+      r = _mm256_xor_si256(_mm256_xor_si256(va, vb), ones);
+      break;
+    case BitOp::NAND:
+      r = _mm256_xor_si256(_mm256_and_si256(va, vb), ones);
+      break;
+    case BitOp::NOR:
+      r = _mm256_xor_si256(_mm256_or_si256(va, vb), ones);
+      break;
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+  }
+
+  for (; i < n; i++) {
+    dst[i] = applyWord<op>(a[i], b[i]);
+  }
+}
+#endif
+
+using KernelFn = void (*)(uint64_t *, const uint64_t *, const uint64_t *,
+                          size_t);
+
+struct KernelTable {
+  KernelFn fns[7];
+  const char *name;
+};
+
+KernelTable selectKernels() {
+#ifdef BEX_HAVE_AVX2_KERNELS
+  if (__builtin_cpu_supports("avx2")) {
+    return {{applyAvx2<BitOp::NOT>, applyAvx2<BitOp::AND>,
+             applyAvx2<BitOp::OR>, applyAvx2<BitOp::XOR>,
+             applyAvx2<BitOp::XNOR>, applyAvx2<BitOp::NAND>,
+             applyAvx2<BitOp::NOR>},
+            "avx2"};
+  }
+#endif
+  return {{applyScalar<BitOp::NOT>, applyScalar<BitOp::AND>,
+           applyScalar<BitOp::OR>, applyScalar<BitOp::XOR>,
+           applyScalar<BitOp::XNOR>, applyScalar<BitOp::NAND>,
+           applyScalar<BitOp::NOR>},
+          "scalar"};
+}
+
+const KernelTable &kernels() {
+  static const KernelTable table = selectKernels();
+  return table;
+}
+
+} // namespace
+
+namespace bitkernels {
+
+void apply(BitOp op, uint64_t *dst, const uint64_t *a, const uint64_t *b,
+           size_t n) {
+  kernels().fns[static_cast<int>(op)](dst, a, b, n);
+}
+
+const char *implementationName() { return kernels().name; }
+
+} // namespace bitkernels
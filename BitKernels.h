@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Word-level kernels for the gate operators. Each kernel processes whole
+// 64-bit words, so callers are responsible for masking the tail of the
+// last word for operators that can set bits past the end (NOT, XNOR, NAND,
+// NOR).
+enum class BitOp {
+  NOT,
+  AND,
+  OR,
+  XOR,
+  XNOR,
+  NAND,
+  NOR,
+};
+
+namespace bitkernels {
+
+// dst[i] = a[i] op b[i] for i in [0, n). For NOT, b is ignored.
+// dst may alias a or b.
+void apply(BitOp op, uint64_t *dst, const uint64_t *a, const uint64_t *b,
+           size_t n);
+
+// Name of the kernel implementation selected at startup ("avx2" or "scalar")
+const char *implementationName();
+
+} // namespace bitkernels
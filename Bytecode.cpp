@@ -0,0 +1,99 @@
+#include "Bytecode.h"
+
+#include <iostream>
+
+uint32_t Module::globalSlot(const std::string &name) {
+  auto it = globalSlots.find(name);
+  if (it != globalSlots.end()) {
+    return it->second;
+  }
+
+  uint32_t slot = globals.size();
+  globalSlots.emplace(name, slot);
+  globals.emplace_back();
+  defined.push_back(false);
+  return slot;
+}
+
+uint32_t Module::circuitSlot(const std::string &name) {
+  auto it = circuitSlots.find(name);
+  if (it != circuitSlots.end()) {
+    return it->second;
+  }
+
+  uint32_t slot = circuits.size();
+  circuitSlots.emplace(name, slot);
+  circuits.emplace_back();
+  return slot;
+}
+
+const CircuitDefStmt *Module::findCircuit(const std::string &name) const {
+  auto it = circuitSlots.find(name);
+  return it != circuitSlots.end() ? circuits[it->second].definition : nullptr;
+}
+
+const literal *Module::findValue(const std::string &name) const {
+  auto it = globalSlots.find(name);
+  if (it == globalSlots.end() || !defined[it->second]) {
+    return nullptr;
+  }
+  return &globals[it->second];
+}
+
+std::string opCodeToString(OpCode op) {
+  switch (op) {
+  case OpCode::CONST:
+    return "CONST";
+  case OpCode::LOAD_GLOBAL:
+    return "LOAD_GLOBAL";
+  case OpCode::MOVE:
+    return "MOVE";
+  case OpCode::NOT:
+    return "NOT";
+  case OpCode::AND:
+    return "AND";
+  case OpCode::OR:
+    return "OR";
+  case OpCode::XOR:
+    return "XOR";
+  case OpCode::XNOR:
+    return "XNOR";
+  case OpCode::NAND:
+    return "NAND";
+  case OpCode::NOR:
+    return "NOR";
+  case OpCode::CONCAT:
+    return "CONCAT";
+  case OpCode::CALL:
+    return "CALL";
+  case OpCode::DEFINE_BIT:
+    return "DEFINE_BIT";
+  case OpCode::DEFINE_VECTOR:
+    return "DEFINE_VECTOR";
+  case OpCode::PRINT:
+    return "PRINT";
+  case OpCode::TRUTH_TABLE:
+    return "TRUTH_TABLE";
+  case OpCode::SIMULATE_CYCLES:
+    return "SIMULATE_CYCLES";
+  case OpCode::SIMULATE:
+    return "SIMULATE";
+  case OpCode::BDD:
+    return "BDD";
+  case OpCode::EQUIV:
+    return "EQUIV";
+  case OpCode::MINIMIZE:
+    return "MINIMIZE";
+  case OpCode::EMIT_CPP:
+    return "EMIT_CPP";
+  case OpCode::RETURN:
+    return "RETURN";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+std::ostream &operator<<(std::ostream &os, const OpCode &op) {
+  os << opCodeToString(op);
+  return os;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Environment.h"
+#include "Stmt.h"
+#include "Token.h"
+
+// Register-based instruction set. R[x] is register x of the current frame;
+// a, b, c and n are the operand fields of the instruction.
+enum class OpCode : uint8_t {
+  CONST,         // R[a] = constants[b]
+  LOAD_GLOBAL,   // R[a] = the innermost caller's parameter named like
+                 // globals[b], else globals[b]
+  MOVE,          // R[a] = R[b]
+  NOT,           // R[a] = not R[b]
+  AND,           // R[a] = and R[b] .. R[b + n - 1]
+  OR,            // R[a] = or R[b] .. R[b + n - 1]
+  XOR,           // R[a] = R[b] xor R[c]
+  XNOR,          // R[a] = R[b] xnor R[c]
+  NAND,          // R[a] = R[b] nand R[c]
+  NOR,           // R[a] = R[b] nor R[c]
+  CONCAT,        // R[a] = R[b] ++ .. ++ R[b + n - 1]
+  CALL,          // R[a] = circuits[c](R[b] .. R[b + n - 1])
+  DEFINE_BIT,    // globals[a] = R[b], which must be a single bit
+  DEFINE_VECTOR, // globals[a] = R[b]
+  PRINT,         // print R[a]
+  TRUTH_TABLE,   // write the named circuit's truth table, packed if a
+  SIMULATE_CYCLES, // clock the named circuit for b << 32 | a cycles
+  SIMULATE,      // run the named circuit on the vectors in files[b] with c
+                 // threads, packed if a
+  BDD,           // write the named circuit's BDD report
+  EQUIV,         // check the named circuit against circuits[a]
+  MINIMIZE,      // write the named circuit as minimized sums of products
+  EMIT_CPP,      // write the named circuit as a bit-sliced C++ function
+  RETURN,        // return R[a]
+};
+
+std::ostream &operator<<(std::ostream &os, const OpCode &op);
+
+struct Instruction {
+  OpCode op;
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  uint32_t n;
+};
+
+// A compiled circuit body or top-level statement. Parameters occupy the
+// first `arity` registers, so a caller can lay out arguments in consecutive
+// registers and the callee's frame starts right on top of them.
+struct Function {
+  std::string name;
+  uint32_t arity = 0;
+  uint32_t registerCount = 0;
+  std::vector<Instruction> code;
+  std::vector<const Token *> tokens; // Source token per instruction
+  std::vector<literal> constants;
+  std::vector<std::string> files; // Vector files read by SIMULATE
+  std::vector<const Token *> circuits; // Second circuits of EQUIV
+  std::vector<uint32_t> parameterSlots; // Global slot of each parameter name
+};
+
+struct CircuitEntry {
+  const CircuitDefStmt *definition = nullptr;
+  std::unique_ptr<Function> function; // Compiled on first call
+};
+
+// Global state that compiled code refers to by index
+struct Module : public SymbolSource {
+  std::unordered_map<std::string, uint32_t> globalSlots;
+  std::vector<literal> globals;
+  std::vector<bool> defined;
+
+  std::unordered_map<std::string, uint32_t> circuitSlots;
+  std::vector<CircuitEntry> circuits;
+
+  uint32_t globalSlot(const std::string &name);
+  uint32_t circuitSlot(const std::string &name);
+
+  // SymbolSource implementation
+  const CircuitDefStmt *findCircuit(const std::string &name) const override;
+  const literal *findValue(const std::string &name) const override;
+};
@@ -0,0 +1,364 @@
+#include "Compiler.h"
+
+#include <algorithm>
+
+#include "Environment.h"
+
+Compiler::Compiler(Module &module) : module(module) {}
+
+std::unique_ptr<Function> Compiler::compileScript(Stmt *stmt) {
+  auto script = std::make_unique<Function>();
+  script->name = "<script>";
+
+  function = script.get();
+  parameters.clear();
+  nextRegister = 0;
+
+  stmt->accept(this);
+
+  function = nullptr;
+  return script;
+}
+
+std::unique_ptr<Function> Compiler::compileExpression(Expr *expr) {
+  auto script = std::make_unique<Function>();
+  script->name = "<expression>";
+
+  function = script.get();
+  parameters.clear();
+  nextRegister = 0;
+
+  uint32_t result = allocate(1);
+  compileInto(expr, result);
+  emit(OpCode::RETURN, nullptr, result);
+
+  function = nullptr;
+  return script;
+}
+
+std::unique_ptr<Function>
+Compiler::compileCircuit(const CircuitDefStmt &circuit) {
+  auto compiled = std::make_unique<Function>();
+  compiled->name = circuit.name->lexeme;
+  compiled->arity = circuit.parameters.size();
+
+  function = compiled.get();
+  parameters.clear();
+  for (const auto &param : circuit.parameters) {
+    parameters.push_back(param->lexeme);
+    compiled->parameterSlots.push_back(module.globalSlot(param->lexeme));
+  }
+  nextRegister = 0;
+  allocate(compiled->arity);
+  sharedBase = allocate(circuit.sharedCount);
+  sharedReady.assign(circuit.sharedCount, false);
+
+  // Every body expression is evaluated, the last one is the result
+  uint32_t result = allocate(1);
+  if (circuit.body.empty()) {
+    emit(OpCode::CONST, circuit.name, result,
+         addConstant(literal::fromBit(false)));
+  }
+  for (const auto &expr : circuit.body) {
+    compileInto(expr, result);
+  }
+  emit(OpCode::RETURN, circuit.name, result);
+
+  function = nullptr;
+  sharedReady.clear();
+  return compiled;
+}
+
+// Helpers
+
+uint32_t Compiler::allocate(uint32_t count) {
+  uint32_t first = nextRegister;
+  nextRegister += count;
+  function->registerCount = std::max(function->registerCount, nextRegister);
+  return first;
+}
+
+void Compiler::emit(OpCode op, const Token *token, uint32_t a, uint32_t b,
+                    uint32_t c, uint32_t n) {
+  function->code.push_back(Instruction{op, a, b, c, n});
+  function->tokens.push_back(token);
+}
+
+uint32_t Compiler::addConstant(const literal &value) {
+  function->constants.push_back(value);
+  return function->constants.size() - 1;
+}
+
+// A repeated parameter name binds the last argument, as in the Evaluator
+int Compiler::parameterIndex(const std::string &name) const {
+  for (size_t i = parameters.size(); i-- > 0;) {
+    if (parameters[i] == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void Compiler::compileInto(Expr *expr, uint32_t dst) {
+  if (expr->sharedSlot != Expr::NOT_SHARED) {
+    uint32_t reg = compileShared(expr);
+    if (reg != dst) {
+      emit(OpCode::MOVE, nullptr, dst, reg);
+    }
+    return;
+  }
+
+  uint32_t previous = target;
+  target = dst;
+  expr->accept(this);
+  target = previous;
+}
+
+uint32_t Compiler::compileShared(Expr *expr) {
+  // Circuit code is straight-line, so the first place a shared node is
+  // compiled is also the first place it runs
+  uint32_t reg = sharedBase + expr->sharedSlot;
+  if (!sharedReady[expr->sharedSlot]) {
+    sharedReady[expr->sharedSlot] = true;
+    uint32_t previous = target;
+    target = reg;
+    expr->accept(this);
+    target = previous;
+  }
+  return reg;
+}
+
+uint32_t Compiler::compileOperand(Expr *expr) {
+  if (expr->sharedSlot != Expr::NOT_SHARED) {
+    return compileShared(expr);
+  }
+
+  // Parameters already live in a register, use it directly
+  if (auto *variable = dynamic_cast<VariableExpr *>(expr)) {
+    int index = parameterIndex(variable->name->lexeme);
+    if (index >= 0) {
+      return index;
+    }
+  }
+
+  uint32_t reg = allocate(1);
+  compileInto(expr, reg);
+  return reg;
+}
+
+void Compiler::compileBinary(OpCode op, const Token *token,
+                             Expr *left, Expr *right) {
+  uint32_t dst = target;
+  uint32_t mark = nextRegister;
+  uint32_t l = compileOperand(left);
+  uint32_t r = compileOperand(right);
+  emit(op, token, dst, l, r);
+  nextRegister = mark;
+}
+
+void Compiler::compileCall(const Token *callee,
+                           const ArenaList<Expr *> &arguments) {
+  uint32_t dst = target;
+  uint32_t mark = nextRegister;
+
+  // Arguments go into consecutive registers at the top of the frame, which
+  // become the callee's parameter registers
+  uint32_t first = allocate(arguments.size());
+  for (size_t i = 0; i < arguments.size(); i++) {
+    compileInto(arguments[i], first + i);
+  }
+
+  emit(OpCode::CALL, callee, dst, first, module.circuitSlot(callee->lexeme),
+       arguments.size());
+  nextRegister = mark;
+}
+
+// ExprVisitor implementation
+void *Compiler::visitLiteralExpr(LiteralExpr *expr) {
+  emit(OpCode::CONST, nullptr, target, addConstant(expr->value));
+  return nullptr;
+}
+
+void *Compiler::visitVariableExpr(VariableExpr *expr) {
+  const std::string &name = expr->name->lexeme;
+
+  // A bare circuit name is a call with a single true argument
+  auto circuit = module.circuitSlots.find(name);
+  if (circuit != module.circuitSlots.end() &&
+      module.circuits[circuit->second].definition != nullptr) {
+    uint32_t dst = target;
+    uint32_t mark = nextRegister;
+    uint32_t arg = allocate(1);
+    emit(OpCode::CONST, expr->name, arg,
+         addConstant(literal::fromBit(true)));
+    emit(OpCode::CALL, expr->name, dst, arg, circuit->second, 1);
+    nextRegister = mark;
+    return nullptr;
+  }
+
+  int index = parameterIndex(name);
+  if (index >= 0) {
+    if (static_cast<uint32_t>(index) != target) {
+      emit(OpCode::MOVE, expr->name, target, index);
+    }
+    return nullptr;
+  }
+
+  emit(OpCode::LOAD_GLOBAL, expr->name, target, module.globalSlot(name));
+  return nullptr;
+}
+
+void *Compiler::visitUnaryExpr(UnaryExpr *expr) {
+  if (expr->op->type != TokenType::NOT) {
+    throw RuntimeError(expr->op, "Unknown unary operator.");
+  }
+
+  uint32_t dst = target;
+  uint32_t mark = nextRegister;
+  uint32_t operand = compileOperand(expr->right);
+  emit(OpCode::NOT, expr->op, dst, operand);
+  nextRegister = mark;
+  return nullptr;
+}
+
+void *Compiler::visitBinaryExpr(BinaryExpr *expr) {
+  OpCode op;
+  switch (expr->op->type) {
+  case TokenType::XOR:
+    op = OpCode::XOR;
+    break;
+  case TokenType::XNOR:
+    op = OpCode::XNOR;
+    break;
+  case TokenType::NAND:
+    op = OpCode::NAND;
+    break;
+  case TokenType::NOR:
+    op = OpCode::NOR;
+    break;
+  default:
+    throw RuntimeError(expr->op, "Unknown binary operator.");
+  }
+
+  compileBinary(op, expr->op, expr->left, expr->right);
+  return nullptr;
+}
+
+void *Compiler::visitMultiExpr(MultiExpr *expr) {
+  OpCode op;
+  switch (expr->op->type) {
+  case TokenType::AND:
+    op = OpCode::AND;
+    break;
+  case TokenType::OR:
+    op = OpCode::OR;
+    break;
+  default:
+    throw RuntimeError(expr->op, "Unknown multi-operand operator.");
+  }
+
+  uint32_t dst = target;
+  uint32_t mark = nextRegister;
+  uint32_t first = allocate(expr->operands.size());
+  for (size_t i = 0; i < expr->operands.size(); i++) {
+    compileInto(expr->operands[i], first + i);
+  }
+  emit(op, expr->op, dst, first, 0, expr->operands.size());
+  nextRegister = mark;
+  return nullptr;
+}
+
+void *Compiler::visitGroupingExpr(GroupingExpr *expr) {
+  compileInto(expr->expression, target);
+  return nullptr;
+}
+
+void *Compiler::visitCallExpr(CallExpr *expr) {
+  compileCall(expr->callee, expr->arguments);
+  return nullptr;
+}
+
+// StmtVisitor implementation
+void *Compiler::visitExpressionStmt(ExpressionStmt *stmt) {
+  compileInto(stmt->expression, allocate(1));
+  return nullptr;
+}
+
+void *Compiler::visitCircuitDefStmt(CircuitDefStmt *stmt) {
+  // Definitions take effect as soon as the statement is compiled; the body
+  // itself is compiled on its first call
+  CircuitEntry &entry = module.circuits[module.circuitSlot(stmt->name->lexeme)];
+  entry.definition = stmt;
+  entry.function.reset();
+  return nullptr;
+}
+
+void *Compiler::visitBitDefStmt(BitDefStmt *stmt) {
+  uint32_t value = allocate(1);
+  compileInto(stmt->initializer, value);
+  emit(OpCode::DEFINE_BIT, stmt->name, module.globalSlot(stmt->name->lexeme),
+       value);
+  return nullptr;
+}
+
+void *Compiler::visitBitVectorDefStmt(BitVectorDefStmt *stmt) {
+  uint32_t value = allocate(1);
+  uint32_t first = allocate(stmt->values.size());
+  for (size_t i = 0; i < stmt->values.size(); i++) {
+    compileInto(stmt->values[i], first + i);
+  }
+  emit(OpCode::CONCAT, stmt->name, value, first, 0, stmt->values.size());
+  emit(OpCode::DEFINE_VECTOR, stmt->name,
+       module.globalSlot(stmt->name->lexeme), value);
+  return nullptr;
+}
+
+void *Compiler::visitPrintStmt(PrintStmt *stmt) {
+  uint32_t value = compileOperand(stmt->expression);
+  emit(OpCode::PRINT, nullptr, value);
+  return nullptr;
+}
+
+void *Compiler::visitTruthTableStmt(TruthTableStmt *stmt) {
+  emit(OpCode::TRUTH_TABLE, stmt->circuit, stmt->bitmap);
+  return nullptr;
+}
+
+void *Compiler::visitSimulateStmt(SimulateStmt *stmt) {
+  if (stmt->vectors.empty()) {
+    emit(OpCode::SIMULATE_CYCLES, stmt->circuit, uint32_t(stmt->cycles),
+         uint32_t(stmt->cycles >> 32));
+    return nullptr;
+  }
+  function->files.push_back(stmt->vectors);
+  emit(OpCode::SIMULATE, stmt->circuit, stmt->bitmap,
+       function->files.size() - 1, stmt->jobs);
+  return nullptr;
+}
+
+void *Compiler::visitBddStmt(BddStmt *stmt) {
+  emit(OpCode::BDD, stmt->circuit, 0);
+  return nullptr;
+}
+
+void *Compiler::visitEquivStmt(EquivStmt *stmt) {
+  function->circuits.push_back(stmt->second);
+  emit(OpCode::EQUIV, stmt->first, function->circuits.size() - 1);
+  return nullptr;
+}
+
+void *Compiler::visitMinimizeStmt(MinimizeStmt *stmt) {
+  emit(OpCode::MINIMIZE, stmt->circuit, 0);
+  return nullptr;
+}
+
+void *Compiler::visitEmitCppStmt(EmitCppStmt *stmt) {
+  emit(OpCode::EMIT_CPP, stmt->circuit, 0);
+  return nullptr;
+}
+
+void *Compiler::visitReturnStmt(ReturnStmt *stmt) {
+  // A top-level return only evaluates its value
+  compileInto(stmt->value, allocate(1));
+  return nullptr;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bytecode.h"
+#include "Expr.h"
+#include "Stmt.h"
+
+// Lowers Stmt/Expr trees into register bytecode. Names that are not circuit
+// parameters resolve to global slots in the module; the callers' parameters
+// of that name shadow the global, and whether it is defined is checked when
+// the code runs.
+class Compiler : public ExprVisitor, public StmtVisitor {
+private:
+  Module &module;
+
+  Function *function = nullptr;
+  std::vector<std::string> parameters;
+  uint32_t nextRegister = 0;
+
+  // Register the expression being visited writes its value into
+  uint32_t target = 0;
+
+  // Shared body nodes of the circuit being compiled each own a register
+  // starting at sharedBase, filled the first time the node is compiled
+  uint32_t sharedBase = 0;
+  std::vector<bool> sharedReady;
+
+  uint32_t allocate(uint32_t count);
+  void emit(OpCode op, const Token *token, uint32_t a, uint32_t b = 0,
+            uint32_t c = 0, uint32_t n = 0);
+  uint32_t addConstant(const literal &value);
+  int parameterIndex(const std::string &name) const;
+
+  void compileInto(Expr *expr, uint32_t dst);
+  uint32_t compileShared(Expr *expr);
+  uint32_t compileOperand(Expr *expr);
+  void compileBinary(OpCode op, const Token *token, Expr *left, Expr *right);
+  void compileCall(const Token *callee, const ArenaList<Expr *> &arguments);
+
+public:
+  Compiler(Module &module);
+
+  // Compiles one top-level statement into a function with no parameters
+  std::unique_ptr<Function> compileScript(Stmt *stmt);
+  // Compiles a top-level expression into a function that returns its value
+  std::unique_ptr<Function> compileExpression(Expr *expr);
+  std::unique_ptr<Function> compileCircuit(const CircuitDefStmt &circuit);
+
+  // ExprVisitor implementation
+  void *visitLiteralExpr(LiteralExpr *expr) override;
+  void *visitVariableExpr(VariableExpr *expr) override;
+  void *visitUnaryExpr(UnaryExpr *expr) override;
+  void *visitBinaryExpr(BinaryExpr *expr) override;
+  void *visitMultiExpr(MultiExpr *expr) override;
+  void *visitGroupingExpr(GroupingExpr *expr) override;
+  void *visitCallExpr(CallExpr *expr) override;
+
+  // StmtVisitor implementation
+  void *visitExpressionStmt(ExpressionStmt *stmt) override;
+  void *visitCircuitDefStmt(CircuitDefStmt *stmt) override;
+  void *visitBitDefStmt(BitDefStmt *stmt) override;
+  void *visitBitVectorDefStmt(BitVectorDefStmt *stmt) override;
+  void *visitPrintStmt(PrintStmt *stmt) override;
+  void *visitReturnStmt(ReturnStmt *stmt) override;
+  void *visitTruthTableStmt(TruthTableStmt *stmt) override;
+  void *visitSimulateStmt(SimulateStmt *stmt) override;
+  void *visitBddStmt(BddStmt *stmt) override;
+  void *visitEquivStmt(EquivStmt *stmt) override;
+  void *visitMinimizeStmt(MinimizeStmt *stmt) override;
+  void *visitEmitCppStmt(EmitCppStmt *stmt) override;
+};
@@ -0,0 +1,341 @@
+#include "ConstantFolder.h"
+
+#include <stdexcept>
+
+namespace {
+
+// Calls f on every expression a statement holds, circuit bodies included
+template <typename F> void forEachExpr(Stmt &stmt, F f) {
+  if (auto *expression = dynamic_cast<ExpressionStmt *>(&stmt)) {
+    f(*expression->expression);
+  } else if (auto *circuit = dynamic_cast<CircuitDefStmt *>(&stmt)) {
+    for (auto &expr : circuit->body) {
+      f(*expr);
+    }
+    for (auto &reg : circuit->registers) {
+      f(*reg.initial);
+      f(*reg.next);
+    }
+  } else if (auto *bit = dynamic_cast<BitDefStmt *>(&stmt)) {
+    f(*bit->initializer);
+  } else if (auto *vector = dynamic_cast<BitVectorDefStmt *>(&stmt)) {
+    for (auto &expr : vector->values) {
+      f(*expr);
+    }
+  } else if (auto *print = dynamic_cast<PrintStmt *>(&stmt)) {
+    f(*print->expression);
+  } else if (auto *ret = dynamic_cast<ReturnStmt *>(&stmt)) {
+    f(*ret->value);
+  }
+}
+
+size_t countNodes(Expr &expr) {
+  size_t count = 1;
+  forEachOperand(expr, [&](Expr &operand) { count += countNodes(operand); });
+  return count;
+}
+
+size_t countNodes(const std::vector<Stmt *> &statements) {
+  size_t count = 0;
+  for (const auto &stmt : statements) {
+    forEachExpr(*stmt, [&](Expr &expr) { count += countNodes(expr); });
+  }
+  return count;
+}
+
+// Name a definition statement defines, or nullptr for other statements
+const std::string *definedName(Stmt &stmt) {
+  if (auto *circuit = dynamic_cast<CircuitDefStmt *>(&stmt)) {
+    return &circuit->name->lexeme;
+  }
+  if (auto *bit = dynamic_cast<BitDefStmt *>(&stmt)) {
+    return &bit->name->lexeme;
+  }
+  if (auto *vector = dynamic_cast<BitVectorDefStmt *>(&stmt)) {
+    return &vector->name->lexeme;
+  }
+  return nullptr;
+}
+
+// Adds every name an expression looks up, as a value or as a circuit
+void collectNames(Expr &expr, std::vector<std::string> &names) {
+  if (auto *variable = dynamic_cast<VariableExpr *>(&expr)) {
+    names.push_back(variable->name->lexeme);
+  } else if (auto *call = dynamic_cast<CallExpr *>(&expr)) {
+    names.push_back(call->callee->lexeme);
+  }
+  forEachOperand(expr, [&](Expr &operand) { collectNames(operand, names); });
+}
+
+} // namespace
+
+ConstantFolder::ConstantFolder(Arena &arena, Engine engine,
+                               const MemoConfig &memo)
+    : arena(arena), engine(engine) {
+  evaluator.setMemoConfig(memo);
+}
+
+ConstantFolder::Stats
+ConstantFolder::run(std::vector<Stmt *> &statements) {
+  Stats stats;
+  stats.nodesBefore = countNodes(statements);
+  stats.statementsBefore = statements.size();
+
+  if (engine == Engine::TREE) {
+    evaluator.resolve(statements);
+  }
+
+  // Circuit calls resolve names through the caller's frames, so a global
+  // can only be substituted into a body when no parameter or circuit shares
+  // its name, and it is never redefined
+  std::unordered_map<std::string, size_t> definitions;
+  for (const auto &stmt : statements) {
+    if (auto circuit = dynamic_cast<CircuitDefStmt *>(stmt)) {
+      dynamicNames.insert(circuit->name->lexeme);
+      for (const auto &parameter : circuit->parameters) {
+        dynamicNames.insert(parameter->lexeme);
+      }
+      for (const auto &reg : circuit->registers) {
+        dynamicNames.insert(reg.name->lexeme);
+      }
+    } else if (const std::string *name = definedName(*stmt)) {
+      definitions[*name]++;
+    }
+  }
+
+  // Fold statements in program order until one fails
+  size_t failed = statements.size();
+  std::vector<bool> unused(statements.size(), false);
+  for (size_t i = 0; i < statements.size(); i++) {
+    try {
+      bool isUnused = false;
+      foldStatement(statements[i], isUnused);
+      unused[i] = isUnused;
+    } catch (std::exception &) {
+      failed = i;
+      break;
+    }
+
+    const std::string *name = definedName(*statements[i]);
+    if (name && definitions[*name] == 1 && !dynamicNames.count(*name)) {
+      constants[*name] = *symbols().findValue(*name);
+    }
+  }
+
+  // Everything but the folded definitions can still look names up: the
+  // statements that do something, and all statements from the failing one on
+  std::unordered_set<std::string> live;
+  std::vector<std::string> pending;
+  for (size_t i = 0; i < statements.size(); i++) {
+    Stmt &stmt = *statements[i];
+    if (i < failed && (definedName(stmt) || unused[i])) {
+      continue;
+    }
+    forEachExpr(stmt, [&](Expr &expr) { collectNames(expr, pending); });
+    if (auto *table = dynamic_cast<TruthTableStmt *>(&stmt)) {
+      pending.push_back(table->circuit->lexeme);
+    } else if (auto *simulate = dynamic_cast<SimulateStmt *>(&stmt)) {
+      pending.push_back(simulate->circuit->lexeme);
+    } else if (auto *bdd = dynamic_cast<BddStmt *>(&stmt)) {
+      pending.push_back(bdd->circuit->lexeme);
+    } else if (auto *equiv = dynamic_cast<EquivStmt *>(&stmt)) {
+      pending.push_back(equiv->first->lexeme);
+      pending.push_back(equiv->second->lexeme);
+    } else if (auto *minimize = dynamic_cast<MinimizeStmt *>(&stmt)) {
+      pending.push_back(minimize->circuit->lexeme);
+    } else if (auto *emit = dynamic_cast<EmitCppStmt *>(&stmt)) {
+      pending.push_back(emit->circuit->lexeme);
+    }
+  }
+
+  // Bodies of live circuits are looked up in turn
+  while (!pending.empty()) {
+    std::string name = std::move(pending.back());
+    pending.pop_back();
+    if (!live.insert(name).second) {
+      continue;
+    }
+    for (const auto &stmt : statements) {
+      auto *circuit = dynamic_cast<CircuitDefStmt *>(stmt);
+      if (circuit && circuit->name->lexeme == name) {
+        for (auto &expr : circuit->body) {
+          collectNames(*expr, pending);
+        }
+        for (auto &reg : circuit->registers) {
+          collectNames(*reg.initial, pending);
+          collectNames(*reg.next, pending);
+        }
+      }
+    }
+  }
+
+  std::vector<Stmt *> kept;
+  for (size_t i = 0; i < statements.size(); i++) {
+    const std::string *name = definedName(*statements[i]);
+    bool dead = name ? !live.count(*name) : unused[i];
+    if (i >= failed || !dead) {
+      kept.push_back(statements[i]);
+    }
+  }
+  statements = std::move(kept);
+
+  stats.nodesAfter = countNodes(statements);
+  stats.statementsAfter = statements.size();
+  return stats;
+}
+
+// Folds one top-level statement and runs it on the engine when it defines
+// something. Throws if the statement fails. A statement whose value nobody
+// uses is flagged in `unused`.
+void ConstantFolder::foldStatement(Stmt *stmt, bool &unused) {
+  if (auto circuitDef = dynamic_cast<CircuitDefStmt *>(stmt)) {
+    foldCircuit(*circuitDef);
+    execute(stmt);
+  } else if (auto bit = dynamic_cast<BitDefStmt *>(stmt)) {
+    foldTopLevel(bit->initializer);
+    execute(stmt);
+  } else if (auto vector = dynamic_cast<BitVectorDefStmt *>(stmt)) {
+    for (auto &value : vector->values) {
+      foldTopLevel(value);
+    }
+    execute(stmt);
+  } else if (auto print = dynamic_cast<PrintStmt *>(stmt)) {
+    foldTopLevel(print->expression);
+  } else if (auto expression =
+                 dynamic_cast<ExpressionStmt *>(stmt)) {
+    foldTopLevel(expression->expression);
+    unused = true;
+  } else if (auto ret = dynamic_cast<ReturnStmt *>(stmt)) {
+    foldTopLevel(ret->value);
+    unused = true;
+  }
+  // Truth tables and simulations write output, so they are left to the
+  // engine
+}
+
+// Replaces a top-level expression by its value, throwing if it fails
+void ConstantFolder::foldTopLevel(Expr *&expr) {
+  if (dynamic_cast<LiteralExpr *>(expr)) {
+    return;
+  }
+  expr = arena.make<LiteralExpr>(evaluate(expr));
+}
+
+void ConstantFolder::foldCircuit(CircuitDefStmt &stmt) {
+  circuit = &stmt;
+  for (auto &expr : stmt.body) {
+    fold(expr);
+  }
+  for (auto &reg : stmt.registers) {
+    fold(reg.initial);
+    fold(reg.next);
+  }
+  circuit = nullptr;
+}
+
+// Helpers
+
+void ConstantFolder::fold(Expr *&expr) {
+  Expr **previous = slot;
+  slot = &expr;
+  expr->accept(this);
+  slot = previous;
+}
+
+// Replaces an operator whose operands all folded to literals by its value.
+// Operators that fail are left for the engine to report.
+void ConstantFolder::foldOperator(Expr *&expr) {
+  bool constant = true;
+  forEachOperand(*expr, [&](Expr &operand) {
+    constant = constant && dynamic_cast<LiteralExpr *>(&operand);
+  });
+  if (!constant) {
+    return;
+  }
+
+  try {
+    expr = arena.make<LiteralExpr>(evaluate(expr));
+  } catch (std::exception &) {
+  }
+}
+
+void ConstantFolder::execute(Stmt *stmt) {
+  if (engine == Engine::VM) {
+    vm.executeStmt(stmt);
+  } else {
+    evaluator.executeStmt(stmt);
+  }
+}
+
+literal ConstantFolder::evaluate(Expr *expr) {
+  return engine == Engine::VM ? vm.evaluateExpr(expr)
+                              : evaluator.evaluateExpr(expr);
+}
+
+const SymbolSource &ConstantFolder::symbols() const {
+  return engine == Engine::VM ? vm.symbols() : evaluator.symbols();
+}
+
+bool ConstantFolder::isParameter(const std::string &name) const {
+  for (const auto &parameter : circuit->parameters) {
+    if (parameter->lexeme == name) {
+      return true;
+    }
+  }
+  for (const auto &reg : circuit->registers) {
+    if (reg.name->lexeme == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ExprVisitor implementation
+void *ConstantFolder::visitLiteralExpr(LiteralExpr *) { return nullptr; }
+
+void *ConstantFolder::visitVariableExpr(VariableExpr *expr) {
+  if (isParameter(expr->name->lexeme)) {
+    return nullptr;
+  }
+
+  auto found = constants.find(expr->name->lexeme);
+  if (found != constants.end()) {
+    *slot = arena.make<LiteralExpr>(found->second);
+  }
+  return nullptr;
+}
+
+void *ConstantFolder::visitUnaryExpr(UnaryExpr *expr) {
+  fold(expr->right);
+  foldOperator(*slot);
+  return nullptr;
+}
+
+void *ConstantFolder::visitBinaryExpr(BinaryExpr *expr) {
+  fold(expr->left);
+  fold(expr->right);
+  foldOperator(*slot);
+  return nullptr;
+}
+
+void *ConstantFolder::visitMultiExpr(MultiExpr *expr) {
+  for (auto &operand : expr->operands) {
+    fold(operand);
+  }
+  foldOperator(*slot);
+  return nullptr;
+}
+
+void *ConstantFolder::visitGroupingExpr(GroupingExpr *expr) {
+  fold(expr->expression);
+  foldOperator(*slot);
+  return nullptr;
+}
+
+void *ConstantFolder::visitCallExpr(CallExpr *expr) {
+  // The callee may read the caller's frame, so only the arguments fold
+  for (auto &argument : expr->arguments) {
+    fold(argument);
+  }
+  return nullptr;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Evaluator.h"
+#include "Expr.h"
+#include "Options.h"
+#include "Stmt.h"
+#include "VM.h"
+
+// Optimization pass run between parsing and evaluation.
+//
+// A program has no inputs, so every top-level expression is a constant. The
+// pass replays the statements in order on a private instance of the engine
+// that will run the program, and replaces each top-level expression by the
+// value that engine computes. That propagates bit definitions into their
+// uses and folds circuit calls with constant arguments.
+//
+// Circuit bodies are folded where that cannot change their meaning: operators
+// whose operands are all literals, and globals defined exactly once, before
+// the circuit, under a name no circuit parameter can shadow.
+//
+// Finally definitions nothing can read any more are dropped, along with
+// expression statements whose value is unused.
+//
+// Statements are only changed up to the first one that fails, so errors are
+// still reported by the engine, at the same point of the program.
+class ConstantFolder : public ExprVisitor {
+public:
+  struct Stats {
+    size_t nodesBefore = 0;
+    size_t nodesAfter = 0;
+    size_t statementsBefore = 0;
+    size_t statementsAfter = 0;
+  };
+
+private:
+  Arena &arena; // Owns the literals that replace folded expressions
+
+  // Mirrors the globals the engine will have at the statement being folded.
+  // Only the one matching the selected engine is used.
+  Engine engine;
+  Evaluator evaluator;
+  VM vm;
+
+  // Names a circuit body may see through a caller's frame
+  std::unordered_set<std::string> dynamicNames;
+
+  // Globals that may be substituted into circuit bodies defined after them
+  std::unordered_map<std::string, literal> constants;
+
+  const CircuitDefStmt *circuit = nullptr; // Circuit being folded
+
+  // Slot holding the expression being visited, which is replaced by a
+  // LiteralExpr when it folds
+  Expr **slot = nullptr;
+
+  void fold(Expr *&expr);
+  void foldOperator(Expr *&expr);
+  void foldTopLevel(Expr *&expr);
+  void foldCircuit(CircuitDefStmt &stmt);
+  void foldStatement(Stmt *stmt, bool &unused);
+
+  bool isParameter(const std::string &name) const;
+
+  void execute(Stmt *stmt);
+  literal evaluate(Expr *expr);
+  const SymbolSource &symbols() const;
+
+public:
+  ConstantFolder(Arena &arena, Engine engine = Engine::TREE,
+                 const MemoConfig &memo = MemoConfig());
+
+  Stats run(std::vector<Stmt *> &statements);
+
+  // Cache statistics of the calls made while folding
+  std::vector<MemoCache::Stats> memoStats() const {
+    return evaluator.memoStats();
+  }
+
+  // ExprVisitor implementation
+  void *visitLiteralExpr(LiteralExpr *expr) override;
+  void *visitVariableExpr(VariableExpr *expr) override;
+  void *visitUnaryExpr(UnaryExpr *expr) override;
+  void *visitBinaryExpr(BinaryExpr *expr) override;
+  void *visitMultiExpr(MultiExpr *expr) override;
+  void *visitGroupingExpr(GroupingExpr *expr) override;
+  void *visitCallExpr(CallExpr *expr) override;
+};
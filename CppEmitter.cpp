@@ -0,0 +1,158 @@
+#include "CppEmitter.h"
+
+#include <string>
+#include <unordered_set>
+
+#include "BatchSimulator.h"
+#include "Elaborator.h"
+
+namespace {
+
+// Identifiers Bex accepts that C++ reserves. Bex's own operators (and, or,
+// not, xor) can't name circuits, so they never get here.
+const std::unordered_set<std::string> CPP_KEYWORDS = {
+    "alignas", "alignof", "and_eq", "asm", "auto", "bitand", "bitor", "bool",
+    "break", "case", "catch", "char", "class", "co_await", "co_return",
+    "co_yield", "compl", "concept", "const", "const_cast", "consteval",
+    "constexpr", "constinit", "continue", "decltype", "default", "delete", "do",
+    "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+    "false", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+    "main", "mutable", "namespace", "new", "noexcept", "not_eq", "nullptr",
+    "operator", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "requires", "return", "short", "signed", "sizeof",
+    "static", "static_assert", "static_cast", "struct", "switch", "template",
+    "this", "thread_local", "throw", "true", "try", "typedef", "typeid",
+    "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+    "wchar_t", "while", "xor_eq",
+};
+
+std::string functionName(const std::string &circuit) {
+  return CPP_KEYWORDS.count(circuit) ? circuit + "_" : circuit;
+}
+
+std::string word(uint32_t id) { return "n" + std::to_string(id); }
+
+// The right-hand side of a gate, joining its fanins with `op`
+std::string joined(const Netlist &netlist, uint32_t id, const char *op) {
+  const uint32_t *fanin = netlist.faninBegin(id);
+  std::string text = word(fanin[0]);
+  for (uint32_t i = 1; i < netlist.faninCount(id); i++) {
+    text += op;
+    text += word(fanin[i]);
+  }
+  return text;
+}
+
+std::string expression(const Netlist &netlist, uint32_t id,
+                       const std::vector<int64_t> &sources) {
+  switch (netlist.types[id]) {
+  case GateType::INPUT:
+    return "in[" + std::to_string(sources[id]) + "]";
+  case GateType::REGISTER:
+    return "state[" + std::to_string(sources[id]) + "]";
+  case GateType::CONST0:
+    return "0";
+  case GateType::CONST1:
+    return "~uint64_t(0)";
+  case GateType::NOT:
+    return "~" + word(netlist.faninBegin(id)[0]);
+  case GateType::AND:
+    return joined(netlist, id, " & ");
+  case GateType::OR:
+    return joined(netlist, id, " | ");
+  case GateType::XOR:
+    return joined(netlist, id, " ^ ");
+  case GateType::XNOR:
+    return "~(" + joined(netlist, id, " ^ ") + ")";
+  case GateType::NAND:
+    return "~(" + joined(netlist, id, " & ") + ")";
+  case GateType::NOR:
+    return "~(" + joined(netlist, id, " | ") + ")";
+  }
+  return "0";
+}
+
+// The nodes some output or next register value depends on, so the function
+// declares no words it never reads
+std::vector<bool> liveNodes(const Netlist &netlist) {
+  std::vector<bool> live(netlist.nodeCount(), false);
+  for (uint32_t id : netlist.outputs) {
+    live[id] = true;
+  }
+  for (uint32_t id : netlist.registerNext) {
+    live[id] = true;
+  }
+  for (uint32_t id = uint32_t(netlist.nodeCount()); id-- > 0;) {
+    if (live[id]) {
+      for (uint32_t i = 0; i < netlist.faninCount(id); i++) {
+        live[netlist.faninBegin(id)[i]] = true;
+      }
+    }
+  }
+  return live;
+}
+
+} // namespace
+
+void writeCppFunction(const SymbolSource &symbols, const Token *name,
+                      std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = cheapestNetlist(elaborator.elaborate(name));
+  std::string function = functionName(name->lexeme);
+  bool sequential = netlist.isSequential();
+
+  // Position of each source node in the word array it is read from
+  std::vector<int64_t> sources(netlist.nodeCount(), -1);
+  for (size_t i = 0; i < netlist.inputs.size(); i++) {
+    sources[netlist.inputs[i]] = int64_t(i);
+  }
+  for (size_t r = 0; r < netlist.registers.size(); r++) {
+    sources[netlist.registers[r]] = int64_t(r);
+  }
+
+  os << "// Circuit " << name->lexeme << ", bit-sliced: bit k of every word "
+     << "belongs to pattern k,\n"
+     << "// so one call evaluates 64 patterns.\n"
+     << "//\n";
+  for (size_t i = 0; i < netlist.inputs.size(); i++) {
+    os << "//   in[" << i << "]: " << netlist.inputNames[i] << "\n";
+  }
+  os << "//   out[0.." << netlist.outputs.size() << "): body expressions, "
+     << "in order\n";
+  if (sequential) {
+    os << "//   state[0.." << netlist.registers.size() << "): registers, "
+       << "this cycle on entry and the next on return\n";
+  }
+  os << "\n#include <cstdint>\n\n";
+
+  if (sequential) {
+    os << "void " << function << "_reset(uint64_t *state) {\n";
+    for (size_t r = 0; r < netlist.registers.size(); r++) {
+      os << "  state[" << r << "] = "
+         << (netlist.registerInitial[r] ? "~uint64_t(0)" : "0") << ";\n";
+    }
+    os << "}\n\n";
+  }
+
+  os << "void " << function << "(const uint64_t *in, ";
+  if (sequential) {
+    os << "uint64_t *state, ";
+  }
+  os << "uint64_t *out) {\n";
+  std::vector<bool> live = liveNodes(netlist);
+  for (uint32_t id = 0; id < netlist.nodeCount(); id++) {
+    if (!live[id]) {
+      continue;
+    }
+    os << "  const uint64_t " << word(id) << " = "
+       << expression(netlist, id, sources) << ";\n";
+  }
+  for (size_t o = 0; o < netlist.outputs.size(); o++) {
+    os << "  out[" << o << "] = " << word(netlist.outputs[o]) << ";\n";
+  }
+  // Registers are only read above, so they can load in any order
+  for (size_t r = 0; r < netlist.registers.size(); r++) {
+    os << "  state[" << r << "] = " << word(netlist.registerNext[r]) << ";\n";
+  }
+  os << "}\n";
+}
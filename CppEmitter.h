@@ -0,0 +1,22 @@
+#pragma once
+
+#include <iostream>
+
+#include "Environment.h"
+
+// Translates the named circuit into a standalone C++ function over 64-bit
+// words, bit-sliced the way the batch simulator is: bit k of every word
+// belongs to pattern k, so one call evaluates 64 input patterns.
+//
+// The circuit is elaborated, swapped for its optimized And-Inverter Graph
+// when that takes fewer steps, and written as straight-line word operations
+// in topological order, with no branches and no dependency on Bex:
+//
+//   void NAME(const uint64_t *in, uint64_t *out);
+//
+// takes one word per parameter and writes one per body expression. A
+// circuit with registers also takes the register words, which hold the
+// current cycle on entry and the next one on return, and gets a NAME_reset
+// function that loads their initial values.
+void writeCppFunction(const SymbolSource &symbols, const Token *name,
+                      std::ostream &os);
@@ -0,0 +1,65 @@
+#include "CycleSimulator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "BatchSimulator.h"
+#include "Elaborator.h"
+
+namespace {
+
+// Works with any simulator that has run(), output() and clock()
+template <typename Simulator>
+void runCycles(Simulator &sim, size_t outputCount, uint64_t cycles,
+               std::ostream &os) {
+  std::vector<const uint64_t *> outputs;
+  for (size_t o = 0; o < outputCount; o++) {
+    outputs.push_back(sim.output(o));
+  }
+
+  // Whole lines are formatted into a fixed buffer and written when it fills
+  size_t lineSize = outputs.size() + 1;
+  size_t linesPerWrite = std::max<size_t>(1, 64 * 1024 / lineSize);
+  std::vector<char> buffer(linesPerWrite * lineSize);
+  char *out = buffer.data();
+  char *end = out + buffer.size();
+
+  for (uint64_t cycle = 0; cycle < cycles; cycle++) {
+    sim.run();
+    for (const uint64_t *output : outputs) {
+      *out++ = '0' + (*output & 1);
+    }
+    *out++ = '\n';
+    sim.clock();
+
+    if (out == end) {
+      os.write(buffer.data(), buffer.size());
+      out = buffer.data();
+    }
+  }
+
+  os.write(buffer.data(), out - buffer.data());
+  os.flush();
+}
+
+} // namespace
+
+void simulateCycles(const SymbolSource &symbols, const Token *name,
+                    uint64_t cycles, SimulationMode mode, std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = elaborator.elaborate(name);
+  if (!netlist.inputs.empty()) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                 "' has inputs, drive it with --simulate "
+                                 "and --vectors instead.");
+  }
+
+  if (mode == SimulationMode::EVENT_DRIVEN) {
+    EventSimulator sim(netlist);
+    runCycles(sim, netlist.outputs.size(), cycles, os);
+  } else {
+    // A single lane: every cycle depends on the one before
+    BatchSimulator sim(netlist, 1);
+    runCycles(sim, netlist.outputs.size(), cycles, os);
+  }
+}
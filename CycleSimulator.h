@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include "Environment.h"
+#include "EventSimulator.h"
+
+// Elaborates the named circuit, which must have no inputs, and clocks it for
+// `cycles` cycles. Each cycle writes a line with a '0' or '1' per output,
+// computed from the registers' state in that cycle, and then loads every
+// register with its next value. EVENT_DRIVEN re-evaluates only the gates
+// reached by registers that changed.
+void simulateCycles(const SymbolSource &symbols, const Token *name,
+                    uint64_t cycles, SimulationMode mode, std::ostream &os);
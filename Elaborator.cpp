@@ -0,0 +1,260 @@
+#include "Elaborator.h"
+
+#include <algorithm>
+
+Elaborator::Elaborator(const SymbolSource &symbols) : symbols(symbols) {}
+
+Netlist Elaborator::elaborate(const Token *name) {
+  const CircuitDefStmt *circuit = symbols.findCircuit(name->lexeme);
+  if (circuit == nullptr) {
+    throw RuntimeError(name, "Undefined circuit '" + name->lexeme + "'.");
+  }
+
+  netlist = Netlist();
+  netlist.name = name->lexeme;
+  argStack.clear();
+  sharedNodes.assign(circuit->sharedCount, NO_NODE);
+  active.assign(1, circuit);
+
+  for (const auto &param : circuit->parameters) {
+    argStack.push_back(netlist.addInput(param->lexeme));
+  }
+  addRegisters(*circuit);
+
+  Frame top{circuit, 0, 0, nullptr};
+  frame = &top;
+  for (const auto &expr : circuit->body) {
+    netlist.outputs.push_back(elaborateExpr(expr));
+  }
+  connectRegisters(*circuit, 0);
+  frame = nullptr;
+
+  return std::move(netlist);
+}
+
+// Helpers
+
+uint32_t Elaborator::elaborateExpr(Expr *expr) {
+  if (expr->sharedSlot == Expr::NOT_SHARED) {
+    expr->accept(this);
+    return result;
+  }
+
+  size_t shared = frame->sharedBase + expr->sharedSlot;
+  if (sharedNodes[shared] == NO_NODE) {
+    expr->accept(this);
+    sharedNodes[shared] = result;
+  }
+  return sharedNodes[shared];
+}
+
+uint32_t Elaborator::elaborateCall(const Token *callee,
+                                   const ArenaList<Expr *> *arguments) {
+  const CircuitDefStmt *circuit = symbols.findCircuit(callee->lexeme);
+  if (circuit == nullptr) {
+    throw RuntimeError(callee, "Undefined circuit '" + callee->lexeme + "'.");
+  }
+
+  // Without an argument list this is a bare circuit name, which the
+  // Evaluator calls with a single true argument
+  size_t count = arguments != nullptr ? arguments->size() : 1;
+  if (circuit->parameters.size() != count) {
+    throw RuntimeError(callee, "Expected " +
+                                   std::to_string(circuit->parameters.size()) +
+                                   " arguments but got " +
+                                   std::to_string(count) + ".");
+  }
+
+  if (std::find(active.begin(), active.end(), circuit) != active.end()) {
+    throw RuntimeError(callee, "Recursive circuit '" + callee->lexeme +
+                                   "' cannot be elaborated.");
+  }
+
+  // Arguments are elaborated in the caller's frame
+  size_t base = argStack.size();
+  if (arguments != nullptr) {
+    for (const auto &arg : *arguments) {
+      uint32_t node = elaborateExpr(arg);
+      argStack.push_back(node);
+    }
+  } else {
+    argStack.push_back(netlist.addConstant(true));
+  }
+  size_t firstRegister = netlist.registers.size();
+  addRegisters(*circuit);
+
+  size_t sharedBase = sharedNodes.size();
+  sharedNodes.resize(sharedBase + circuit->sharedCount, NO_NODE);
+
+  Frame calleeFrame{circuit, base, sharedBase, frame};
+  const Frame *previous = frame;
+  frame = &calleeFrame;
+  active.push_back(circuit);
+
+  // Only the last body expression is the call's value, the others would be
+  // dead logic
+  uint32_t value = circuit->body.empty()
+                       ? netlist.addConstant(false)
+                       : elaborateExpr(circuit->body.back());
+  connectRegisters(*circuit, firstRegister);
+
+  active.pop_back();
+  frame = previous;
+  sharedNodes.resize(sharedBase);
+
+  argStack.resize(base);
+  return value;
+}
+
+uint32_t Elaborator::elaborateGate(GateType type,
+                                   const ArenaList<Expr *> &operands) {
+  // Operand node IDs are collected on top of the argument stack
+  size_t base = argStack.size();
+  for (const auto &operand : operands) {
+    uint32_t node = elaborateExpr(operand);
+    argStack.push_back(node);
+  }
+
+  uint32_t node =
+      netlist.addGate(type, argStack.data() + base, argStack.size() - base);
+  argStack.resize(base);
+  return node;
+}
+
+// Pushes a register node for each of the circuit's registers on top of its
+// arguments. Their values are filled in by connectRegisters.
+void Elaborator::addRegisters(const CircuitDefStmt &circuit) {
+  for (size_t i = 0; i < circuit.registers.size(); i++) {
+    argStack.push_back(netlist.addRegister(false));
+  }
+}
+
+// Elaborates the initial and next values of the circuit's registers, which
+// are netlist registers [first, first + count), in the current frame
+void Elaborator::connectRegisters(const CircuitDefStmt &circuit,
+                                  size_t first) {
+  for (size_t i = 0; i < circuit.registers.size(); i++) {
+    const Register &reg = circuit.registers[i];
+
+    uint32_t initial = elaborateExpr(reg.initial);
+    GateType type = netlist.types[initial];
+    if (type != GateType::CONST0 && type != GateType::CONST1) {
+      throw RuntimeError(reg.name, "Initial value of register '" +
+                                       reg.name->lexeme +
+                                       "' must be a constant.");
+    }
+    netlist.registerInitial[first + i] = type == GateType::CONST1;
+    netlist.registerNext[first + i] = elaborateExpr(reg.next);
+  }
+}
+
+// ExprVisitor implementation
+void *Elaborator::visitLiteralExpr(LiteralExpr *expr) {
+  if (expr->value.size() != 1) {
+    throw RuntimeError(frame->circuit->name,
+                       "Cannot elaborate a bit vector literal in circuit '" +
+                           frame->circuit->name->lexeme + "'.");
+  }
+
+  result = netlist.addConstant(expr->value.getBit(0));
+  return nullptr;
+}
+
+void *Elaborator::visitVariableExpr(VariableExpr *expr) {
+  const std::string &name = expr->name->lexeme;
+
+  if (symbols.findCircuit(name) != nullptr) {
+    result = elaborateCall(expr->name, nullptr);
+    return nullptr;
+  }
+
+  // Parameters and registers of this circuit, then of its callers
+  for (const Frame *f = frame; f != nullptr; f = f->caller) {
+    const auto &params = f->circuit->parameters;
+    for (size_t i = 0; i < params.size(); i++) {
+      if (params[i]->lexeme == name) {
+        result = argStack[f->argBase + i];
+        return nullptr;
+      }
+    }
+    const auto &registers = f->circuit->registers;
+    for (size_t i = 0; i < registers.size(); i++) {
+      if (registers[i].name->lexeme == name) {
+        result = argStack[f->argBase + params.size() + i];
+        return nullptr;
+      }
+    }
+  }
+
+  const literal *value = symbols.findValue(name);
+  if (value == nullptr) {
+    throw RuntimeError(expr->name, "Undefined variable '" + name + "'.");
+  }
+  if (value->size() != 1) {
+    throw RuntimeError(expr->name,
+                       "Cannot elaborate bit vector '" + name + "'.");
+  }
+
+  result = netlist.addConstant(value->getBit(0));
+  return nullptr;
+}
+
+void *Elaborator::visitUnaryExpr(UnaryExpr *expr) {
+  if (expr->op->type != TokenType::NOT) {
+    throw RuntimeError(expr->op, "Unknown unary operator.");
+  }
+
+  uint32_t operand = elaborateExpr(expr->right);
+  result = netlist.addGate(GateType::NOT, &operand, 1);
+  return nullptr;
+}
+
+void *Elaborator::visitBinaryExpr(BinaryExpr *expr) {
+  GateType type;
+  switch (expr->op->type) {
+  case TokenType::XOR:
+    type = GateType::XOR;
+    break;
+  case TokenType::XNOR:
+    type = GateType::XNOR;
+    break;
+  case TokenType::NAND:
+    type = GateType::NAND;
+    break;
+  case TokenType::NOR:
+    type = GateType::NOR;
+    break;
+  default:
+    throw RuntimeError(expr->op, "Unknown binary operator.");
+  }
+
+  uint32_t operands[2];
+  operands[0] = elaborateExpr(expr->left);
+  operands[1] = elaborateExpr(expr->right);
+  result = netlist.addGate(type, operands, 2);
+  return nullptr;
+}
+
+void *Elaborator::visitMultiExpr(MultiExpr *expr) {
+  switch (expr->op->type) {
+  case TokenType::AND:
+    result = elaborateGate(GateType::AND, expr->operands);
+    break;
+  case TokenType::OR:
+    result = elaborateGate(GateType::OR, expr->operands);
+    break;
+  default:
+    throw RuntimeError(expr->op, "Unknown multi-operand operator.");
+  }
+  return nullptr;
+}
+
+void *Elaborator::visitGroupingExpr(GroupingExpr *expr) {
+  result = elaborateExpr(expr->expression);
+  return nullptr;
+}
+
+void *Elaborator::visitCallExpr(CallExpr *expr) {
+  result = elaborateCall(expr->callee, &expr->arguments);
+  return nullptr;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Environment.h"
+#include "Expr.h"
+#include "Netlist.h"
+#include "Stmt.h"
+
+// Flattens a circuit into a single-bit gate netlist by inlining every
+// circuit call recursively. The circuit's parameters become primary inputs
+// and each of its body expressions becomes a primary output; a nested call
+// contributes only its last body expression, which is its value.
+//
+// Names resolve the way the Evaluator resolves them: a circuit's own
+// parameters first, then its callers' parameters, then global bits, which
+// are folded in as constants. Registers are looked up right after the
+// parameters of their circuit, and every call of a circuit with registers
+// gets registers of its own.
+class Elaborator : public ExprVisitor {
+private:
+  struct Frame {
+    const CircuitDefStmt *circuit;
+    size_t argBase; // Node IDs of the arguments, then of the registers, start
+                    // at argStack[argBase]
+    size_t sharedBase; // Node IDs of shared body nodes start here
+    const Frame *caller;
+  };
+
+  const SymbolSource &symbols;
+  Netlist netlist;
+
+  std::vector<uint32_t> argStack;
+  std::vector<uint32_t> sharedNodes; // NO_NODE until elaborated
+  std::vector<const CircuitDefStmt *> active; // Circuits being inlined
+  const Frame *frame = nullptr;
+
+  // Node ID of the expression just visited
+  uint32_t result = 0;
+
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+  uint32_t elaborateExpr(Expr *expr);
+  uint32_t elaborateCall(const Token *callee,
+                         const ArenaList<Expr *> *arguments);
+  uint32_t elaborateGate(GateType type, const ArenaList<Expr *> &operands);
+  void addRegisters(const CircuitDefStmt &circuit);
+  void connectRegisters(const CircuitDefStmt &circuit, size_t first);
+
+public:
+  Elaborator(const SymbolSource &symbols);
+
+  Netlist elaborate(const Token *name);
+
+  // ExprVisitor implementation
+  void *visitLiteralExpr(LiteralExpr *expr) override;
+  void *visitVariableExpr(VariableExpr *expr) override;
+  void *visitUnaryExpr(UnaryExpr *expr) override;
+  void *visitBinaryExpr(BinaryExpr *expr) override;
+  void *visitMultiExpr(MultiExpr *expr) override;
+  void *visitGroupingExpr(GroupingExpr *expr) override;
+  void *visitCallExpr(CallExpr *expr) override;
+};
@@ -1,61 +1,39 @@
 #include "Environment.h"
 
-void Environment::define(const std::string &name, const literal &value) {
-  values[name] = value;
-}
-
-void Environment::defineCircuit(const std::string &name,
-                                std::shared_ptr<CircuitDefStmt> circuit) {
-  circuits[name] = circuit;
-}
-
-literal Environment::get(const std::shared_ptr<Token> &name) {
-  auto it = values.find(name->lexeme);
-  if (it != values.end()) {
-    return it->second;
+uint32_t Environment::valueSlot(const std::string &name) {
+  auto found = valueSlots.find(name);
+  if (found != valueSlots.end()) {
+    return found->second;
   }
 
-  if (enclosing != nullptr) {
-    return enclosing->get(name);
-  }
-
-  throw RuntimeError(name, "Undefined variable '" + name->lexeme + "'.");
+  uint32_t slot = values.size();
+  valueSlots.emplace(name, slot);
+  values.emplace_back();
+  defined.push_back(false);
+  return slot;
 }
 
-std::shared_ptr<CircuitDefStmt>
-Environment::getCircuit(const std::shared_ptr<Token> &name) {
-  auto it = circuits.find(name->lexeme);
-  if (it != circuits.end()) {
-    return it->second;
-  }
-
-  if (enclosing != nullptr) {
-    return enclosing->getCircuit(name);
+uint32_t Environment::circuitSlot(const std::string &name) {
+  auto found = circuitSlots.find(name);
+  if (found != circuitSlots.end()) {
+    return found->second;
   }
 
-  throw RuntimeError(name, "Undefined circuit '" + name->lexeme + "'.");
+  uint32_t slot = circuits.size();
+  circuitSlots.emplace(name, slot);
+  circuits.push_back(nullptr);
+  return slot;
 }
 
-bool Environment::exists(const std::string &name) const {
-  if (values.find(name) != values.end()) {
-    return true;
-  }
-
-  if (enclosing != nullptr) {
-    return enclosing->exists(name);
-  }
-
-  return false;
+const CircuitDefStmt *Environment::findCircuit(const std::string &name) const {
+  auto found = circuitSlots.find(name);
+  return found != circuitSlots.end() ? circuits[found->second] : nullptr;
 }
 
-bool Environment::circuitExists(const std::string &name) const {
-  if (circuits.find(name) != circuits.end()) {
-    return true;
+const literal *Environment::findValue(const std::string &name) const {
+  auto found = valueSlots.find(name);
+  if (found == valueSlots.end() || !defined[found->second]) {
+    return nullptr;
   }
-
-  if (enclosing != nullptr) {
-    return enclosing->circuitExists(name);
-  }
-
-  return false;
+  return &values[found->second];
 }
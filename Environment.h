@@ -4,6 +4,7 @@
 #include <stdexcept> // Add this include for std::runtime_error
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Expr.h"
 #include "Stmt.h"
@@ -11,30 +12,45 @@
 
 class RuntimeError : public std::runtime_error {
 public:
-  std::shared_ptr<Token> token;
+  const Token *token;
 
-  RuntimeError(std::shared_ptr<Token> token, const std::string &message)
+  RuntimeError(const Token *token, const std::string &message)
       : std::runtime_error(message), token(token) {}
 };
 
-class Environment {
-private:
-  std::unordered_map<std::string, literal> values;
-  std::unordered_map<std::string, std::shared_ptr<CircuitDefStmt>> circuits;
-  std::shared_ptr<Environment> enclosing;
-
+// Read-only view of the globally visible circuits and values, used by the
+// passes that work on whole circuits rather than executing statements
+class SymbolSource {
 public:
-  Environment() : enclosing(nullptr) {}
-  Environment(std::shared_ptr<Environment> enclosing) : enclosing(enclosing) {}
+  virtual ~SymbolSource() = default;
 
-  void define(const std::string &name, const literal &value);
-  void defineCircuit(const std::string &name,
-                     std::shared_ptr<CircuitDefStmt> circuit);
+  virtual const CircuitDefStmt *findCircuit(const std::string &name) const = 0;
+  virtual const literal *findValue(const std::string &name) const = 0;
+};
 
-  literal get(const std::shared_ptr<Token> &name);
-  std::shared_ptr<CircuitDefStmt>
-  getCircuit(const std::shared_ptr<Token> &name);
+// Global values and circuits, stored in slots the Resolver assigns to each
+// name, so executing code indexes vectors instead of hashing names. Values
+// and circuits are separate namespaces, like they are in the language.
+class Environment : public SymbolSource {
+private:
+  std::unordered_map<std::string, uint32_t> valueSlots;
+  std::unordered_map<std::string, uint32_t> circuitSlots;
 
-  bool exists(const std::string &name) const;
-  bool circuitExists(const std::string &name) const;
+public:
+  std::vector<literal> values;
+  std::vector<bool> defined;
+  std::vector<const CircuitDefStmt *> circuits; // nullptr until defined
+
+  // Slot of a name, added on first use
+  uint32_t valueSlot(const std::string &name);
+  uint32_t circuitSlot(const std::string &name);
+
+  void define(uint32_t slot, const literal &value) {
+    values[slot] = value;
+    defined[slot] = true;
+  }
+
+  // SymbolSource implementation
+  const CircuitDefStmt *findCircuit(const std::string &name) const override;
+  const literal *findValue(const std::string &name) const override;
 };
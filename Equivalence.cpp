@@ -0,0 +1,322 @@
+#include "Equivalence.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "BatchSimulator.h"
+#include "Elaborator.h"
+#include "Sat.h"
+
+namespace {
+
+using Literal = SatSolver::Literal;
+
+constexpr size_t RANDOM_ROUNDS = 8; // Of 512 vectors each
+
+Netlist elaborateCombinational(const SymbolSource &symbols,
+                               const Token *name) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = elaborator.elaborate(name);
+  if (netlist.isSequential()) {
+    throw RuntimeError(name,
+                       "Circuit '" + name->lexeme +
+                           "' has registers, so it can't be checked for "
+                           "equivalence.");
+  }
+  return netlist;
+}
+
+// Tseitin encoder shared by both circuits of a miter. Gates are hashed on
+// their normalized operands, so logic the circuits have in common, or that
+// inlining copied, gets a single variable, and constants are folded away.
+class Encoder {
+private:
+  SatSolver &solver;
+  Literal trueLiteral;
+  std::map<std::vector<Literal>, Literal> andGates;
+  std::unordered_map<uint64_t, Literal> xorGates;
+
+public:
+  explicit Encoder(SatSolver &solver) : solver(solver) {
+    trueLiteral = SatSolver::positive(solver.newVariable());
+    solver.addClause({trueLiteral});
+  }
+
+  Literal constant(bool value) const {
+    return value ? trueLiteral : SatSolver::negate(trueLiteral);
+  }
+
+  Literal andGate(std::vector<Literal> operands) {
+    std::sort(operands.begin(), operands.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < operands.size(); i++) {
+      Literal operand = operands[i];
+      if (operand == constant(false) ||
+          (kept > 0 && operands[kept - 1] == SatSolver::negate(operand))) {
+        return constant(false);
+      }
+      if (operand == trueLiteral ||
+          (kept > 0 && operands[kept - 1] == operand)) {
+        continue;
+      }
+      operands[kept++] = operand;
+    }
+    operands.resize(kept);
+    if (operands.empty()) {
+      return trueLiteral;
+    }
+    if (operands.size() == 1) {
+      return operands[0];
+    }
+
+    auto found = andGates.find(operands);
+    if (found != andGates.end()) {
+      return found->second;
+    }
+    Literal gate = SatSolver::positive(solver.newVariable());
+    std::vector<Literal> all{gate};
+    for (Literal operand : operands) {
+      solver.addClause({SatSolver::negate(gate), operand});
+      all.push_back(SatSolver::negate(operand));
+    }
+    solver.addClause(all);
+    andGates.emplace(std::move(operands), gate);
+    return gate;
+  }
+
+  // Complemented operands complement the result, so they are factored out
+  Literal xorGate(Literal a, Literal b) {
+    Literal complement = (a ^ b) & 1;
+    a &= ~Literal(1);
+    b &= ~Literal(1);
+    if (a == b) {
+      return constant(complement);
+    }
+    if (a > b) {
+      std::swap(a, b);
+    }
+    if (a == trueLiteral) {
+      return b ^ complement ^ 1;
+    }
+
+    uint64_t key = uint64_t(a) << 32 | b;
+    auto found = xorGates.find(key);
+    if (found != xorGates.end()) {
+      return found->second ^ complement;
+    }
+    Literal gate = SatSolver::positive(solver.newVariable());
+    Literal notGate = SatSolver::negate(gate);
+    Literal notA = SatSolver::negate(a);
+    Literal notB = SatSolver::negate(b);
+    solver.addClause({notGate, a, b});
+    solver.addClause({notGate, notA, notB});
+    solver.addClause({gate, notA, b});
+    solver.addClause({gate, a, notB});
+    xorGates.emplace(key, gate);
+    return gate ^ complement;
+  }
+
+  // Encodes a netlist with its inputs bound to the given literals and
+  // returns the literal of every node. The inverting gates are the
+  // complements of AND, OR and XOR, and an OR is an AND of complements, so
+  // only AND and XOR gates need variables of their own.
+  std::vector<Literal> encode(const Netlist &netlist,
+                              const std::vector<Literal> &inputs) {
+    std::vector<Literal> literals(netlist.nodeCount(), trueLiteral);
+    for (size_t i = 0; i < netlist.inputs.size(); i++) {
+      literals[netlist.inputs[i]] = inputs[i];
+    }
+
+    std::vector<Literal> operands;
+    for (uint32_t id = 0; id < netlist.nodeCount(); id++) {
+      const uint32_t *fanin = netlist.faninBegin(id);
+      uint32_t count = netlist.faninCount(id);
+      GateType type = netlist.types[id];
+      Literal literal = literals[id];
+
+      switch (type) {
+      case GateType::INPUT:
+      case GateType::REGISTER:
+      case GateType::CONST1:
+        break;
+      case GateType::CONST0:
+        literal = constant(false);
+        break;
+      case GateType::NOT:
+        literal = SatSolver::negate(literals[fanin[0]]);
+        break;
+      case GateType::AND:
+      case GateType::NAND:
+        operands.clear();
+        for (uint32_t i = 0; i < count; i++) {
+          operands.push_back(literals[fanin[i]]);
+        }
+        literal = andGate(operands);
+        break;
+      case GateType::OR:
+      case GateType::NOR:
+        operands.clear();
+        for (uint32_t i = 0; i < count; i++) {
+          operands.push_back(SatSolver::negate(literals[fanin[i]]));
+        }
+        literal = SatSolver::negate(andGate(operands));
+        break;
+      case GateType::XOR:
+      case GateType::XNOR:
+        literal = literals[fanin[0]];
+        for (uint32_t i = 1; i < count; i++) {
+          literal = xorGate(literal, literals[fanin[i]]);
+        }
+        break;
+      }
+      if (type == GateType::NAND || type == GateType::NOR ||
+          type == GateType::XNOR) {
+        literal = SatSolver::negate(literal);
+      }
+      literals[id] = literal;
+    }
+    return literals;
+  }
+};
+
+// Looks for a difference on random vectors, bit-sliced 512 at a time.
+// Fills `vector` and returns true if it finds one.
+bool findRandomDifference(const Netlist &first, const Netlist &second,
+                          std::vector<bool> &vector) {
+  BatchSimulator a(first, 8);
+  BatchSimulator b(second, 8);
+  size_t inputCount = first.inputs.size();
+  size_t lanes = a.laneCount();
+  uint64_t state = 0x9E3779B97F4A7C15ULL; // Fixed, so reports repeat
+
+  for (size_t round = 0; round < RANDOM_ROUNDS; round++) {
+    for (size_t i = 0; i < inputCount; i++) {
+      for (size_t lane = 0; lane < lanes; lane++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        a.input(i)[lane] = state;
+        b.input(i)[lane] = state;
+      }
+    }
+    a.run();
+    b.run();
+
+    for (size_t o = 0; o < first.outputs.size(); o++) {
+      for (size_t lane = 0; lane < lanes; lane++) {
+        uint64_t differ = a.output(o)[lane] ^ b.output(o)[lane];
+        if (differ != 0) {
+          int bit = __builtin_ctzll(differ);
+          vector.resize(inputCount);
+          for (size_t i = 0; i < inputCount; i++) {
+            vector[i] = (a.input(i)[lane] >> bit) & 1;
+          }
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+std::vector<bool> simulateOnce(const Netlist &netlist,
+                               const std::vector<bool> &vector) {
+  BatchSimulator sim(netlist, 1);
+  for (size_t i = 0; i < vector.size(); i++) {
+    sim.input(i)[0] = vector[i];
+  }
+  sim.run();
+  std::vector<bool> outputs(netlist.outputs.size());
+  for (size_t o = 0; o < outputs.size(); o++) {
+    outputs[o] = sim.output(o)[0] & 1;
+  }
+  return outputs;
+}
+
+} // namespace
+
+void writeEquivalenceReport(const SymbolSource &symbols, const Token *first,
+                            const Token *second, std::ostream &os) {
+  Netlist a = elaborateCombinational(symbols, first);
+  Netlist b = elaborateCombinational(symbols, second);
+  auto mismatch = [&](const char *what, size_t countA, size_t countB) {
+    return RuntimeError(second, "Circuits '" + first->lexeme + "' and '" +
+                                    second->lexeme + "' have different " +
+                                    "numbers of " + what + " (" +
+                                    std::to_string(countA) + " and " +
+                                    std::to_string(countB) + ").");
+  };
+  if (a.inputs.size() != b.inputs.size()) {
+    throw mismatch("inputs", a.inputs.size(), b.inputs.size());
+  }
+  if (a.outputs.size() != b.outputs.size()) {
+    throw mismatch("outputs", a.outputs.size(), b.outputs.size());
+  }
+
+  std::vector<bool> counterexample;
+  bool differ = findRandomDifference(a, b, counterexample);
+  SatSolver solver;
+
+  if (!differ) {
+    Encoder encoder(solver);
+    std::vector<Literal> inputs;
+    for (size_t i = 0; i < a.inputs.size(); i++) {
+      inputs.push_back(SatSolver::positive(solver.newVariable()));
+    }
+    std::vector<Literal> literalsA = encoder.encode(a, inputs);
+    std::vector<Literal> literalsB = encoder.encode(b, inputs);
+
+    // Some pair of outputs differs. Outputs that hashed to the same literal
+    // are equal already.
+    std::vector<Literal> miter;
+    for (size_t o = 0; o < a.outputs.size(); o++) {
+      Literal differs =
+          encoder.xorGate(literalsA[a.outputs[o]], literalsB[b.outputs[o]]);
+      if (differs != encoder.constant(false)) {
+        miter.push_back(differs);
+      }
+    }
+    solver.addClause(miter);
+
+    if (solver.solve() == SatSolver::Result::SATISFIABLE) {
+      differ = true;
+      for (Literal input : inputs) {
+        counterexample.push_back(
+            solver.modelValue(SatSolver::variableOf(input)));
+      }
+    }
+  }
+
+  os << "Circuits " << first->lexeme << " and " << second->lexeme;
+  if (differ) {
+    os << " differ on input ";
+    for (bool bit : counterexample) {
+      os << (bit ? '1' : '0');
+    }
+    os << "\n";
+    std::vector<bool> outputsA = simulateOnce(a, counterexample);
+    std::vector<bool> outputsB = simulateOnce(b, counterexample);
+    for (size_t o = 0; o < outputsA.size(); o++) {
+      if (outputsA[o] != outputsB[o]) {
+        os << "  output " << o + 1 << ": " << outputsA[o] << " in "
+           << first->lexeme << ", " << outputsB[o] << " in "
+           << second->lexeme << "\n";
+      }
+    }
+  } else {
+    os << " are equivalent\n";
+  }
+
+  if (solver.variableCount() == 0) {
+    os << "  found by random simulation\n";
+    return;
+  }
+  const SatSolver::Stats &stats = solver.statistics();
+  os << "  " << solver.variableCount() << " variables, "
+     << solver.clauseCount() << " clauses; " << stats.decisions
+     << " decisions, " << stats.conflicts << " conflicts, "
+     << stats.propagations << " propagations, " << stats.restarts
+     << " restarts, " << stats.learntClauses << " learnt clauses\n";
+}
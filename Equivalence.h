@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iostream>
+
+#include "Environment.h"
+
+// Proves two combinational circuits equivalent or finds an input vector on
+// which they differ. Inputs are matched by parameter position and outputs by
+// body position, so the circuits need the same numbers of both.
+//
+// Both circuits are elaborated and first simulated on a few thousand random
+// vectors, which catches most differences at once. Otherwise their netlists
+// are Tseitin-encoded over shared input variables into one SAT instance, the
+// miter, with structurally equal gates merged. Its only constraint beyond
+// the gates is that some pair of outputs differs, so the circuits are
+// equivalent exactly when it is unsatisfiable.
+//
+// Writes the verdict, and for a difference the counterexample with the
+// outputs it separates, as both circuits compute them
+void writeEquivalenceReport(const SymbolSource &symbols, const Token *first,
+                            const Token *second, std::ostream &os);
@@ -1,8 +1,17 @@
 #include "Evaluator.h"
 
-Evaluator::Evaluator() : environment(std::make_shared<Environment>()) {}
+#include "Resolver.h"
+
+Evaluator::Evaluator() {}
+
+void Evaluator::resolve(const std::vector<Stmt *> &statements) {
+  Resolver resolver(environment);
+  resolver.resolve(statements);
+}
+
+bool Evaluator::evaluate(const std::vector<Stmt *> &statements) {
+  resolve(statements);
 
-void Evaluator::evaluate(const std::vector<std::shared_ptr<Stmt>> &statements) {
   try {
     for (const auto &stmt : statements) {
       executeStmt(stmt);
@@ -10,349 +19,220 @@ void Evaluator::evaluate(const std::vector<std::shared_ptr<Stmt>> &statements) {
   } catch (RuntimeError &error) {
     std::cerr << "[line " << error.token->line
               << "] Runtime Error: " << error.what() << std::endl;
+    // A session keeps running after an error, so drop the operands the
+    // failed statement left behind
+    operandStack.clear();
+    return false;
   }
+  return true;
 }
 
-literal Evaluator::evaluateExpr(std::shared_ptr<Expr> expr) {
-  return *static_cast<literal *>(expr->accept(this));
+literal Evaluator::evaluateExpr(Expr *expr) {
+  literal value;
+  evaluateExpr(expr, value);
+  return value;
 }
 
-void Evaluator::executeStmt(std::shared_ptr<Stmt> stmt) { stmt->accept(this); }
-
-// Helper methods for boolean operations
+void Evaluator::evaluateExpr(Expr *expr, literal &out) {
+  size_t shared = sharedBase + expr->sharedSlot;
+  if (expr->sharedSlot != Expr::NOT_SHARED && sharedReady[shared]) {
+    out = sharedValues[shared];
+    return;
+  }
 
-literal Evaluator::performNot(const literal &operand) {
-  literal result;
-  result.is_bitvector = operand.is_bitvector;
+  literal *previous = result;
+  result = &out;
+  expr->accept(this);
+  result = previous;
 
-  if (operand.is_bitvector) {
-    result.bits.resize(operand.bits.size());
-    for (size_t i = 0; i < operand.bits.size(); i++) {
-      result.bits[i] = !operand.bits[i];
-    }
-
-    // If it's a single-bit bitvector, also set the boolean value
-    if (operand.bits.size() == 1) {
-      result.boolean = !operand.boolean;
-    }
-  } else {
-    result.boolean = !operand.boolean;
+  if (expr->sharedSlot != Expr::NOT_SHARED) {
+    sharedValues[shared] = out;
+    sharedReady[shared] = true;
   }
-
-  return result;
 }
 
-literal Evaluator::performAnd(const std::vector<literal> &operands) {
-  // Check if all operands are bit vectors of the same size or bits
-  bool allBits = true;
-  bool allBitVectors = true;
-  size_t vectorSize = 0;
+void Evaluator::executeStmt(Stmt *stmt) { stmt->accept(this); }
 
-  for (const auto &op : operands) {
-    if (op.is_bitvector && op.bits.size() > 1) {
-      allBits = false;
-      if (vectorSize == 0) {
-        vectorSize = op.bits.size();
-      } else if (vectorSize != op.bits.size()) {
-        throw std::runtime_error(
-            "Cannot perform AND on bit vectors of different sizes");
-      }
-    } else {
-      allBitVectors = false;
-    }
+// Helper for circuit calls
+void Evaluator::executeCircuitCall(const Token *name, uint32_t slot,
+                                   const literal *arguments, size_t count,
+                                   literal &out) {
+  // Get the circuit definition
+  const CircuitDefStmt *circuit = environment.circuits[slot];
+  if (circuit == nullptr) {
+    throw RuntimeError(name, "Undefined circuit '" + name->lexeme + "'.");
   }
-
-  literal result;
-
-  if (allBitVectors && !allBits && vectorSize > 0) {
-    // Perform bit-vector AND
-    result.is_bitvector = true;
-    result.bits.resize(vectorSize, true); // Initialize all bits to 1 (true)
-
-    for (const auto &op : operands) {
-      if (op.is_bitvector && op.bits.size() > 1) {
-        for (size_t i = 0; i < vectorSize; i++) {
-          result.bits[i] = result.bits[i] && op.bits[i];
-        }
-      } else {
-        // Single bit value applied to all positions
-        bool bitValue = op.is_bitvector ? op.bits[0] : op.boolean;
-        for (size_t i = 0; i < vectorSize; i++) {
-          result.bits[i] = result.bits[i] && bitValue;
-        }
-      }
-    }
-  } else {
-    // Perform single-bit AND
-    result.is_bitvector = true;
-    result.bits.resize(1, true); // Initialize to true
-    result.boolean = true;
-
-    for (const auto &op : operands) {
-      bool bitValue = op.is_bitvector ? op.bits[0] : op.boolean;
-      result.bits[0] = result.bits[0] && bitValue;
-      result.boolean = result.boolean && bitValue;
-    }
+  if (!circuit->registers.empty()) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                 "' has registers and can only be simulated.");
   }
 
-  return result;
-}
-
-literal Evaluator::performOr(const std::vector<literal> &operands) {
-  // Check if all operands are bit vectors of the same size or bits
-  bool allBits = true;
-  bool allBitVectors = true;
-  size_t vectorSize = 0;
-
-  for (const auto &op : operands) {
-    if (op.is_bitvector && op.bits.size() > 1) {
-      allBits = false;
-      if (vectorSize == 0) {
-        vectorSize = op.bits.size();
-      } else if (vectorSize != op.bits.size()) {
-        throw std::runtime_error(
-            "Cannot perform OR on bit vectors of different sizes");
-      }
-    } else {
-      allBitVectors = false;
-    }
+  // Bind arguments to parameters
+  if (circuit->parameters.size() != count) {
+    throw RuntimeError(name, "Expected " +
+                                 std::to_string(circuit->parameters.size()) +
+                                 " arguments but got " +
+                                 std::to_string(count) + ".");
   }
 
-  literal result;
-
-  if (allBitVectors && !allBits && vectorSize > 0) {
-    // Perform bit-vector OR
-    result.is_bitvector = true;
-    result.bits.resize(vectorSize, false); // Initialize all bits to 0 (false)
-
-    for (const auto &op : operands) {
-      if (op.is_bitvector && op.bits.size() > 1) {
-        for (size_t i = 0; i < vectorSize; i++) {
-          result.bits[i] = result.bits[i] || op.bits[i];
-        }
-      } else {
-        // Single bit value applied to all positions
-        bool bitValue = op.is_bitvector ? op.bits[0] : op.boolean;
-        for (size_t i = 0; i < vectorSize; i++) {
-          result.bits[i] = result.bits[i] || bitValue;
-        }
-      }
-    }
-  } else {
-    // Perform single-bit OR
-    result.is_bitvector = true;
-    result.bits.resize(1, false); // Initialize to false
-    result.boolean = false;
-
-    for (const auto &op : operands) {
-      bool bitValue = op.is_bitvector ? op.bits[0] : op.boolean;
-      result.bits[0] = result.bits[0] || bitValue;
-      result.boolean = result.boolean || bitValue;
-    }
+  MemoCache *memo = memoConfig.enabled() ? memoFor(circuit) : nullptr;
+  if (memo && memo->lookup(arguments, count, out)) {
+    return;
   }
 
-  return result;
-}
+  // Push the circuit's frame
+  size_t base = frameValues.size();
+  frameValues.resize(base + count);
+  for (size_t i = 0; i < count; i++) {
+    frameValues[base + i] = arguments[i];
+  }
+  frames.push_back(Frame{circuit, base});
 
-literal Evaluator::performXor(const literal &left, const literal &right) {
-  literal result;
+  // Start with an empty cache for the body's shared nodes
+  size_t previousShared = sharedBase;
+  sharedBase = sharedValues.size();
+  sharedValues.resize(sharedBase + circuit->sharedCount);
+  sharedReady.resize(sharedBase + circuit->sharedCount, false);
 
-  // Check if both operands are bit vectors of the same size
-  if (left.is_bitvector && right.is_bitvector && left.bits.size() > 1 &&
-      right.bits.size() > 1) {
+  out = literal::fromBit(false);
 
-    if (left.bits.size() != right.bits.size()) {
-      throw std::runtime_error(
-          "Cannot perform XOR on bit vectors of different sizes");
+  try {
+    // Execute each expression in the circuit body, the last one is the result
+    for (size_t i = 0; i < circuit->body.size(); i++) {
+      evaluateExpr(circuit->body[i], out);
     }
+  } catch (...) {
+    // Pop the frame before re-throwing
+    frames.pop_back();
+    frameValues.resize(base);
+    sharedValues.resize(sharedBase);
+    sharedReady.resize(sharedBase);
+    sharedBase = previousShared;
+    throw;
+  }
 
-    // Perform bit-vector XOR
-    result.is_bitvector = true;
-    result.bits.resize(left.bits.size());
+  // Pop the frame
+  frames.pop_back();
+  frameValues.resize(base);
+  sharedValues.resize(sharedBase);
+  sharedReady.resize(sharedBase);
+  sharedBase = previousShared;
 
-    for (size_t i = 0; i < left.bits.size(); i++) {
-      result.bits[i] = left.bits[i] != right.bits[i];
-    }
-  } else {
-    // Perform single-bit XOR
-    bool leftBit = left.is_bitvector ? left.bits[0] : left.boolean;
-    bool rightBit = right.is_bitvector ? right.bits[0] : right.boolean;
-
-    result.is_bitvector = true;
-    result.bits.resize(1);
-    result.bits[0] = leftBit != rightBit;
-    result.boolean = leftBit != rightBit;
+  if (memo) {
+    memo->insert(out);
   }
-
-  return result;
 }
 
-literal Evaluator::performXnor(const literal &left, const literal &right) {
-  literal result;
-
-  // Check if both operands are bit vectors of the same size
-  if (left.is_bitvector && right.is_bitvector && left.bits.size() > 1 &&
-      right.bits.size() > 1) {
-
-    if (left.bits.size() != right.bits.size()) {
-      throw std::runtime_error(
-          "Cannot perform XNOR on bit vectors of different sizes");
-    }
-
-    // Perform bit-vector XNOR
-    result.is_bitvector = true;
-    result.bits.resize(left.bits.size());
-
-    for (size_t i = 0; i < left.bits.size(); i++) {
-      result.bits[i] = left.bits[i] == right.bits[i];
+// Value of a name that is not a parameter of the circuit reading it: the
+// innermost caller's parameter of that name, else the global
+const literal &Evaluator::lookup(const VariableExpr *expr) const {
+  for (size_t f = frames.size(); f-- > 0;) {
+    const std::vector<uint32_t> &slots = frames[f].circuit->parameterSlots;
+    for (size_t i = slots.size(); i-- > 0;) {
+      if (slots[i] == expr->valueSlot) {
+        return frameValues[frames[f].base + i];
+      }
     }
-  } else {
-    // Perform single-bit XNOR
-    bool leftBit = left.is_bitvector ? left.bits[0] : left.boolean;
-    bool rightBit = right.is_bitvector ? right.bits[0] : right.boolean;
-
-    result.is_bitvector = true;
-    result.bits.resize(1);
-    result.bits[0] = leftBit == rightBit;
-    result.boolean = leftBit == rightBit;
   }
 
-  return result;
+  if (!environment.defined[expr->valueSlot]) {
+    throw RuntimeError(expr->name,
+                       "Undefined variable '" + expr->name->lexeme + "'.");
+  }
+  return environment.values[expr->valueSlot];
 }
 
-literal Evaluator::performNand(const literal &left, const literal &right) {
-  literal result;
-
-  // Check if both operands are bit vectors of the same size
-  if (left.is_bitvector && right.is_bitvector && left.bits.size() > 1 &&
-      right.bits.size() > 1) {
-
-    if (left.bits.size() != right.bits.size()) {
-      throw std::runtime_error(
-          "Cannot perform NAND on bit vectors of different sizes");
-    }
-
-    // Perform bit-vector NAND
-    result.is_bitvector = true;
-    result.bits.resize(left.bits.size());
-
-    for (size_t i = 0; i < left.bits.size(); i++) {
-      result.bits[i] = !(left.bits[i] && right.bits[i]);
-    }
-  } else {
-    // Perform single-bit NAND
-    bool leftBit = left.is_bitvector ? left.bits[0] : left.boolean;
-    bool rightBit = right.is_bitvector ? right.bits[0] : right.boolean;
+// Circuit result caching
+void Evaluator::setMemoConfig(const MemoConfig &config) {
+  memoConfig = config;
+  memos.clear();
+  purity.clear();
+}
 
-    result.is_bitvector = true;
-    result.bits.resize(1);
-    result.bits[0] = !(leftBit && rightBit);
-    result.boolean = !(leftBit && rightBit);
+std::vector<MemoCache::Stats> Evaluator::memoStats() const {
+  std::vector<MemoCache::Stats> stats;
+  for (const auto &memo : memos) {
+    stats.push_back(memo.second->getStats());
   }
-
-  return result;
+  return stats;
 }
 
-literal Evaluator::performNor(const literal &left, const literal &right) {
-  literal result;
-
-  // Check if both operands are bit vectors of the same size
-  if (left.is_bitvector && right.is_bitvector && left.bits.size() > 1 &&
-      right.bits.size() > 1) {
-
-    if (left.bits.size() != right.bits.size()) {
-      throw std::runtime_error(
-          "Cannot perform NOR on bit vectors of different sizes");
-    }
-
-    // Perform bit-vector NOR
-    result.is_bitvector = true;
-    result.bits.resize(left.bits.size());
-
-    for (size_t i = 0; i < left.bits.size(); i++) {
-      result.bits[i] = !(left.bits[i] || right.bits[i]);
-    }
-  } else {
-    // Perform single-bit NOR
-    bool leftBit = left.is_bitvector ? left.bits[0] : left.boolean;
-    bool rightBit = right.is_bitvector ? right.bits[0] : right.boolean;
-
-    result.is_bitvector = true;
-    result.bits.resize(1);
-    result.bits[0] = !(leftBit || rightBit);
-    result.boolean = !(leftBit || rightBit);
+// Cache of a circuit, or nullptr when its calls must not be cached
+MemoCache *Evaluator::memoFor(const CircuitDefStmt *circuit) {
+  if (!memoConfig.enabledFor(circuit->name->lexeme) || !isPure(circuit)) {
+    return nullptr;
   }
 
-  return result;
+  std::unique_ptr<MemoCache> &memo = memos[circuit];
+  if (!memo) {
+    memo = std::make_unique<MemoCache>(circuit->name->lexeme,
+                                       memoConfig.capacity);
+  }
+  return memo.get();
 }
 
-// Helper for circuit calls
-literal Evaluator::executeCircuitCall(const std::shared_ptr<Token> &name,
-                                      const std::vector<literal> &arguments) {
-  // Get the circuit definition
-  std::shared_ptr<CircuitDefStmt> circuit = environment->getCircuit(name);
-
-  // Create a new environment for the circuit execution
-  std::shared_ptr<Environment> circuitEnv =
-      std::make_shared<Environment>(environment);
-
-  // Bind arguments to parameters
-  if (circuit->parameters.size() != arguments.size()) {
-    throw RuntimeError(name, "Expected " +
-                                 std::to_string(circuit->parameters.size()) +
-                                 " arguments but got " +
-                                 std::to_string(arguments.size()) + ".");
+bool Evaluator::isPure(const CircuitDefStmt *circuit) {
+  auto found = purity.find(circuit);
+  if (found != purity.end()) {
+    return found->second;
   }
 
-  for (size_t i = 0; i < circuit->parameters.size(); i++) {
-    circuitEnv->define(circuit->parameters[i]->lexeme, arguments[i]);
+  // A circuit reached again while it is being checked calls itself
+  if (!checking.insert(circuit).second) {
+    return false;
   }
 
-  // Execute the circuit body
-  std::shared_ptr<Environment> previous = environment;
-  environment = circuitEnv;
+  bool pure = true;
+  for (const auto &expr : circuit->body) {
+    pure = pure && isPureExpr(*expr, circuit);
+  }
 
-  literal result;
-  result.is_bitvector = true;
-  result.bits = {false};
-  result.boolean = false;
+  checking.erase(circuit);
+  purity[circuit] = pure;
+  return pure;
+}
 
-  try {
-    // Execute each expression in the circuit body
-    for (size_t i = 0; i < circuit->body.size(); i++) {
-      auto expr = circuit->body[i];
-      result = evaluateExpr(expr);
+bool Evaluator::isPureExpr(Expr &expr, const CircuitDefStmt *circuit) {
+  // Names are resolved like visitVariableExpr and visitCallExpr do: a
+  // circuit first, then the innermost binding
+  if (auto *variable = dynamic_cast<VariableExpr *>(&expr)) {
+    if (const CircuitDefStmt *callee =
+            environment.circuits[variable->circuitSlot]) {
+      return isPure(callee);
     }
-  } catch (...) {
-    // Restore the environment before re-throwing
-    environment = previous;
-    throw;
+    return variable->parameter != Expr::NO_SLOT;
   }
 
-  // Restore the environment
-  environment = previous;
+  if (auto *call = dynamic_cast<CallExpr *>(&expr)) {
+    const CircuitDefStmt *callee = environment.circuits[call->circuitSlot];
+    if (!callee || !isPure(callee)) {
+      return false;
+    }
+  }
 
-  return result;
+  bool pure = true;
+  forEachOperand(expr, [&](Expr &operand) {
+    pure = pure && isPureExpr(operand, circuit);
+  });
+  return pure;
 }
 
 // Type checking and error handling
 bool Evaluator::isBit(const literal &value) const {
-  return value.is_bitvector && value.bits.size() == 1;
+  return value.is_bitvector && value.size() == 1;
 }
 
 bool Evaluator::isBitVector(const literal &value) const {
-  return value.is_bitvector && value.bits.size() > 1;
+  return value.is_bitvector && value.size() > 1;
 }
 
-void Evaluator::checkBitOperand(const std::shared_ptr<Token> &op,
-                                const literal &operand) {
+void Evaluator::checkBitOperand(const Token *op, const literal &operand) {
   if (!isBit(operand)) {
     throw RuntimeError(op, "Operand must be a bit.");
   }
 }
 
-void Evaluator::checkBitVectorOperand(const std::shared_ptr<Token> &op,
-                                      const literal &operand) {
+void Evaluator::checkBitVectorOperand(const Token *op, const literal &operand) {
   if (!isBitVector(operand)) {
     throw RuntimeError(op, "Operand must be a bit vector.");
   }
@@ -360,92 +240,128 @@ void Evaluator::checkBitVectorOperand(const std::shared_ptr<Token> &op,
 
 // ExprVisitor implementation
 void *Evaluator::visitLiteralExpr(LiteralExpr *expr) {
-  return new literal(expr->value);
+  *result = expr->value;
+  return nullptr;
 }
 
 void *Evaluator::visitVariableExpr(VariableExpr *expr) {
-  // Check if this is a circuit call
-  if (environment->circuitExists(expr->name->lexeme)) {
-    // This is a circuit call
-    // For now, we'll treat it as a variable
-    // In a complete implementation, we would collect arguments
-    // and call executeCircuitCall
-    std::vector<literal> arguments;
-
-    // For testing purposes, provide dummy arguments
-    literal dummy;
-    dummy.is_bitvector = true;
-    dummy.bits = {true};
-    dummy.boolean = true;
-
-    arguments.push_back(dummy);
-
-    return new literal(executeCircuitCall(expr->name, arguments));
+  // A bare circuit name is a call with a single true argument
+  if (environment.circuits[expr->circuitSlot] != nullptr) {
+    literal argument = literal::fromBit(true);
+    executeCircuitCall(expr->name, expr->circuitSlot, &argument, 1, *result);
+    return nullptr;
   }
 
-  // Normal variable reference
-  literal value = environment->get(expr->name);
-  return new literal(value);
+  if (expr->parameter != Expr::NO_SLOT) {
+    *result = frameValues[frames.back().base + expr->parameter];
+  } else {
+    *result = lookup(expr);
+  }
+  return nullptr;
 }
 
 void *Evaluator::visitUnaryExpr(UnaryExpr *expr) {
-  literal right = evaluateExpr(expr->right);
+  literal &out = *result;
+  evaluateExpr(expr->right, out);
 
   if (expr->op->type == TokenType::NOT) {
-    return new literal(performNot(right));
+    out = performNot(out);
+    return nullptr;
   }
 
   throw RuntimeError(expr->op, "Unknown unary operator.");
 }
 
 void *Evaluator::visitBinaryExpr(BinaryExpr *expr) {
-  literal left = evaluateExpr(expr->left);
-  literal right = evaluateExpr(expr->right);
+  literal &out = *result;
+  literal right;
+  evaluateExpr(expr->left, out);
+  evaluateExpr(expr->right, right);
 
   switch (expr->op->type) {
   case TokenType::XOR:
-    return new literal(performXor(left, right));
+    out = performXor(out, right);
+    break;
   case TokenType::XNOR:
-    return new literal(performXnor(left, right));
+    out = performXnor(out, right);
+    break;
   case TokenType::NAND:
-    return new literal(performNand(left, right));
+    out = performNand(out, right);
+    break;
   case TokenType::NOR:
-    return new literal(performNor(left, right));
+    out = performNor(out, right);
+    break;
   default:
     throw RuntimeError(expr->op, "Unknown binary operator.");
   }
+
+  return nullptr;
 }
 
 void *Evaluator::visitMultiExpr(MultiExpr *expr) {
-  std::vector<literal> operands;
-
-  for (const auto &operand : expr->operands) {
-    operands.push_back(evaluateExpr(operand));
+  literal &out = *result;
+  size_t base = operandStack.size();
+
+  // Operands are evaluated into a temporary first, since nested expressions
+  // may grow (and move) the operand stack
+  literal operand;
+  for (const auto &operandExpr : expr->operands) {
+    evaluateExpr(operandExpr, operand);
+    operandStack.push_back(std::move(operand));
   }
 
-  switch (expr->op->type) {
-  case TokenType::AND:
-    return new literal(performAnd(operands));
-  case TokenType::OR:
-    return new literal(performOr(operands));
-  default:
-    throw RuntimeError(expr->op, "Unknown multi-operand operator.");
+  const literal *operands = operandStack.data() + base;
+  size_t count = operandStack.size() - base;
+
+  try {
+    switch (expr->op->type) {
+    case TokenType::AND:
+      out = performAnd(operands, count);
+      break;
+    case TokenType::OR:
+      out = performOr(operands, count);
+      break;
+    default:
+      throw RuntimeError(expr->op, "Unknown multi-operand operator.");
+    }
+  } catch (...) {
+    operandStack.resize(base);
+    throw;
   }
+
+  operandStack.resize(base);
+  return nullptr;
 }
 
 void *Evaluator::visitGroupingExpr(GroupingExpr *expr) {
-  return new literal(evaluateExpr(expr->expression));
+  evaluateExpr(expr->expression, *result);
+  return nullptr;
 }
 
 void *Evaluator::visitCallExpr(CallExpr *expr) {
+  literal &out = *result;
+  size_t base = operandStack.size();
+
   // Evaluate all arguments
-  std::vector<literal> arguments;
+  literal argument;
   for (const auto &arg : expr->arguments) {
-    arguments.push_back(evaluateExpr(arg));
+    evaluateExpr(arg, argument);
+    operandStack.push_back(std::move(argument));
+  }
+
+  // Execute the circuit call. The arguments are copied into the circuit's
+  // frame before its body runs, so they can be released afterwards.
+  try {
+    executeCircuitCall(expr->callee, expr->circuitSlot,
+                       operandStack.data() + base,
+                       operandStack.size() - base, out);
+  } catch (...) {
+    operandStack.resize(base);
+    throw;
   }
 
-  // Execute the circuit call
-  return new literal(executeCircuitCall(expr->callee, arguments));
+  operandStack.resize(base);
+  return nullptr;
 }
 
 // StmtVisitor implementation
@@ -455,22 +371,25 @@ void *Evaluator::visitExpressionStmt(ExpressionStmt *stmt) {
 }
 
 void *Evaluator::visitCircuitDefStmt(CircuitDefStmt *stmt) {
-  environment->defineCircuit(
-      stmt->name->lexeme,
-      std::dynamic_pointer_cast<CircuitDefStmt>(std::shared_ptr<Stmt>(
-          stmt, [](Stmt *) {}))); // Create a non-owning shared_ptr
+  // Calls may now reach a different circuit, so nothing cached still holds
+  purity.clear();
+  for (auto &memo : memos) {
+    memo.second->clear();
+  }
+
+  environment.circuits[stmt->slot] = stmt;
   return nullptr;
 }
-
 void *Evaluator::visitBitDefStmt(BitDefStmt *stmt) {
-  literal value = evaluateExpr(stmt->initializer);
+  literal value;
+  evaluateExpr(stmt->initializer, value);
 
   // Ensure the value is a bit
-  if (!value.is_bitvector || value.bits.size() != 1) {
+  if (!value.is_bitvector || value.size() != 1) {
     throw RuntimeError(stmt->name, "Bit definition requires a bit value.");
   }
 
-  environment->define(stmt->name->lexeme, value);
+  environment.define(stmt->slot, value);
   return nullptr;
 }
 
@@ -479,49 +398,77 @@ void *Evaluator::visitBitVectorDefStmt(BitVectorDefStmt *stmt) {
   result.is_bitvector = true;
 
   // Evaluate each value in the bit vector
+  literal value;
   for (const auto &expr : stmt->values) {
-    literal value = evaluateExpr(expr);
+    evaluateExpr(expr, value);
 
     // If it's a bit, add its value
-    if (value.is_bitvector && value.bits.size() == 1) {
-      result.bits.push_back(value.bits[0]);
+    if (value.is_bitvector && value.size() == 1) {
+      result.pushBit(value.getBit(0));
     }
     // If it's a bit vector, append all its bits
-    else if (value.is_bitvector && value.bits.size() > 1) {
-      for (bool bit : value.bits) {
-        result.bits.push_back(bit);
-      }
+    else if (value.is_bitvector && value.size() > 1) {
+      result.append(value);
     } else {
       throw RuntimeError(stmt->name, "Invalid value in bit vector definition.");
     }
   }
 
-  environment->define(stmt->name->lexeme, result);
+  environment.define(stmt->slot, result);
   return nullptr;
 }
 
 void *Evaluator::visitPrintStmt(PrintStmt *stmt) {
-  literal value = evaluateExpr(stmt->expression);
+  literal value;
+  evaluateExpr(stmt->expression, value);
 
-  if (value.is_bitvector) {
-    if (value.bits.size() == 1) {
-      std::cout << (value.bits[0] ? "true" : "false") << std::endl;
-    } else {
-      std::cout << "0b";
-      for (bool bit : value.bits) {
-        std::cout << (bit ? "1" : "0");
-      }
-      std::cout << std::endl;
-    }
-  } else {
-    std::cout << (value.boolean ? "true" : "false") << std::endl;
+  std::cout << value << std::endl;
+
+  return nullptr;
+}
+
+void *Evaluator::visitTruthTableStmt(TruthTableStmt *stmt) {
+  writeTruthTable(environment, stmt->circuit,
+                  stmt->bitmap ? TableFormat::BITMAP : TableFormat::TEXT,
+                  std::cout);
+  return nullptr;
+}
+
+void *Evaluator::visitSimulateStmt(SimulateStmt *stmt) {
+  if (stmt->vectors.empty()) {
+    simulateCycles(environment, stmt->circuit, stmt->cycles, simulationMode,
+                   std::cout);
+    return nullptr;
   }
+  simulateVectors(environment, stmt->circuit, stmt->vectors,
+                  stmt->bitmap ? TableFormat::BITMAP : TableFormat::TEXT,
+                  stmt->jobs, simulationMode, std::cout);
+  return nullptr;
+}
 
+void *Evaluator::visitBddStmt(BddStmt *stmt) {
+  writeBddReport(environment, stmt->circuit, std::cout);
+  return nullptr;
+}
+
+void *Evaluator::visitEquivStmt(EquivStmt *stmt) {
+  writeEquivalenceReport(environment, stmt->first, stmt->second, std::cout);
+  return nullptr;
+}
+
+void *Evaluator::visitMinimizeStmt(MinimizeStmt *stmt) {
+  writeMinimizedCircuit(environment, stmt->circuit, std::cout);
+  return nullptr;
+}
+
+void *Evaluator::visitEmitCppStmt(EmitCppStmt *stmt) {
+  writeCppFunction(environment, stmt->circuit, std::cout);
   return nullptr;
 }
 
 void *Evaluator::visitReturnStmt(ReturnStmt *stmt) {
   // For now, just evaluate the expression
   // In a more complete implementation, we would need to handle this differently
-  return new literal(evaluateExpr(stmt->value));
+  evaluateExpr(stmt->value);
+  return nullptr;
 }
@@ -2,44 +2,99 @@
 
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "Bdd.h"
+#include "CppEmitter.h"
+#include "CycleSimulator.h"
 #include "Environment.h"
+#include "Equivalence.h"
 #include "Expr.h"
+#include "LiteralOps.h"
+#include "MemoCache.h"
+#include "Minimizer.h"
 #include "Stmt.h"
+#include "TruthTable.h"
+#include "VectorSimulator.h"
 
 class Evaluator : public ExprVisitor, public StmtVisitor {
 private:
-  std::shared_ptr<Environment> environment;
+  Environment environment;
 
-  // Helper methods for boolean operations
-  literal performNot(const literal &operand);
-  literal performAnd(const std::vector<literal> &operands);
-  literal performOr(const std::vector<literal> &operands);
-  literal performXor(const literal &left, const literal &right);
-  literal performXnor(const literal &left, const literal &right);
-  literal performNand(const literal &left, const literal &right);
-  literal performNor(const literal &left, const literal &right);
+  // Parameters of every active call, laid out one frame after another in a
+  // single reused vector, so a call does not allocate
+  struct Frame {
+    const CircuitDefStmt *circuit;
+    size_t base; // Index of the first parameter in frameValues
+  };
+  std::vector<Frame> frames;
+  std::vector<literal> frameValues;
 
-  // Helper for circuit calls
-  literal executeCircuitCall(const std::shared_ptr<Token> &name,
-                             const std::vector<literal> &arguments);
+  // Slot the expression being visited writes its value into. Visitors return
+  // nullptr; the value is handed back through this caller-provided slot.
+  literal *result = nullptr;
+
+  // Scratch space for multi-operand and call operands. It is reused across
+  // evaluations, so steady-state evaluation of bit-sized values does not
+  // allocate.
+  std::vector<literal> operandStack;
+
+  // Values of shared circuit body nodes for every active call, indexed by
+  // sharedBase + Expr::sharedSlot. Like the operand stack it is reused, so
+  // caching them does not allocate in steady state.
+  std::vector<literal> sharedValues;
+  std::vector<bool> sharedReady;
+  size_t sharedBase = 0;
+
+  // Result caches of memoized circuits. Only circuits whose result depends
+  // on nothing but their arguments are cached: every name their bodies
+  // read is a parameter or a circuit that is itself pure. Defining a
+  // circuit can change that, so it clears the caches and the verdicts.
+  MemoConfig memoConfig;
+  std::unordered_map<const CircuitDefStmt *, std::unique_ptr<MemoCache>>
+      memos;
+  std::unordered_map<const CircuitDefStmt *, bool> purity;
+  std::unordered_set<const CircuitDefStmt *> checking; // Cycle guard
+
+  SimulationMode simulationMode = SimulationMode::LEVELIZED;
+
+  MemoCache *memoFor(const CircuitDefStmt *circuit);
+  bool isPure(const CircuitDefStmt *circuit);
+  bool isPureExpr(Expr &expr, const CircuitDefStmt *circuit);
+
+  // Helpers for circuit calls and name lookup
+  void executeCircuitCall(const Token *name, uint32_t slot,
+                          const literal *arguments, size_t count,
+                          literal &out);
+  const literal &lookup(const VariableExpr *expr) const;
 
   // Type checking and error handling
   bool isBit(const literal &value) const;
   bool isBitVector(const literal &value) const;
-  void checkBitOperand(const std::shared_ptr<Token> &op,
-                       const literal &operand);
-  void checkBitVectorOperand(const std::shared_ptr<Token> &op,
-                             const literal &operand);
+  void checkBitOperand(const Token *op, const literal &operand);
+  void checkBitVectorOperand(const Token *op, const literal &operand);
 
 public:
   Evaluator();
 
-  // Main evaluation methods
-  void evaluate(const std::vector<std::shared_ptr<Stmt>> &statements);
-  literal evaluateExpr(std::shared_ptr<Expr> expr);
-  void executeStmt(std::shared_ptr<Stmt> stmt);
+  // Main evaluation methods. evaluate resolves the statements itself; the
+  // others expect them to have been passed to resolve.
+  void resolve(const std::vector<Stmt *> &statements);
+  bool evaluate(const std::vector<Stmt *> &statements); // False on error
+  literal evaluateExpr(Expr *expr);
+  void evaluateExpr(Expr *expr, literal &out);
+  void executeStmt(Stmt *stmt);
+
+  // Global values and circuits defined so far
+  const SymbolSource &symbols() const { return environment; }
+
+  // Circuit result caching
+  void setMemoConfig(const MemoConfig &config);
+  std::vector<MemoCache::Stats> memoStats() const;
+
+  void setSimulationMode(SimulationMode mode) { simulationMode = mode; }
 
   // ExprVisitor implementation
   void *visitLiteralExpr(LiteralExpr *expr) override;
@@ -57,4 +112,10 @@ public:
   void *visitBitVectorDefStmt(BitVectorDefStmt *stmt) override;
   void *visitPrintStmt(PrintStmt *stmt) override;
   void *visitReturnStmt(ReturnStmt *stmt) override;
+  void *visitTruthTableStmt(TruthTableStmt *stmt) override;
+  void *visitSimulateStmt(SimulateStmt *stmt) override;
+  void *visitBddStmt(BddStmt *stmt) override;
+  void *visitEquivStmt(EquivStmt *stmt) override;
+  void *visitMinimizeStmt(MinimizeStmt *stmt) override;
+  void *visitEmitCppStmt(EmitCppStmt *stmt) override;
 };
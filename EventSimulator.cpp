@@ -0,0 +1,184 @@
+#include "EventSimulator.h"
+
+#include <algorithm>
+
+namespace {
+
+// Value of a gate of the given type over `count` fanin values
+uint8_t reduce(GateType type, const uint8_t *inputs, size_t count) {
+  uint8_t value = 0;
+  switch (type) {
+  case GateType::INPUT:
+  case GateType::REGISTER:
+  case GateType::CONST0:
+    return 0;
+  case GateType::CONST1:
+    return 1;
+  case GateType::NOT:
+    return inputs[0] ^ 1;
+  case GateType::AND:
+  case GateType::NAND:
+    value = 1;
+    for (size_t i = 0; i < count; i++) {
+      value &= inputs[i];
+    }
+    return type == GateType::NAND ? value ^ 1 : value;
+  case GateType::OR:
+  case GateType::NOR:
+    for (size_t i = 0; i < count; i++) {
+      value |= inputs[i];
+    }
+    return type == GateType::NOR ? value ^ 1 : value;
+  case GateType::XOR:
+  case GateType::XNOR:
+    for (size_t i = 0; i < count; i++) {
+      value ^= inputs[i];
+    }
+    return type == GateType::XNOR ? value ^ 1 : value;
+  }
+  return value;
+}
+
+} // namespace
+
+EventSimulator::EventSimulator(const Netlist &netlist)
+    : netlist(netlist), values(netlist.nodeCount(), 0),
+      nodes(netlist.nodeCount()), scheduled(netlist.nodeCount(), 0),
+      latched(netlist.registers.size(), 0),
+      outputWords(netlist.outputs.size(), 0) {
+  uint32_t count = netlist.nodeCount();
+
+  // Fanins have smaller IDs, so levels are final by the time they are read
+  std::vector<uint32_t> fanoutCounts(count, 0);
+  uint32_t depth = 0;
+  for (uint32_t id = 0; id < count; id++) {
+    const uint32_t *fanin = netlist.faninBegin(id);
+    for (uint32_t i = 0; i < netlist.faninCount(id); i++) {
+      nodes[id].level = std::max(nodes[id].level, nodes[fanin[i]].level + 1);
+      fanoutCounts[fanin[i]]++;
+    }
+    depth = std::max(depth, nodes[id].level);
+  }
+
+  // Every gate has a slot on its level, so scheduling never allocates, and
+  // each level has a spare slot for update() to write into when it is full
+  std::vector<uint32_t> levelSizes(depth + 1, 1);
+  for (uint32_t id = 0; id < count; id++) {
+    levelSizes[nodes[id].level]++;
+  }
+  levelStart.resize(depth + 1);
+  levelEnd.resize(depth + 1);
+  uint32_t slots = 0;
+  for (uint32_t level = 0; level <= depth; level++) {
+    levelStart[level] = levelEnd[level] = slots;
+    slots += levelSizes[level];
+  }
+  wheel.resize(slots);
+
+  fanouts.resize(netlist.fanins.size());
+  for (uint32_t id = 0, start = 0; id < count; id++) {
+    Node &node = nodes[id];
+    node.fanout = node.fanoutEnd = start;
+    start += fanoutCounts[id];
+
+    const uint32_t *fanin = netlist.faninBegin(id);
+    uint32_t faninCount = netlist.faninCount(id);
+    for (uint32_t i = 0; i < faninCount; i++) {
+      fanouts[nodes[fanin[i]].fanoutEnd++] = id;
+    }
+
+    if (faninCount <= 2) {
+      // Tabulate the gate over (a, b); one fanin is read as both
+      node.a = faninCount > 0 ? fanin[0] : 0;
+      node.b = faninCount > 1 ? fanin[1] : node.a;
+      for (uint8_t row = 0; row < 4; row++) {
+        uint8_t inputs[2] = {uint8_t(row & 1), uint8_t(row >> 1)};
+        if (faninCount == 1 && inputs[0] != inputs[1]) {
+          continue;
+        }
+        node.table |= reduce(netlist.types[id], inputs, faninCount) << row;
+      }
+    } else {
+      node.wide = true;
+    }
+  }
+
+  for (size_t i = 0; i < netlist.registers.size(); i++) {
+    values[netlist.registers[i]] = netlist.registerInitial[i];
+  }
+  for (uint32_t id = 0; id < count; id++) {
+    if (netlist.types[id] != GateType::INPUT &&
+        netlist.types[id] != GateType::REGISTER) {
+      values[id] = evaluate(id);
+    }
+  }
+  updateOutputs();
+}
+
+uint8_t EventSimulator::evaluate(uint32_t id) {
+  const Node &node = nodes[id];
+  if (!node.wide) {
+    return (node.table >> (values[node.a] | values[node.b] << 1)) & 1;
+  }
+
+  const uint32_t *fanin = netlist.faninBegin(id);
+  uint32_t count = netlist.faninCount(id);
+  wideInputs.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    wideInputs[i] = values[fanin[i]];
+  }
+  return reduce(netlist.types[id], wideInputs.data(), count);
+}
+
+// Sets a node's value and schedules every gate it feeds if the value
+// changed. Gates already scheduled are written past their level's end,
+// which is not advanced.
+void EventSimulator::update(uint32_t id, uint8_t value) {
+  const Node &node = nodes[id];
+  uint32_t end = value != values[id] ? node.fanoutEnd : node.fanout;
+  values[id] = value;
+  for (uint32_t i = node.fanout; i < end; i++) {
+    uint32_t gate = fanouts[i];
+    uint32_t level = nodes[gate].level;
+    wheel[levelEnd[level]] = gate;
+    levelEnd[level] += scheduled[gate] ^ 1;
+    scheduled[gate] = 1;
+  }
+}
+
+void EventSimulator::updateOutputs() {
+  for (size_t o = 0; o < outputWords.size(); o++) {
+    outputWords[o] = values[netlist.outputs[o]];
+  }
+}
+
+void EventSimulator::setInput(size_t i, bool value) {
+  uint32_t id = netlist.inputs[i];
+  update(id, value);
+}
+
+void EventSimulator::run() {
+  // Gates only schedule higher levels, so each level is complete by the
+  // time it is reached
+  for (size_t level = 0; level < levelStart.size(); level++) {
+    for (uint32_t slot = levelStart[level]; slot < levelEnd[level]; slot++) {
+      uint32_t gate = wheel[slot];
+      scheduled[gate] = 0;
+      update(gate, evaluate(gate));
+    }
+    levelEnd[level] = levelStart[level];
+  }
+  updateOutputs();
+}
+
+void EventSimulator::clock() {
+  // Registers may feed each other directly, so every next value is read
+  // before any register changes
+  size_t count = netlist.registers.size();
+  for (size_t i = 0; i < count; i++) {
+    latched[i] = values[netlist.registerNext[i]];
+  }
+  for (size_t i = 0; i < count; i++) {
+    update(netlist.registers[i], latched[i]);
+  }
+}
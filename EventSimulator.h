@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Netlist.h"
+
+// How a circuit is simulated one pattern or clock cycle at a time
+enum class SimulationMode {
+  LEVELIZED,    // Evaluate every gate, in topological order
+  EVENT_DRIVEN, // Evaluate only the gates whose fanins changed
+};
+
+// Event-driven simulation of a netlist, one pattern at a time. Every gate is
+// evaluated once on construction; after that, a source that changes value
+// schedules its fanouts, and run() evaluates scheduled gates level by level,
+// scheduling the fanouts of those whose output changed. Propagation stops
+// wherever a gate keeps its value, so a step costs the size of the part of
+// the fanout cone that actually toggles rather than the whole netlist.
+//
+// The event wheel has one bucket per level (the longest path from a source),
+// and a gate's fanouts are always on higher levels, so each bucket is
+// complete by the time it is reached and every gate is evaluated at most
+// once per run().
+//
+// Outputs are 0 or 1 in a word, so they read like the first word of a
+// one-lane BatchSimulator's.
+class EventSimulator {
+private:
+  // Gates with up to two fanins are looked up in a truth table indexed by
+  // a | b << 1; wider ones are reduced from the netlist's fanins
+  struct Node {
+    uint32_t a = 0, b = 0;
+    uint32_t fanout = 0, fanoutEnd = 0; // Into fanouts
+    uint32_t level = 0;
+    uint8_t table = 0;
+    bool wide = false;
+  };
+
+  const Netlist &netlist;
+  std::vector<uint8_t> values;
+  std::vector<Node> nodes;
+  std::vector<uint32_t> fanouts;
+
+  // Scheduled gates, level by level: level l holds
+  // wheel[levelStart[l] .. levelEnd[l])
+  std::vector<uint32_t> wheel;
+  std::vector<uint32_t> levelStart;
+  std::vector<uint32_t> levelEnd;
+  std::vector<uint8_t> scheduled;
+
+  std::vector<uint8_t> latched; // Next register values during clock()
+  std::vector<uint8_t> wideInputs;
+  std::vector<uint64_t> outputWords;
+
+  uint8_t evaluate(uint32_t id);
+  void update(uint32_t id, uint8_t value);
+  void updateOutputs();
+
+public:
+  explicit EventSimulator(const Netlist &netlist);
+
+  // Sets the i-th primary input for the next run()
+  void setInput(size_t i, bool value);
+  const uint64_t *output(size_t i) const { return &outputWords[i]; }
+
+  // Propagates the inputs and registers changed since the last run()
+  void run();
+
+  // Loads every register with its next value, as computed by the last run()
+  void clock();
+};
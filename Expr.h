@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "Arena.h"
 #include "Token.h"
 
 // Forward declarations
@@ -34,8 +36,18 @@ public:
 // Base expression class
 class Expr {
 public:
-  virtual ~Expr() = default;
+  static constexpr uint32_t NOT_SHARED = UINT32_MAX;
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+  // Index into the per-call value cache of the enclosing circuit when this
+  // node is referenced more than once after hash-consing, else NOT_SHARED
+  uint32_t sharedSlot = NOT_SHARED;
+
   virtual void *accept(ExprVisitor *visitor) = 0;
+
+protected:
+  // Nodes live in an Arena and are never deleted through a base pointer
+  ~Expr() = default;
 };
 
 // Literal expression (true, false, etc.)
@@ -53,9 +65,16 @@ public:
 // Variable reference (identifier)
 class VariableExpr : public Expr {
 public:
-  std::shared_ptr<Token> name;
+  const Token *name;
 
-  VariableExpr(std::shared_ptr<Token> name) : name(name) {}
+  // Bindings filled in by the Resolver: the index of the enclosing
+  // circuit's parameter of this name (NO_SLOT outside circuits or when
+  // none matches), and the global value and circuit slots of the name
+  uint32_t parameter = NO_SLOT;
+  uint32_t valueSlot = NO_SLOT;
+  uint32_t circuitSlot = NO_SLOT;
+
+  VariableExpr(const Token *name) : name(name) {}
 
   void *accept(ExprVisitor *visitor) override {
     return visitor->visitVariableExpr(this);
@@ -65,11 +84,11 @@ public:
 // Call expression (circuit call)
 class CallExpr : public Expr {
 public:
-  std::shared_ptr<Token> callee;
-  std::vector<std::shared_ptr<Expr>> arguments;
+  const Token *callee;
+  ArenaList<Expr *> arguments;
+  uint32_t circuitSlot = NO_SLOT; // Filled in by the Resolver
 
-  CallExpr(std::shared_ptr<Token> callee,
-           std::vector<std::shared_ptr<Expr>> arguments)
+  CallExpr(const Token *callee, ArenaList<Expr *> arguments)
       : callee(callee), arguments(arguments) {}
 
   void *accept(ExprVisitor *visitor) override {
@@ -80,10 +99,10 @@ public:
 // Unary operations (not)
 class UnaryExpr : public Expr {
 public:
-  std::shared_ptr<Token> op;
-  std::shared_ptr<Expr> right;
+  const Token *op;
+  Expr *right;
 
-  UnaryExpr(std::shared_ptr<Token> op, std::shared_ptr<Expr> right)
+  UnaryExpr(const Token *op, Expr *right)
       : op(op), right(right) {}
 
   void *accept(ExprVisitor *visitor) override {
@@ -94,12 +113,11 @@ public:
 // Binary operations (xor, xnor, nand, nor)
 class BinaryExpr : public Expr {
 public:
-  std::shared_ptr<Token> op;
-  std::shared_ptr<Expr> left;
-  std::shared_ptr<Expr> right;
+  const Token *op;
+  Expr *left;
+  Expr *right;
 
-  BinaryExpr(std::shared_ptr<Token> op, std::shared_ptr<Expr> left,
-             std::shared_ptr<Expr> right)
+  BinaryExpr(const Token *op, Expr *left, Expr *right)
       : op(op), left(left), right(right) {}
 
   void *accept(ExprVisitor *visitor) override {
@@ -110,11 +128,10 @@ public:
 // Multi-operand operations (and, or)
 class MultiExpr : public Expr {
 public:
-  std::shared_ptr<Token> op;
-  std::vector<std::shared_ptr<Expr>> operands;
+  const Token *op;
+  ArenaList<Expr *> operands;
 
-  MultiExpr(std::shared_ptr<Token> op,
-            std::vector<std::shared_ptr<Expr>> operands)
+  MultiExpr(const Token *op, ArenaList<Expr *> operands)
       : op(op), operands(operands) {}
 
   void *accept(ExprVisitor *visitor) override {
@@ -125,11 +142,31 @@ public:
 // Grouping expression (parenthesized expressions)
 class GroupingExpr : public Expr {
 public:
-  std::shared_ptr<Expr> expression;
+  Expr *expression;
 
-  GroupingExpr(std::shared_ptr<Expr> expression) : expression(expression) {}
+  GroupingExpr(Expr *expression) : expression(expression) {}
 
   void *accept(ExprVisitor *visitor) override {
     return visitor->visitGroupingExpr(this);
   }
 };
+
+// Calls f on each operand of an expression, in order
+template <typename F> void forEachOperand(Expr &expr, F f) {
+  if (auto *unary = dynamic_cast<UnaryExpr *>(&expr)) {
+    f(*unary->right);
+  } else if (auto *binary = dynamic_cast<BinaryExpr *>(&expr)) {
+    f(*binary->left);
+    f(*binary->right);
+  } else if (auto *multi = dynamic_cast<MultiExpr *>(&expr)) {
+    for (auto &operand : multi->operands) {
+      f(*operand);
+    }
+  } else if (auto *grouping = dynamic_cast<GroupingExpr *>(&expr)) {
+    f(*grouping->expression);
+  } else if (auto *call = dynamic_cast<CallExpr *>(&expr)) {
+    for (auto &argument : call->arguments) {
+      f(*argument);
+    }
+  }
+}
@@ -0,0 +1,172 @@
+#include "HashConser.h"
+
+#include <algorithm>
+
+namespace {
+
+void appendId(std::string &key, uint32_t id) {
+  key.append(reinterpret_cast<const char *>(&id), sizeof(id));
+}
+
+} // namespace
+
+std::vector<HashConser::Stats>
+HashConser::run(const std::vector<Stmt *> &statements) {
+  std::vector<Stats> results;
+  for (const auto &stmt : statements) {
+    if (auto circuit = dynamic_cast<CircuitDefStmt *>(stmt)) {
+      results.push_back(conserCircuit(*circuit));
+    }
+  }
+  return results;
+}
+
+HashConser::Stats HashConser::conserCircuit(CircuitDefStmt &circuit) {
+  table.clear();
+  nodes.clear();
+  stats = Stats();
+  stats.circuit = circuit.name->lexeme;
+
+  std::vector<uint32_t> roots;
+  for (auto &expr : circuit.body) {
+    roots.push_back(intern(expr));
+  }
+  for (auto &reg : circuit.registers) {
+    roots.push_back(intern(reg.initial));
+    roots.push_back(intern(reg.next));
+  }
+
+  // Operator and call nodes reachable along more than one edge are cached
+  std::vector<uint32_t> references(nodes.size(), 0);
+  for (uint32_t root : roots) {
+    countReferences(root, references);
+  }
+
+  circuit.sharedCount = 0;
+  for (size_t id = 0; id < nodes.size(); id++) {
+    Expr &expr = *nodes[id].expr;
+    if (!nodes[id].leaf && references[id] > 1) {
+      expr.sharedSlot = circuit.sharedCount++;
+    } else {
+      expr.sharedSlot = Expr::NOT_SHARED;
+    }
+  }
+
+  table.clear();
+  nodes.clear();
+  return stats;
+}
+
+// Helpers
+
+uint32_t HashConser::intern(Expr *&expr) {
+  Expr **previous = slot;
+  slot = &expr;
+  expr->accept(this);
+  slot = previous;
+  return result;
+}
+
+uint32_t HashConser::internNode(std::string &key,
+                                std::vector<uint32_t> operands, bool leaf) {
+  stats.nodes++;
+
+  auto found = table.find(key);
+  if (found != table.end()) {
+    *slot = nodes[found->second].expr;
+    stats.merged++;
+    return found->second;
+  }
+
+  uint32_t id = nodes.size();
+  nodes.push_back(Node{*slot, std::move(operands), leaf});
+  table.emplace(std::move(key), id);
+  return id;
+}
+
+uint32_t HashConser::internOperator(char kind, TokenType op,
+                                    std::vector<uint32_t> operands,
+                                    bool commutative) {
+  std::vector<uint32_t> keyed = operands;
+  if (commutative) {
+    std::sort(keyed.begin(), keyed.end());
+  }
+
+  std::string key(1, kind);
+  key += static_cast<char>(op);
+  for (uint32_t id : keyed) {
+    appendId(key, id);
+  }
+  return internNode(key, std::move(operands), false);
+}
+
+void HashConser::countReferences(uint32_t id,
+                                 std::vector<uint32_t> &references) const {
+  if (references[id]++ > 0) {
+    return;
+  }
+  for (uint32_t operand : nodes[id].operands) {
+    countReferences(operand, references);
+  }
+}
+
+// ExprVisitor implementation
+void *HashConser::visitLiteralExpr(LiteralExpr *expr) {
+  std::string key = "L";
+  key += expr->value.is_bitvector ? '1' : '0';
+  appendId(key, expr->value.width);
+  key.append(reinterpret_cast<const char *>(expr->value.words.data()),
+             expr->value.wordCount() * sizeof(uint64_t));
+  result = internNode(key, {}, true);
+  return nullptr;
+}
+
+void *HashConser::visitVariableExpr(VariableExpr *expr) {
+  std::string key = "V" + expr->name->lexeme;
+  result = internNode(key, {}, true);
+  return nullptr;
+}
+
+void *HashConser::visitUnaryExpr(UnaryExpr *expr) {
+  uint32_t operand = intern(expr->right);
+  result = internOperator('U', expr->op->type, {operand}, false);
+  return nullptr;
+}
+
+void *HashConser::visitBinaryExpr(BinaryExpr *expr) {
+  // xor, xnor, nand and nor are all commutative
+  uint32_t left = intern(expr->left);
+  uint32_t right = intern(expr->right);
+  result = internOperator('B', expr->op->type, {left, right}, true);
+  return nullptr;
+}
+
+void *HashConser::visitMultiExpr(MultiExpr *expr) {
+  std::vector<uint32_t> operands;
+  for (auto &operand : expr->operands) {
+    operands.push_back(intern(operand));
+  }
+  result = internOperator('M', expr->op->type, std::move(operands), true);
+  return nullptr;
+}
+
+void *HashConser::visitGroupingExpr(GroupingExpr *expr) {
+  // Parentheses only group, so the node is replaced by its contents
+  Expr **grouping = slot;
+  result = intern(expr->expression);
+  *grouping = expr->expression;
+  return nullptr;
+}
+
+void *HashConser::visitCallExpr(CallExpr *expr) {
+  std::string key = "C" + expr->callee->lexeme;
+  key += '\0';
+  std::vector<uint32_t> arguments;
+  for (auto &argument : expr->arguments) {
+    uint32_t id = intern(argument);
+    appendId(key, id);
+    arguments.push_back(id);
+  }
+  result = internNode(key, std::move(arguments), false);
+  return nullptr;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Expr.h"
+#include "Stmt.h"
+
+// Merges structurally identical subexpressions of each circuit body into a
+// single shared node (hash-consing). A node is keyed on its operator and the
+// IDs of its already merged operands, sorted for the commutative operators,
+// so (xor a b) and (xor b a) become one node. Grouping parentheses are
+// dropped along the way.
+//
+// Afterwards every operator or call node referenced more than once gets a
+// sharedSlot, which the engines use to compute it only once per call.
+class HashConser : public ExprVisitor {
+public:
+  struct Stats {
+    std::string circuit;
+    size_t nodes = 0;  // Expression nodes before merging
+    size_t merged = 0; // Nodes replaced by an identical earlier node
+  };
+
+private:
+  struct Node {
+    Expr *expr; // Canonical node
+    std::vector<uint32_t> operands;
+    bool leaf;
+  };
+
+  std::unordered_map<std::string, uint32_t> table; // Key -> node ID
+  std::vector<Node> nodes;
+  Stats stats;
+
+  // Slot holding the expression being visited, which is replaced by the
+  // canonical node
+  Expr **slot = nullptr;
+
+  // Node ID of the expression just visited
+  uint32_t result = 0;
+
+  uint32_t intern(Expr *&expr);
+  uint32_t internNode(std::string &key, std::vector<uint32_t> operands,
+                      bool leaf);
+  uint32_t internOperator(char kind, TokenType op,
+                          std::vector<uint32_t> operands, bool commutative);
+  void countReferences(uint32_t id, std::vector<uint32_t> &references) const;
+
+public:
+  Stats conserCircuit(CircuitDefStmt &circuit);
+  std::vector<Stats> run(const std::vector<Stmt *> &statements);
+
+  // ExprVisitor implementation
+  void *visitLiteralExpr(LiteralExpr *expr) override;
+  void *visitVariableExpr(VariableExpr *expr) override;
+  void *visitUnaryExpr(UnaryExpr *expr) override;
+  void *visitBinaryExpr(BinaryExpr *expr) override;
+  void *visitMultiExpr(MultiExpr *expr) override;
+  void *visitGroupingExpr(GroupingExpr *expr) override;
+  void *visitCallExpr(CallExpr *expr) override;
+};
@@ -0,0 +1,128 @@
+#include "LiteralOps.h"
+
+#include <stdexcept>
+
+#include "BitKernels.h"
+
+literal performNot(const literal &operand) {
+  if (!operand.is_bitvector) {
+    return literal::fromBit(!operand.asBool());
+  }
+
+  literal value = operand;
+  bitkernels::apply(BitOp::NOT, value.words.data(), operand.words.data(),
+                    operand.words.data(), operand.wordCount());
+  value.maskTail();
+  return value;
+}
+
+literal performReduce(BitOp op, const char *name, const literal *operands,
+                      size_t count) {
+  // Check if all operands are bit vectors of the same size or bits
+  bool allBits = true;
+  bool allBitVectors = true;
+  size_t vectorSize = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const literal &operand = operands[i];
+    if (operand.is_bitvector && operand.size() > 1) {
+      allBits = false;
+      if (vectorSize == 0) {
+        vectorSize = operand.size();
+      } else if (vectorSize != operand.size()) {
+        throw std::runtime_error(std::string("Cannot perform ") + name +
+                                 " on bit vectors of different sizes");
+      }
+    } else {
+      allBitVectors = false;
+    }
+  }
+
+  // AND starts from all ones, OR from all zeros
+  bool identity = op == BitOp::AND;
+
+  if (allBitVectors && !allBits && vectorSize > 0) {
+    // Perform bit-vector operation one word at a time
+    literal value = literal::filled(vectorSize, identity);
+    for (size_t i = 0; i < count; i++) {
+      bitkernels::apply(op, value.words.data(), value.words.data(),
+                        operands[i].words.data(), value.wordCount());
+    }
+    return value;
+  }
+
+  // Perform single-bit operation
+  bool value = identity;
+  for (size_t i = 0; i < count; i++) {
+    value = op == BitOp::AND ? value && operands[i].asBool()
+                             : value || operands[i].asBool();
+  }
+  return literal::fromBit(value);
+}
+
+literal performBitwise(BitOp op, const char *name, const literal &left,
+                       const literal &right) {
+  // Check if both operands are bit vectors of the same size
+  if (left.is_bitvector && right.is_bitvector && left.size() > 1 &&
+      right.size() > 1) {
+
+    if (left.size() != right.size()) {
+      throw std::runtime_error(std::string("Cannot perform ") + name +
+                               " on bit vectors of different sizes");
+    }
+
+    // Perform bit-vector operation one word at a time
+    literal value = literal::filled(left.size(), false);
+    bitkernels::apply(op, value.words.data(), left.words.data(),
+                      right.words.data(), value.wordCount());
+    value.maskTail();
+    return value;
+  }
+
+  // Perform single-bit operation
+  uint64_t value = 0;
+  uint64_t leftWord = left.asBool();
+  uint64_t rightWord = right.asBool();
+  bitkernels::apply(op, &value, &leftWord, &rightWord, 1);
+  return literal::fromBit(value & 1);
+}
+
+literal performAnd(const literal *operands, size_t count) {
+  return performReduce(BitOp::AND, "AND", operands, count);
+}
+
+literal performOr(const literal *operands, size_t count) {
+  return performReduce(BitOp::OR, "OR", operands, count);
+}
+
+literal performXor(const literal &left, const literal &right) {
+  return performBitwise(BitOp::XOR, "XOR", left, right);
+}
+
+literal performXnor(const literal &left, const literal &right) {
+  return performBitwise(BitOp::XNOR, "XNOR", left, right);
+}
+
+literal performNand(const literal &left, const literal &right) {
+  return performBitwise(BitOp::NAND, "NAND", left, right);
+}
+
+literal performNor(const literal &left, const literal &right) {
+  return performBitwise(BitOp::NOR, "NOR", left, right);
+}
+
+std::ostream &operator<<(std::ostream &os, const literal &value) {
+  if (!value.is_bitvector) {
+    return os << (value.asBool() ? "true" : "false");
+  }
+
+  if (value.size() == 1) {
+    return os << (value.getBit(0) ? "true" : "false");
+  }
+
+  os << "0b";
+  for (size_t i = 0; i < value.size(); i++) {
+    os << (value.getBit(i) ? "1" : "0");
+  }
+  return os;
+}
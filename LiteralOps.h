@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+#include "BitKernels.h"
+#include "Token.h"
+
+// Gate semantics on literal values, shared by every execution engine.
+// Bit vectors of equal size are combined bit by bit; anything else is
+// treated as a single bit.
+literal performNot(const literal &operand);
+literal performAnd(const literal *operands, size_t count);
+literal performOr(const literal *operands, size_t count);
+literal performXor(const literal &left, const literal &right);
+literal performXnor(const literal &left, const literal &right);
+literal performNand(const literal &left, const literal &right);
+literal performNor(const literal &left, const literal &right);
+
+literal performReduce(BitOp op, const char *name, const literal *operands,
+                      size_t count);
+literal performBitwise(BitOp op, const char *name, const literal &left,
+                       const literal &right);
+
+// Formats a value the way the print statement shows it
+std::ostream &operator<<(std::ostream &os, const literal &value);
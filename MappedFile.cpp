@@ -0,0 +1,44 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+  if (mapped) {
+    munmap(const_cast<char *>(data), size);
+  }
+}
+
+bool MappedFile::open(const std::string &fileName) {
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      // The scanner reads the file front to back exactly once
+      madvise(address, info.st_size, MADV_SEQUENTIAL);
+      data = static_cast<const char *>(address);
+      size = info.st_size;
+      mapped = true;
+      close(fd);
+      return true;
+    }
+  }
+
+  char chunk[65536];
+  ssize_t count;
+  while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+    buffer.append(chunk, count);
+  }
+  close(fd);
+
+  data = buffer.data();
+  size = buffer.size();
+  return count == 0;
+}
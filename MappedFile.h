@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file. Regular files are memory-mapped, so
+// loading one costs a single mapping rather than copies of its contents;
+// anything that cannot be mapped (pipes, empty files) is read into memory.
+class MappedFile {
+private:
+  const char *data = nullptr;
+  size_t size = 0;
+  bool mapped = false;
+  std::string buffer; // Contents when the file could not be mapped
+
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Returns false if the file cannot be opened
+  bool open(const std::string &fileName);
+
+  std::string_view view() const { return std::string_view(data, size); }
+};
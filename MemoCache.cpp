@@ -0,0 +1,121 @@
+#include "MemoCache.h"
+
+#include <algorithm>
+
+namespace {
+
+uint64_t mix(uint64_t hash, uint64_t word) {
+  hash ^= word + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+  hash ^= hash >> 31;
+  hash *= 0xBF58476D1CE4E5B9ULL;
+  return hash ^ (hash >> 29);
+}
+
+} // namespace
+
+MemoCache::MemoCache(const std::string &circuit, size_t capacity)
+    : capacity(std::max<size_t>(capacity, 1)) {
+  stats.circuit = circuit;
+
+  // At most half full, so probe sequences stay short
+  size_t slots = 1;
+  while (slots < this->capacity * 2) {
+    slots *= 2;
+  }
+  table.assign(slots, EMPTY);
+  mask = slots - 1;
+  entries.reserve(this->capacity);
+}
+
+bool MemoCache::lookup(const literal *arguments, size_t count, literal &out) {
+  pending.clear();
+  uint64_t hash = count;
+  for (size_t i = 0; i < count; i++) {
+    const literal &argument = arguments[i];
+    uint64_t header = (static_cast<uint64_t>(argument.width) << 1) |
+                      argument.is_bitvector;
+    pending.push_back(header);
+    hash = mix(hash, header);
+    for (size_t w = 0; w < argument.wordCount(); w++) {
+      pending.push_back(argument.words[w]);
+      hash = mix(hash, argument.words[w]);
+    }
+  }
+  pendingHash = hash;
+
+  for (size_t slot = hash & mask; table[slot] != EMPTY;
+       slot = (slot + 1) & mask) {
+    Entry &entry = entries[table[slot]];
+    if (entry.hash == hash && entry.key == pending) {
+      entry.referenced = true;
+      out = entry.value;
+      stats.hits++;
+      return true;
+    }
+  }
+
+  stats.misses++;
+  return false;
+}
+
+void MemoCache::insert(const literal &value) {
+  uint32_t index;
+  if (entries.size() < capacity) {
+    index = entries.size();
+    entries.emplace_back();
+  } else {
+    index = evict();
+  }
+
+  Entry &entry = entries[index];
+  entry.hash = pendingHash;
+  entry.key.assign(pending.begin(), pending.end());
+  entry.value = value;
+  entry.referenced = false;
+
+  size_t slot = pendingHash & mask;
+  while (table[slot] != EMPTY) {
+    slot = (slot + 1) & mask;
+  }
+  table[slot] = index;
+}
+
+void MemoCache::clear() {
+  entries.clear();
+  std::fill(table.begin(), table.end(), EMPTY);
+  hand = 0;
+}
+
+// Advances the CLOCK hand to an entry that was not hit since the hand last
+// passed it, clearing the marks of the ones that were, and frees it
+uint32_t MemoCache::evict() {
+  while (entries[hand].referenced) {
+    entries[hand].referenced = false;
+    hand = (hand + 1) % entries.size();
+  }
+
+  uint32_t index = hand;
+  hand = (hand + 1) % entries.size();
+  unlink(index);
+  stats.evictions++;
+  return index;
+}
+
+// Removes an entry from the table, shifting later entries of its probe
+// sequence back so lookups never stop at the hole
+void MemoCache::unlink(uint32_t index) {
+  size_t hole = entries[index].hash & mask;
+  while (table[hole] != index) {
+    hole = (hole + 1) & mask;
+  }
+
+  for (size_t next = (hole + 1) & mask; table[next] != EMPTY;
+       next = (next + 1) & mask) {
+    size_t home = entries[table[next]].hash & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      table[hole] = table[next];
+      hole = next;
+    }
+  }
+  table[hole] = EMPTY;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Token.h"
+
+// Which circuits memoize their results and how many each keeps
+struct MemoConfig {
+  static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+  bool all = false;                      // Every circuit
+  std::unordered_set<std::string> names; // Or just these
+  size_t capacity = DEFAULT_CAPACITY;
+
+  bool enabled() const { return all || !names.empty(); }
+  bool enabledFor(const std::string &name) const {
+    return all || names.count(name) > 0;
+  }
+};
+
+// Bounded cache of one circuit's results, keyed by its argument values.
+//
+// The arguments are packed into a word key (a header word with the width
+// and kind of each literal, then its bits) and looked up by a hash of that
+// key in an open-addressing table. When the cache is full the CLOCK policy
+// evicts an entry that has not been hit since the hand last passed it.
+//
+// Entries and their key buffers are reused after eviction, so a warm cache
+// does not allocate.
+class MemoCache {
+public:
+  struct Stats {
+    std::string circuit;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+private:
+  static constexpr uint32_t EMPTY = UINT32_MAX;
+
+  struct Entry {
+    uint64_t hash = 0;
+    std::vector<uint64_t> key;
+    literal value;
+    bool referenced = false;
+  };
+
+  size_t capacity;
+  std::vector<Entry> entries;
+  std::vector<uint32_t> table; // Entry index per slot, or EMPTY
+  size_t mask;
+  size_t hand = 0; // CLOCK hand
+
+  // Key and hash of the last lookup, stored by insert after a miss
+  std::vector<uint64_t> pending;
+  uint64_t pendingHash = 0;
+
+  Stats stats;
+
+  uint32_t evict();
+  void unlink(uint32_t index);
+
+public:
+  MemoCache(const std::string &circuit, size_t capacity);
+
+  // Looks up the arguments, copying the cached result into `out` on a hit
+  bool lookup(const literal *arguments, size_t count, literal &out);
+
+  // Caches the result for the arguments of the last lookup, which missed
+  void insert(const literal &value);
+
+  // Drops every entry but keeps the statistics
+  void clear();
+
+  const Stats &getStats() const { return stats; }
+};
@@ -0,0 +1,419 @@
+#include "Minimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+#include "BatchSimulator.h"
+#include "Elaborator.h"
+
+namespace minimizer {
+namespace {
+
+bool disjoint(Cube a, Cube b) {
+  return (a.mask & b.mask & (a.value ^ b.value)) != 0;
+}
+
+bool contains(Cube outer, Cube inner) {
+  return (inner.mask & outer.mask) == outer.mask &&
+         (inner.value & outer.mask) == outer.value;
+}
+
+int literalCount(Cube cube) { return __builtin_popcount(cube.mask); }
+
+size_t literalCount(const Cover &cover) {
+  size_t count = 0;
+  for (Cube cube : cover) {
+    count += literalCount(cube);
+  }
+  return count;
+}
+
+uint64_t key(Cube cube) { return uint64_t(cube.mask) << 32 | cube.value; }
+
+Cube withLiteral(Cube cube, int input, bool value) {
+  cube.mask |= 1u << input;
+  cube.value |= uint32_t(value) << input;
+  return cube;
+}
+
+// The cubes of a cover that meet `cube`, with the inputs of `cube` freed,
+// leaving out the cube at `skip`
+Cover cofactor(const Cover &cover, Cube cube, size_t skip = SIZE_MAX) {
+  Cover result;
+  for (size_t i = 0; i < cover.size(); i++) {
+    Cube other = cover[i];
+    if (i != skip && !disjoint(cube, other)) {
+      result.push_back({other.mask & ~cube.mask, other.value & ~cube.mask});
+    }
+  }
+  return result;
+}
+
+// The input to split a cover on: of the inputs that appear in both
+// polarities, the one in the most cubes, and when `binateOnly` is false and
+// there is none, of all inputs. Returns -1 if there is no candidate.
+int splitInput(const Cover &cover, bool binateOnly) {
+  int counts[32] = {};
+  uint32_t positive = 0;
+  uint32_t negative = 0;
+  for (Cube cube : cover) {
+    positive |= cube.mask & cube.value;
+    negative |= cube.mask & ~cube.value;
+    for (uint32_t bits = cube.mask; bits != 0; bits &= bits - 1) {
+      counts[__builtin_ctz(bits)]++;
+    }
+  }
+
+  uint32_t candidates = positive & negative;
+  if (candidates == 0 && !binateOnly) {
+    candidates = positive | negative;
+  }
+  int best = -1;
+  for (uint32_t bits = candidates; bits != 0; bits &= bits - 1) {
+    int input = __builtin_ctz(bits);
+    if (best < 0 || counts[input] > counts[best]) {
+      best = input;
+    }
+  }
+  return best;
+}
+
+Cube supercube(const Cover &cover) {
+  Cube result = cover[0];
+  for (Cube cube : cover) {
+    result.mask &= cube.mask & ~(cube.value ^ result.value);
+    result.value &= result.mask;
+  }
+  return result;
+}
+
+// Raises literals of a cube that lies clear of the off-set until it is
+// prime. Every off-set cube must stay blocked by a literal of the cube that
+// contradicts it; literals that are the only block of some off-set cube
+// are kept, then the literal blocking the most remaining ones, until all
+// are blocked. The rest are dropped.
+Cube expandCube(Cube cube, const Cover &off, std::vector<uint32_t> &blocks) {
+  blocks.clear();
+  uint32_t keep = 0;
+  for (Cube other : off) {
+    uint32_t block = cube.mask & other.mask & (cube.value ^ other.value);
+    if ((block & (block - 1)) == 0) {
+      keep |= block;
+    } else {
+      blocks.push_back(block);
+    }
+  }
+
+  for (;;) {
+    size_t remaining = 0;
+    int counts[32] = {};
+    for (uint32_t block : blocks) {
+      if ((block & keep) == 0) {
+        blocks[remaining++] = block;
+        for (uint32_t bits = block; bits != 0; bits &= bits - 1) {
+          counts[__builtin_ctz(bits)]++;
+        }
+      }
+    }
+    blocks.resize(remaining);
+    if (remaining == 0) {
+      break;
+    }
+    int best = std::max_element(counts, counts + 32) - counts;
+    keep |= 1u << best;
+  }
+  return {keep, cube.value & keep};
+}
+
+Cover expand(Cover cover, const Cover &off) {
+  // Cubes with the fewest literals first, as they are the likeliest to
+  // grow over the others
+  std::stable_sort(cover.begin(), cover.end(), [](Cube a, Cube b) {
+    return literalCount(a) < literalCount(b);
+  });
+
+  Cover result;
+  std::vector<bool> covered(cover.size(), false);
+  std::vector<uint32_t> blocks;
+  for (size_t i = 0; i < cover.size(); i++) {
+    if (covered[i]) {
+      continue;
+    }
+    Cube prime = expandCube(cover[i], off, blocks);
+    for (size_t j = i + 1; j < cover.size(); j++) {
+      if (!covered[j] && contains(prime, cover[j])) {
+        covered[j] = true;
+      }
+    }
+    result.push_back(prime);
+  }
+  return result;
+}
+
+Cover irredundant(Cover cover) {
+  // The cubes with the most literals cover the least, so go first
+  std::stable_sort(cover.begin(), cover.end(), [](Cube a, Cube b) {
+    return literalCount(a) > literalCount(b);
+  });
+  for (size_t i = 0; i < cover.size();) {
+    if (isTautology(cofactor(cover, cover[i], i))) {
+      cover.erase(cover.begin() + i);
+    } else {
+      i++;
+    }
+  }
+  return cover;
+}
+
+Cover reduce(Cover cover) {
+  for (size_t i = 0; i < cover.size();) {
+    Cover uncovered = complement(cofactor(cover, cover[i], i));
+    if (uncovered.empty()) {
+      cover.erase(cover.begin() + i);
+      continue;
+    }
+    Cube shrunk = supercube(uncovered);
+    cover[i].mask |= shrunk.mask;
+    cover[i].value |= shrunk.value;
+    i++;
+  }
+  return cover;
+}
+
+bool cheaper(const Cover &a, const Cover &b) {
+  if (a.size() != b.size()) {
+    return a.size() < b.size();
+  }
+  return literalCount(a) < literalCount(b);
+}
+
+} // namespace
+
+Cover complement(const Cover &cover) {
+  if (cover.empty()) {
+    return {Cube()};
+  }
+  for (Cube cube : cover) {
+    if (cube.mask == 0) {
+      return {};
+    }
+  }
+
+  if (cover.size() == 1) {
+    // De Morgan, as disjoint cubes: not a, a and not b, ...
+    Cover result;
+    Cube prefix;
+    for (uint32_t bits = cover[0].mask; bits != 0; bits &= bits - 1) {
+      int input = __builtin_ctz(bits);
+      bool value = (cover[0].value >> input) & 1;
+      result.push_back(withLiteral(prefix, input, !value));
+      prefix = withLiteral(prefix, input, value);
+    }
+    return result;
+  }
+
+  int input = splitInput(cover, false);
+  Cover high = complement(cofactor(cover, withLiteral(Cube(), input, true)));
+  Cover low = complement(cofactor(cover, withLiteral(Cube(), input, false)));
+
+  // A cube in both halves does not depend on the input
+  std::unordered_set<uint64_t> lowCubes;
+  for (Cube cube : low) {
+    lowCubes.insert(key(cube));
+  }
+  std::unordered_set<uint64_t> merged;
+  Cover result;
+  for (Cube cube : high) {
+    if (lowCubes.count(key(cube))) {
+      merged.insert(key(cube));
+      result.push_back(cube);
+    } else {
+      result.push_back(withLiteral(cube, input, true));
+    }
+  }
+  for (Cube cube : low) {
+    if (!merged.count(key(cube))) {
+      result.push_back(withLiteral(cube, input, false));
+    }
+  }
+  return result;
+}
+
+bool isTautology(const Cover &cover) {
+  if (cover.empty()) {
+    return false;
+  }
+  for (Cube cube : cover) {
+    if (cube.mask == 0) {
+      return true;
+    }
+  }
+  // A cover unate in every input includes everything only through a cube
+  // without literals
+  int input = splitInput(cover, true);
+  if (input < 0) {
+    return false;
+  }
+  return isTautology(cofactor(cover, withLiteral(Cube(), input, true))) &&
+         isTautology(cofactor(cover, withLiteral(Cube(), input, false)));
+}
+
+Cover minimize(const Cover &cover) {
+  Cover off = complement(cover);
+  Cover best = irredundant(expand(cover, off));
+  for (;;) {
+    // A cover that reduce leaves as it is would only expand back into itself
+    Cover reduced = reduce(best);
+    if (reduced == best) {
+      return best;
+    }
+    Cover next = irredundant(expand(std::move(reduced), off));
+    if (!cheaper(next, best)) {
+      return best;
+    }
+    best = std::move(next);
+  }
+}
+
+} // namespace minimizer
+
+namespace {
+
+using minimizer::Cover;
+using minimizer::Cube;
+
+// The on-set is read off the truth table, so minimization is exponential in
+// the inputs either way
+constexpr unsigned MAX_INPUTS = 16;
+
+// Bit k of word i is bit i of k, for the inputs that vary within a word
+constexpr uint64_t INPUT_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+// One minterm cube per input combination that sets each output, where bit
+// i of a combination is input i
+std::vector<Cover> onSets(const Netlist &netlist) {
+  size_t inputCount = netlist.inputs.size();
+  uint32_t full = (1u << inputCount) - 1;
+  uint64_t rows = 1ULL << inputCount;
+
+  BatchSimulator sim(netlist, 8);
+  size_t lanes = sim.laneCount();
+  std::vector<Cover> covers(netlist.outputs.size());
+  for (uint64_t base = 0; base < rows; base += sim.patternsPerRun()) {
+    for (size_t i = 0; i < inputCount; i++) {
+      for (size_t lane = 0; lane < lanes; lane++) {
+        uint64_t first = base + lane * 64;
+        sim.input(i)[lane] =
+            i < 6 ? INPUT_PATTERNS[i] : ((first >> i) & 1 ? ~0ULL : 0);
+      }
+    }
+    sim.run();
+
+    for (size_t o = 0; o < covers.size(); o++) {
+      for (size_t lane = 0; lane < lanes; lane++) {
+        uint64_t first = base + lane * 64;
+        if (first >= rows) {
+          break;
+        }
+        uint64_t word = sim.output(o)[lane];
+        if (rows - first < 64) {
+          word &= (1ULL << (rows - first)) - 1;
+        }
+        for (; word != 0; word &= word - 1) {
+          uint32_t row = first + __builtin_ctzll(word);
+          covers[o].push_back({full, row});
+        }
+      }
+    }
+  }
+  return covers;
+}
+
+// Source text of a cover. An identifier followed by a parenthesis would
+// read as a call, so parenthesized operands come first, and a lone
+// identifier or constant is wrapped because a bare one in a body is not an
+// output.
+std::string sumOfProducts(const Cover &cover,
+                          const std::vector<std::string> &names) {
+  if (cover.empty()) {
+    return "(and false)";
+  }
+
+  std::vector<std::string> products;
+  std::vector<std::string> identifiers; // Single positive literals
+  for (Cube cube : cover) {
+    if (cube.mask == 0) {
+      return "(and true)";
+    }
+    std::vector<std::string> negated;
+    std::vector<std::string> plain;
+    for (uint32_t bits = cube.mask; bits != 0; bits &= bits - 1) {
+      int input = __builtin_ctz(bits);
+      if ((cube.value >> input) & 1) {
+        plain.push_back(names[input]);
+      } else {
+        negated.push_back("(not " + names[input] + ")");
+      }
+    }
+
+    if (negated.size() + plain.size() == 1) {
+      if (plain.empty()) {
+        products.push_back(negated[0]);
+      } else {
+        identifiers.push_back(plain[0]);
+      }
+      continue;
+    }
+    std::string product = "(and";
+    for (const std::string &literal : negated) {
+      product += " " + literal;
+    }
+    for (const std::string &literal : plain) {
+      product += " " + literal;
+    }
+    products.push_back(product + ")");
+  }
+
+  products.insert(products.end(), identifiers.begin(), identifiers.end());
+  if (products.size() == 1) {
+    return identifiers.empty() ? products[0] : "(and " + products[0] + ")";
+  }
+  std::string sum = "(or";
+  for (const std::string &product : products) {
+    sum += " " + product;
+  }
+  return sum + ")";
+}
+
+} // namespace
+
+void writeMinimizedCircuit(const SymbolSource &symbols, const Token *name,
+                           std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = elaborator.elaborate(name);
+  if (netlist.isSequential()) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                 "' has registers, so it can't be minimized.");
+  }
+  if (netlist.inputs.size() > MAX_INPUTS) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme + "' has " +
+                                 std::to_string(netlist.inputs.size()) +
+                                 " inputs, minimize supports at most " +
+                                 std::to_string(MAX_INPUTS) + ".");
+  }
+
+  os << "(circuit " << name->lexeme << " (";
+  for (size_t i = 0; i < netlist.inputNames.size(); i++) {
+    os << (i > 0 ? " " : "") << netlist.inputNames[i];
+  }
+  os << ")";
+  for (const Cover &on : onSets(netlist)) {
+    os << "\n  " << sumOfProducts(minimizer::minimize(on), netlist.inputNames);
+  }
+  os << ")\n";
+}
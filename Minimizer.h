@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Environment.h"
+
+// Two-level logic minimization in the style of Espresso. A function is a
+// cover: a sum of products, each product a cube over at most 32 inputs.
+namespace minimizer {
+
+// Bit i of `mask` is set when input i appears in the product, and bit i of
+// `value` then says whether it appears uncomplemented. The cube with no
+// literals is the constant true.
+struct Cube {
+  uint32_t mask = 0;
+  uint32_t value = 0;
+
+  bool operator==(const Cube &other) const {
+    return mask == other.mask && value == other.value;
+  }
+};
+
+using Cover = std::vector<Cube>;
+
+// The cubes covering every input combination the cover does not
+Cover complement(const Cover &cover);
+
+// Whether the cover includes every input combination
+bool isTautology(const Cover &cover);
+
+// Finds a near-minimal cover of the same function, fewest cubes first and
+// then fewest literals. Starting from the given cover, it repeats three
+// passes for as long as they make the cover cheaper:
+//
+// - expand: grows each cube into a prime implicant by dropping literals
+//   while it stays clear of the complement, and drops the cubes it swallows
+// - irredundant: removes cubes that the rest of the cover already covers
+// - reduce: shrinks each cube to the smallest one still covering what no
+//   other cube covers, so the next expand can grow it in a better direction
+Cover minimize(const Cover &cover);
+
+} // namespace minimizer
+
+// Elaborates the named circuit, derives the on-set of each output from its
+// truth table, minimizes it and writes the circuit back as a definition of
+// the same name whose body expressions are the minimized sums of products
+void writeMinimizedCircuit(const SymbolSource &symbols, const Token *name,
+                           std::ostream &os);
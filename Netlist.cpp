@@ -0,0 +1,80 @@
+#include "Netlist.h"
+
+#include <iostream>
+
+uint32_t Netlist::addInput(const std::string &inputName) {
+  uint32_t id = addGate(GateType::INPUT, nullptr, 0);
+  inputs.push_back(id);
+  inputNames.push_back(inputName);
+  return id;
+}
+
+uint32_t Netlist::addConstant(bool value) {
+  if (constants[value] < 0) {
+    constants[value] =
+        addGate(value ? GateType::CONST1 : GateType::CONST0, nullptr, 0);
+  }
+  return constants[value];
+}
+
+uint32_t Netlist::addRegister(bool initial) {
+  uint32_t id = addGate(GateType::REGISTER, nullptr, 0);
+  registers.push_back(id);
+  registerNext.push_back(id);
+  registerInitial.push_back(initial);
+  return id;
+}
+
+uint32_t Netlist::addGate(GateType type, const uint32_t *faninIds,
+                          size_t count) {
+  uint32_t id = types.size();
+  types.push_back(type);
+  fanins.insert(fanins.end(), faninIds, faninIds + count);
+  faninStart.push_back(fanins.size());
+  return id;
+}
+
+size_t Netlist::gateCount() const {
+  size_t count = 0;
+  for (GateType type : types) {
+    if (type != GateType::INPUT && type != GateType::REGISTER &&
+        type != GateType::CONST0 && type != GateType::CONST1) {
+      count++;
+    }
+  }
+  return count;
+}
+
+std::string gateTypeToString(GateType type) {
+  switch (type) {
+  case GateType::INPUT:
+    return "INPUT";
+  case GateType::REGISTER:
+    return "REGISTER";
+  case GateType::CONST0:
+    return "CONST0";
+  case GateType::CONST1:
+    return "CONST1";
+  case GateType::NOT:
+    return "NOT";
+  case GateType::AND:
+    return "AND";
+  case GateType::OR:
+    return "OR";
+  case GateType::XOR:
+    return "XOR";
+  case GateType::XNOR:
+    return "XNOR";
+  case GateType::NAND:
+    return "NAND";
+  case GateType::NOR:
+    return "NOR";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+std::ostream &operator<<(std::ostream &os, const GateType &type) {
+  os << gateTypeToString(type);
+  return os;
+}
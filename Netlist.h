@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class GateType : uint8_t {
+  INPUT,
+  REGISTER,
+  CONST0,
+  CONST1,
+  NOT,
+  AND,
+  OR,
+  XOR,
+  XNOR,
+  NAND,
+  NOR,
+};
+
+std::ostream &operator<<(std::ostream &os, const GateType &type);
+
+// Flat gate-level DAG of a single-bit circuit. Node IDs are dense and
+// topologically ordered: every fanin of a node has a smaller ID, so a single
+// pass in ID order evaluates the whole netlist. Fanins are stored as one
+// flat array indexed through faninStart.
+//
+// Registers are sources like inputs, holding the state of the current clock
+// cycle. The node each one takes at the next clock edge is kept on the side,
+// so the loops through registers never show up as fanins.
+class Netlist {
+public:
+  std::string name;
+
+  std::vector<GateType> types;
+  std::vector<uint32_t> faninStart{0}; // Node i's fanins: [start[i], start[i+1])
+  std::vector<uint32_t> fanins;
+
+  std::vector<uint32_t> inputs; // Primary inputs, in parameter order
+  std::vector<std::string> inputNames;
+  std::vector<uint32_t> outputs; // Primary outputs, one per body expression
+
+  std::vector<uint32_t> registers;    // Register nodes
+  std::vector<uint32_t> registerNext; // Value of each at the next clock edge
+  std::vector<bool> registerInitial;  // Value of each in the first cycle
+
+  uint32_t addInput(const std::string &inputName);
+  uint32_t addConstant(bool value);
+  uint32_t addRegister(bool initial); // Its next value is set once elaborated
+  uint32_t addGate(GateType type, const uint32_t *faninIds, size_t count);
+
+  size_t nodeCount() const { return types.size(); }
+  size_t gateCount() const;
+  bool isSequential() const { return !registers.empty(); }
+
+  const uint32_t *faninBegin(uint32_t node) const {
+    return fanins.data() + faninStart[node];
+  }
+  uint32_t faninCount(uint32_t node) const {
+    return faninStart[node + 1] - faninStart[node];
+  }
+
+private:
+  // Constant nodes are shared, created on first use
+  int64_t constants[2] = {-1, -1};
+};
@@ -1,10 +1,67 @@
 #include "Options.h"
 
-Options::Options() : debug(false) {}
+Options::Options()
+    : debug(false), engine(Engine::TREE), bitmap(false), streaming(false),
+      jobs(1), simulation(SimulationMode::LEVELIZED), interactive(false) {}
 
 bool Options::isDebugMode() const { return debug; }
 void Options::setDebugMode(bool val) { debug = val; }
 
+Engine Options::getEngine() const { return engine; }
+void Options::setEngine(Engine val) { engine = val; }
+
 void Options::setFileName(const std::string &name) { fileName = name; }
 const std::string &Options::getFileName() { return fileName; }
 bool Options::hasFileName() const { return !fileName.empty(); }
+
+void Options::setTruthTableCircuit(const std::string &name) {
+  truthTableCircuit = name;
+}
+const std::string &Options::getTruthTableCircuit() const {
+  return truthTableCircuit;
+}
+bool Options::hasTruthTableCircuit() const {
+  return !truthTableCircuit.empty();
+}
+
+void Options::setSimulateCircuit(const std::string &name) {
+  simulateCircuit = name;
+}
+const std::string &Options::getSimulateCircuit() const {
+  return simulateCircuit;
+}
+bool Options::hasSimulateCircuit() const { return !simulateCircuit.empty(); }
+
+void Options::setVectorFile(const std::string &name) { vectorFile = name; }
+const std::string &Options::getVectorFile() const { return vectorFile; }
+bool Options::hasVectorFile() const { return !vectorFile.empty(); }
+
+void Options::setEmitCppCircuit(const std::string &name) {
+  emitCppCircuit = name;
+}
+const std::string &Options::getEmitCppCircuit() const {
+  return emitCppCircuit;
+}
+bool Options::hasEmitCppCircuit() const { return !emitCppCircuit.empty(); }
+
+size_t Options::getJobs() const { return jobs; }
+void Options::setJobs(size_t val) { jobs = val; }
+
+SimulationMode Options::getSimulationMode() const { return simulation; }
+void Options::setSimulationMode(SimulationMode val) { simulation = val; }
+
+bool Options::isBitmapOutput() const { return bitmap; }
+void Options::setBitmapOutput(bool val) { bitmap = val; }
+
+bool Options::isStreaming() const { return streaming; }
+void Options::setStreaming(bool val) { streaming = val; }
+
+bool Options::isInteractive() const { return interactive; }
+void Options::setInteractive(bool val) { interactive = val; }
+
+const MemoConfig &Options::getMemoConfig() const { return memo; }
+void Options::setMemoAll(bool val) { memo.all = val; }
+void Options::addMemoCircuit(const std::string &name) {
+  memo.names.insert(name);
+}
+void Options::setMemoCapacity(size_t val) { memo.capacity = val; }
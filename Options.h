@@ -2,10 +2,30 @@
 
 #include <string>
 
+#include "EventSimulator.h"
+#include "MemoCache.h"
+
+// Which engine executes parsed statements
+enum class Engine {
+  TREE, // Tree-walking Evaluator
+  VM,   // Bytecode compiler and VM
+};
+
 class Options {
 private:
   bool debug;
+  Engine engine;
   std::string fileName;
+  std::string truthTableCircuit;
+  std::string simulateCircuit;
+  std::string vectorFile;
+  std::string emitCppCircuit;
+  bool bitmap;
+  bool streaming;
+  size_t jobs;
+  SimulationMode simulation;
+  bool interactive;
+  MemoConfig memo;
 
 public:
   Options();
@@ -13,7 +33,46 @@ public:
   bool isDebugMode() const;
   void setDebugMode(bool);
 
+  Engine getEngine() const;
+  void setEngine(Engine);
+
   void setFileName(const std::string &name);
   const std::string &getFileName();
   bool hasFileName() const;
+
+  void setTruthTableCircuit(const std::string &name);
+  const std::string &getTruthTableCircuit() const;
+  bool hasTruthTableCircuit() const;
+
+  void setSimulateCircuit(const std::string &name);
+  const std::string &getSimulateCircuit() const;
+  bool hasSimulateCircuit() const;
+
+  void setVectorFile(const std::string &name);
+  const std::string &getVectorFile() const;
+  bool hasVectorFile() const;
+
+  void setEmitCppCircuit(const std::string &name);
+  const std::string &getEmitCppCircuit() const;
+  bool hasEmitCppCircuit() const;
+
+  size_t getJobs() const;
+  void setJobs(size_t);
+
+  SimulationMode getSimulationMode() const;
+  void setSimulationMode(SimulationMode);
+
+  bool isBitmapOutput() const;
+  void setBitmapOutput(bool);
+
+  bool isStreaming() const;
+  void setStreaming(bool);
+
+  bool isInteractive() const;
+  void setInteractive(bool);
+
+  const MemoConfig &getMemoConfig() const;
+  void setMemoAll(bool);
+  void addMemoCircuit(const std::string &name);
+  void setMemoCapacity(size_t);
 };
@@ -1,10 +1,10 @@
 #include "Parser.h"
 
-Parser::Parser(const std::vector<std::shared_ptr<Token>> &tokens)
-    : tokens(tokens), current(0) {}
+Parser::Parser(const TokenStream &tokens, Arena &arena)
+    : tokens(tokens), arena(arena), current(0) {}
 
-std::vector<std::shared_ptr<Stmt>> Parser::parse() {
-  std::vector<std::shared_ptr<Stmt>> statements;
+std::vector<Stmt *> Parser::parse() {
+  std::vector<Stmt *> statements;
 
   // Parse statements until we reach the end of the file
   while (!isAtEnd()) {
@@ -19,6 +19,7 @@ std::vector<std::shared_ptr<Stmt>> Parser::parse() {
       }
     } catch (ParseError &error) {
       // Report the error and try to recover
+      pending.clear();
       synchronize();
     }
   }
@@ -27,22 +28,18 @@ std::vector<std::shared_ptr<Stmt>> Parser::parse() {
 }
 
 // Utility methods
-std::shared_ptr<Token> Parser::peek() { return tokens[current]; }
+bool Parser::isAtEnd() { return peek().type == TokenType::ENDOFFILE; }
 
-std::shared_ptr<Token> Parser::previous() { return tokens[current - 1]; }
-
-bool Parser::isAtEnd() { return peek()->type == TokenType::ENDOFFILE; }
-
-std::shared_ptr<Token> Parser::advance() {
+size_t Parser::advance() {
   if (!isAtEnd())
     current++;
-  return previous();
+  return current - 1;
 }
 
 bool Parser::check(TokenType type) {
   if (isAtEnd())
     return false;
-  return peek()->type == type;
+  return peek().type == type;
 }
 
 bool Parser::match(TokenType type) {
@@ -63,22 +60,20 @@ bool Parser::match(std::initializer_list<TokenType> types) {
   return false;
 }
 
-std::shared_ptr<Token> Parser::consume(TokenType type,
-                                       const std::string &message) {
+size_t Parser::consume(TokenType type, const std::string &message) {
   if (check(type))
     return advance();
 
-  throw error(peek(), message);
+  throw error(current, message);
 }
 
-ParseError Parser::error(std::shared_ptr<Token> token,
-                         const std::string &message) {
-  std::cerr << "[line " << token->line << "] Error";
+ParseError Parser::error(size_t index, const std::string &message) {
+  std::cerr << "[line " << tokens[index].line << "] Error";
 
-  if (token->type == TokenType::ENDOFFILE) {
+  if (tokens[index].type == TokenType::ENDOFFILE) {
     std::cerr << " at end";
   } else {
-    std::cerr << " at '" << token->lexeme << "'";
+    std::cerr << " at '" << tokens.lexeme(index) << "'";
   }
 
   std::cerr << ": " << message << std::endl;
@@ -86,19 +81,31 @@ ParseError Parser::error(std::shared_ptr<Token> token,
   return ParseError(message);
 }
 
+ArenaList<Expr *> Parser::takeList(size_t first) {
+  ArenaList<Expr *> list =
+      arena.list<Expr *>(pending.begin() + first, pending.end());
+  pending.resize(first);
+  return list;
+}
+
 void Parser::synchronize() {
   advance();
 
   while (!isAtEnd()) {
-    if (previous()->type == TokenType::RIGHT_PAREN)
+    if (previous().type == TokenType::RIGHT_PAREN)
       return;
 
-    switch (peek()->type) {
+    switch (peek().type) {
     case TokenType::CIRCUIT:
     case TokenType::BIT:
     case TokenType::BIT_VECTOR:
     case TokenType::PRINT:
     case TokenType::RETURN:
+    case TokenType::TRUTH_TABLE:
+    case TokenType::SIMULATE:
+    case TokenType::BDD:
+    case TokenType::EQUIV:
+    case TokenType::MINIMIZE:
     case TokenType::LEFT_PAREN:
       return;
     default:
@@ -110,13 +117,14 @@ void Parser::synchronize() {
 }
 
 // Grammar rules
-std::vector<std::shared_ptr<Stmt>> Parser::program() {
-  std::vector<std::shared_ptr<Stmt>> statements;
+std::vector<Stmt *> Parser::program() {
+  std::vector<Stmt *> statements;
 
   while (!isAtEnd()) {
     try {
       statements.push_back(statement());
     } catch (ParseError &error) {
+      pending.clear();
       synchronize();
     }
   }
@@ -124,7 +132,7 @@ std::vector<std::shared_ptr<Stmt>> Parser::program() {
   return statements;
 }
 
-std::shared_ptr<Stmt> Parser::statement() {
+Stmt *Parser::statement() {
   // Skip any whitespace or unexpected tokens
   while (!isAtEnd() && !check(TokenType::LEFT_PAREN)) {
     advance();
@@ -132,7 +140,7 @@ std::shared_ptr<Stmt> Parser::statement() {
 
   // All statements start with a left parenthesis in this language
   if (isAtEnd() || !match(TokenType::LEFT_PAREN)) {
-    throw error(peek(), "Expected '(' at the start of a statement.");
+    throw error(current, "Expected '(' at the start of a statement.");
   }
 
   // Determine the type of statement based on the next token
@@ -146,6 +154,18 @@ std::shared_ptr<Stmt> Parser::statement() {
     return printStatement();
   } else if (match(TokenType::RETURN)) {
     return returnStatement();
+  } else if (match(TokenType::TRUTH_TABLE)) {
+    return truthTableStatement();
+  } else if (match(TokenType::SIMULATE)) {
+    return simulateStatement();
+  } else if (match(TokenType::BDD)) {
+    return bddStatement();
+  } else if (match(TokenType::EQUIV)) {
+    return equivStatement();
+  } else if (match(TokenType::MINIMIZE)) {
+    return minimizeStatement();
+  } else if (match(TokenType::REGISTER)) {
+    throw error(current - 1, "Registers can only be declared in a circuit.");
   } else {
     // It's an expression statement
     current--; // Move back to allow the expression parser to see the left paren
@@ -153,9 +173,9 @@ std::shared_ptr<Stmt> Parser::statement() {
   }
 }
 
-std::shared_ptr<Stmt> Parser::definition() {
+Stmt *Parser::definition() {
   // Token type was already consumed in statement()
-  TokenType defType = previous()->type;
+  TokenType defType = previous().type;
 
   if (defType == TokenType::CIRCUIT) {
     return circuitDef();
@@ -165,49 +185,53 @@ std::shared_ptr<Stmt> Parser::definition() {
     return bitVectorDef();
   }
 
-  throw error(previous(), "Expected definition type.");
+  throw error(current - 1, "Expected definition type.");
 }
 
 // Fixed circuit definition implementation
-std::shared_ptr<Stmt> Parser::circuitDef() {
+Stmt *Parser::circuitDef() {
   // 'circuit' token already consumed
-  std::shared_ptr<Token> name =
-      consume(TokenType::IDENTIFIER, "Expected circuit name.");
+  const Token *name =
+      token(consume(TokenType::IDENTIFIER, "Expected circuit name."));
 
   // Parse parameters
   consume(TokenType::LEFT_PAREN, "Expected '(' after circuit name.");
 
-  std::vector<std::shared_ptr<Token>> parameters;
+  std::vector<const Token *> parameters;
   if (!check(TokenType::RIGHT_PAREN)) {
     do {
       parameters.push_back(
-          consume(TokenType::IDENTIFIER, "Expected parameter name."));
+          token(consume(TokenType::IDENTIFIER, "Expected parameter name.")));
     } while (!check(TokenType::RIGHT_PAREN) && !isAtEnd());
   }
 
   consume(TokenType::RIGHT_PAREN, "Expected ')' after parameters.");
 
-  std::vector<std::shared_ptr<Expr>> body;
+  size_t body = pending.size();
+  std::vector<Register> registers;
 
   // Parse the body statements, but don't require a closing parenthesis for each
   // circuit
   while (!check(TokenType::RIGHT_PAREN) && !isAtEnd()) {
+    size_t mark = pending.size();
     try {
-      if (check(TokenType::LEFT_PAREN)) {
+      if (check(TokenType::LEFT_PAREN) &&
+          tokens[current + 1].type == TokenType::REGISTER) {
+        current += 2;
+        registers.push_back(registerDecl());
+      } else if (check(TokenType::LEFT_PAREN)) {
         // Found a statement
-        std::shared_ptr<Stmt> stmt = statement();
+        Stmt *stmt = statement();
 
         // Add expressions and return values to the body
-        if (auto exprStmt = std::dynamic_pointer_cast<ExpressionStmt>(stmt)) {
-          body.push_back(exprStmt->expression);
-        } else if (auto returnStmt =
-                       std::dynamic_pointer_cast<ReturnStmt>(stmt)) {
-          body.push_back(returnStmt->value);
-        } else if (auto bitDefStmt =
-                       std::dynamic_pointer_cast<BitDefStmt>(stmt)) {
+        if (auto exprStmt = dynamic_cast<ExpressionStmt *>(stmt)) {
+          pending.push_back(exprStmt->expression);
+        } else if (auto returnStmt = dynamic_cast<ReturnStmt *>(stmt)) {
+          pending.push_back(returnStmt->value);
+        } else if (auto bitDefStmt = dynamic_cast<BitDefStmt *>(stmt)) {
           // For bit definitions in circuits, we'd store them in an environment
           // but for now we'll just add them as expressions
-          body.push_back(std::make_shared<VariableExpr>(bitDefStmt->name));
+          pending.push_back(arena.make<VariableExpr>(bitDefStmt->name));
         }
       } else {
         // Skip unexpected tokens
@@ -215,6 +239,7 @@ std::shared_ptr<Stmt> Parser::circuitDef() {
       }
     } catch (ParseError &error) {
       // More lenient error recovery for circuit bodies
+      pending.resize(mark);
       while (!isAtEnd() && !check(TokenType::LEFT_PAREN) &&
              !check(TokenType::RIGHT_PAREN)) {
         advance();
@@ -231,16 +256,30 @@ std::shared_ptr<Stmt> Parser::circuitDef() {
               << name->lexeme << "'" << std::endl;
   }
 
-  return std::make_shared<CircuitDefStmt>(name, parameters, body);
+  ArenaList<Expr *> bodyList = takeList(body);
+  return arena.make<CircuitDefStmt>(name, arena.list(parameters), bodyList,
+                                    arena.list(registers));
+}
+
+Register Parser::registerDecl() {
+  // '(' 'register' already consumed
+  const Token *name =
+      token(consume(TokenType::IDENTIFIER, "Expected register name."));
+  Expr *initial = expression();
+  Expr *next = expression();
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after register.");
+
+  return Register{name, initial, next};
 }
 
-std::shared_ptr<Stmt> Parser::bitDef() {
+Stmt *Parser::bitDef() {
   // 'bit' token already consumed
-  std::shared_ptr<Token> name =
-      consume(TokenType::IDENTIFIER, "Expected bit name.");
+  const Token *name =
+      token(consume(TokenType::IDENTIFIER, "Expected bit name."));
 
   // Parse the initializer
-  std::shared_ptr<Expr> initializer;
+  Expr *initializer = nullptr;
 
   // If the next token is a literal or identifier, parse it as the initializer
   if (check(TokenType::TRUE) || check(TokenType::FALSE) ||
@@ -250,80 +289,77 @@ std::shared_ptr<Stmt> Parser::bitDef() {
     // Handle nested expressions
     initializer = expression();
   } else {
-    throw error(peek(), "Expected expression for bit initializer.");
+    throw error(current, "Expected expression for bit initializer.");
   }
 
   consume(TokenType::RIGHT_PAREN, "Expected ')' after bit definition.");
 
-  return std::make_shared<BitDefStmt>(name, initializer);
+  return arena.make<BitDefStmt>(name, initializer);
 }
 
-std::shared_ptr<Stmt> Parser::bitVectorDef() {
+Stmt *Parser::bitVectorDef() {
   // 'bit_vector' token already consumed
 
   // Check if there's an identifier
   if (check(TokenType::IDENTIFIER)) {
-    std::shared_ptr<Token> name =
-        consume(TokenType::IDENTIFIER, "Expected bit_vector name.");
+    const Token *name =
+        token(consume(TokenType::IDENTIFIER, "Expected bit_vector name."));
 
-    std::vector<std::shared_ptr<Expr>> values;
+    size_t values = pending.size();
 
     // Parse one or more expressions
     do {
-      values.push_back(expression());
+      pending.push_back(expression());
     } while (!check(TokenType::RIGHT_PAREN) && !isAtEnd());
 
     consume(TokenType::RIGHT_PAREN,
             "Expected ')' after bit_vector definition.");
 
-    return std::make_shared<BitVectorDefStmt>(name, values);
+    return arena.make<BitVectorDefStmt>(name, takeList(values));
   } else if (check(TokenType::BIT_VECTOR) || check(TokenType::BOOL)) {
     // This is a literal bit vector like 0b0101
-    std::shared_ptr<Expr> expr = expression();
+    Expr *expr = expression();
     consume(TokenType::RIGHT_PAREN,
             "Expected ')' after bit_vector definition.");
 
     // Since we don't have a name, we'll create one
-    struct literal empty_lit;
-    empty_lit.boolean = false;
-    empty_lit.is_bitvector = false;
+    Interner &interner = Interner::global();
+    const Token *emptyName = arena.make<Token>(
+        TokenType::IDENTIFIER, interner.text(interner.intern("")), peek().line);
 
-    std::shared_ptr<Token> emptyName = std::make_shared<Token>(
-        TokenType::IDENTIFIER, "", empty_lit, peek()->line);
-
-    std::vector<std::shared_ptr<Expr>> vec_values = {expr};
-    return std::make_shared<BitVectorDefStmt>(emptyName, vec_values);
+    return arena.make<BitVectorDefStmt>(emptyName,
+                                        arena.list<Expr *>(&expr, &expr + 1));
   }
 
-  throw error(peek(),
+  throw error(current,
               "Expected identifier or bit vector literal after 'bit_vector'.");
 }
 
-std::shared_ptr<Stmt> Parser::expressionStatement() {
-  std::shared_ptr<Expr> expr = expression();
+Stmt *Parser::expressionStatement() {
+  Expr *expr = expression();
 
   // Check if we need to consume the closing parenthesis
-  if (previous()->type == TokenType::LEFT_PAREN) {
+  if (previous().type == TokenType::LEFT_PAREN) {
     consume(TokenType::RIGHT_PAREN, "Expected ')' after expression.");
   }
 
-  return std::make_shared<ExpressionStmt>(expr);
+  return arena.make<ExpressionStmt>(expr);
 }
 
-std::shared_ptr<Stmt> Parser::printStatement() {
+Stmt *Parser::printStatement() {
   // 'print' token already consumed
-  std::shared_ptr<Expr> value = expression();
+  Expr *value = expression();
 
   consume(TokenType::RIGHT_PAREN, "Expected ')' after print statement.");
 
-  return std::make_shared<PrintStmt>(value);
+  return arena.make<PrintStmt>(value);
 }
 
-std::shared_ptr<Stmt> Parser::returnStatement() {
+Stmt *Parser::returnStatement() {
   // 'return' token already consumed
 
   // The return statement can have either an identifier or an expression
-  std::shared_ptr<Expr> value;
+  Expr *value = nullptr;
 
   if (check(TokenType::LEFT_PAREN)) {
     // It's a parenthesized expression
@@ -331,17 +367,86 @@ std::shared_ptr<Stmt> Parser::returnStatement() {
   } else if (check(TokenType::IDENTIFIER)) {
     // It's a variable reference
     advance();
-    value = std::make_shared<VariableExpr>(previous());
+    value = arena.make<VariableExpr>(token(current - 1));
   } else {
-    throw error(peek(), "Expected expression or identifier after 'return'.");
+    throw error(current, "Expected expression or identifier after 'return'.");
   }
 
   consume(TokenType::RIGHT_PAREN, "Expected ')' after return statement.");
 
-  return std::make_shared<ReturnStmt>(value);
+  return arena.make<ReturnStmt>(value);
+}
+
+Stmt *Parser::truthTableStatement() {
+  // 'truth_table' token already consumed
+  const Token *circuit = token(consume(
+      TokenType::IDENTIFIER, "Expected circuit name after 'truth_table'."));
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after truth_table statement.");
+
+  return arena.make<TruthTableStmt>(circuit);
+}
+
+Stmt *Parser::bddStatement() {
+  // 'bdd' token already consumed
+  const Token *circuit = token(
+      consume(TokenType::IDENTIFIER, "Expected circuit name after 'bdd'."));
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after bdd statement.");
+
+  return arena.make<BddStmt>(circuit);
+}
+
+Stmt *Parser::equivStatement() {
+  // 'equiv' token already consumed
+  const Token *first = token(
+      consume(TokenType::IDENTIFIER, "Expected circuit name after 'equiv'."));
+  const Token *second = token(consume(
+      TokenType::IDENTIFIER, "Expected second circuit name after 'equiv'."));
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after equiv statement.");
+
+  return arena.make<EquivStmt>(first, second);
+}
+
+Stmt *Parser::minimizeStatement() {
+  // 'minimize' token already consumed
+  const Token *circuit = token(consume(
+      TokenType::IDENTIFIER, "Expected circuit name after 'minimize'."));
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after minimize statement.");
+
+  return arena.make<MinimizeStmt>(circuit);
+}
+
+Stmt *Parser::simulateStatement() {
+  // 'simulate' token already consumed
+  const Token *circuit = token(consume(
+      TokenType::IDENTIFIER, "Expected circuit name after 'simulate'."));
+
+  // Cycle counts are written in binary, like every other number
+  if (!match({TokenType::BOOL, TokenType::BIT_VECTOR})) {
+    throw error(current, "Expected a binary cycle count after circuit name.");
+  }
+  const struct literal &count = tokens.value(current - 1);
+  if (count.size() > 64) {
+    throw error(current - 1, "Cycle count does not fit in 64 bits.");
+  }
+  uint64_t cycles = 0;
+  for (size_t i = 0; i < count.size(); i++) {
+    cycles = cycles << 1 | count.getBit(i);
+  }
+  if (check(TokenType::BOOL)) {
+    // A decimal count like 100 scans as separate bits
+    throw error(current, "Cycle counts are binary, write them as 0b...");
+  }
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after simulate statement.");
+
+  return arena.make<SimulateStmt>(circuit, cycles);
 }
 
-std::shared_ptr<Expr> Parser::expression() {
+Expr *Parser::expression() {
   if (check(TokenType::TRUE) || check(TokenType::FALSE) ||
       check(TokenType::BOOL) || check(TokenType::BIT_VECTOR)) {
     advance(); // Consume the token
@@ -362,53 +467,53 @@ std::shared_ptr<Expr> Parser::expression() {
         check(TokenType::NOR) || check(TokenType::XOR) ||
         check(TokenType::XNOR)) {
 
-      TokenType opType = peek()->type;
+      TokenType opType = peek().type;
       advance(); // Consume operation token
 
       if (opType == TokenType::NOT) {
         // Unary operation
-        std::shared_ptr<Token> op = previous();
-        std::shared_ptr<Expr> right = expression();
+        const Token *op = token(current - 1);
+        Expr *right = expression();
         consume(TokenType::RIGHT_PAREN, "Expected ')' after 'not' expression.");
-        return std::make_shared<UnaryExpr>(op, right);
+        return arena.make<UnaryExpr>(op, right);
       } else if (opType == TokenType::AND || opType == TokenType::OR) {
         // Multi-operand operation
-        std::shared_ptr<Token> op = previous();
-        std::vector<std::shared_ptr<Expr>> operands;
+        const Token *op = token(current - 1);
+        size_t operands = pending.size();
 
         while (!check(TokenType::RIGHT_PAREN) && !isAtEnd()) {
-          operands.push_back(expression());
+          pending.push_back(expression());
         }
 
         consume(TokenType::RIGHT_PAREN,
                 "Expected ')' after multi-operand expression.");
-        return std::make_shared<MultiExpr>(op, operands);
+        return arena.make<MultiExpr>(op, takeList(operands));
       } else {
         // Binary operation
-        std::shared_ptr<Token> op = previous();
-        std::shared_ptr<Expr> left = expression();
-        std::shared_ptr<Expr> right = expression();
+        const Token *op = token(current - 1);
+        Expr *left = expression();
+        Expr *right = expression();
         consume(TokenType::RIGHT_PAREN,
                 "Expected ')' after binary expression.");
-        return std::make_shared<BinaryExpr>(op, left, right);
+        return arena.make<BinaryExpr>(op, left, right);
       }
     } else if (check(TokenType::IDENTIFIER)) {
       // It's a function call like (HALF_ADDER A B)
-      std::shared_ptr<Token> funcName =
-          consume(TokenType::IDENTIFIER, "Expected function name.");
+      const Token *funcName =
+          token(consume(TokenType::IDENTIFIER, "Expected function name."));
 
       // Parse arguments
-      std::vector<std::shared_ptr<Expr>> args;
+      size_t args = pending.size();
       while (!check(TokenType::RIGHT_PAREN) && !isAtEnd()) {
         if (check(TokenType::IDENTIFIER)) {
           advance(); // Consume identifier
-          args.push_back(std::make_shared<VariableExpr>(previous()));
+          pending.push_back(arena.make<VariableExpr>(token(current - 1)));
         } else if (check(TokenType::LEFT_PAREN)) {
-          args.push_back(expression());
+          pending.push_back(expression());
         } else if (check(TokenType::TRUE) || check(TokenType::FALSE) ||
                    check(TokenType::BOOL) || check(TokenType::BIT_VECTOR)) {
           advance(); // Consume token
-          args.push_back(literal());
+          pending.push_back(literal());
         } else {
           // Skip invalid tokens
           advance();
@@ -418,62 +523,58 @@ std::shared_ptr<Expr> Parser::expression() {
       consume(TokenType::RIGHT_PAREN, "Expected ')' after function arguments.");
 
       // Create a call expression
-      return std::make_shared<CallExpr>(funcName, args);
+      return arena.make<CallExpr>(funcName, takeList(args));
     }
 
     // It's a grouped expression
-    std::shared_ptr<Expr> expr = expression();
+    Expr *expr = expression();
     consume(TokenType::RIGHT_PAREN, "Expected ')' after expression.");
-    return std::make_shared<GroupingExpr>(expr);
+    return arena.make<GroupingExpr>(expr);
   }
 
-  throw error(peek(), "Expected expression.");
+  throw error(current, "Expected expression.");
 }
 
-std::shared_ptr<Expr> Parser::literal() {
+Expr *Parser::literal() {
   // TRUE, FALSE, BOOL or BIT_VECTOR token already consumed
   struct literal lit_value;
 
-  if (previous()->type == TokenType::TRUE) {
-    lit_value.boolean = true;
-    lit_value.is_bitvector = true;
-    lit_value.bits = {true};
-  } else if (previous()->type == TokenType::FALSE) {
-    lit_value.boolean = false;
-    lit_value.is_bitvector = true;
-    lit_value.bits = {false};
-  } else if (previous()->type == TokenType::BIT_VECTOR) {
+  if (previous().type == TokenType::TRUE) {
+    lit_value = literal::fromBit(true);
+  } else if (previous().type == TokenType::FALSE) {
+    lit_value = literal::fromBit(false);
+  } else if (previous().type == TokenType::BIT_VECTOR) {
     // Handle bit vector literal
-    lit_value = previous()->lit;
+    lit_value = tokens.value(current - 1);
   } else {
     // It's a BOOL token (0, 1, or bit vector)
-    lit_value = previous()->lit;
+    lit_value = tokens.value(current - 1);
   }
 
-  return std::make_shared<LiteralExpr>(lit_value);
+  return arena.make<LiteralExpr>(lit_value);
 }
 
-std::shared_ptr<Expr> Parser::variableRef() {
+Expr *Parser::variableRef() {
   // IDENTIFIER token already consumed
-  std::shared_ptr<Token> name = previous();
+  const Token *name = token(current - 1);
 
   // Check if this is a function call
   if (check(TokenType::LEFT_PAREN)) {
     advance(); // Consume the left parenthesis
 
-    std::vector<std::shared_ptr<Expr>> arguments;
+    size_t arguments = pending.size();
 
     // Parse arguments
     while (!check(TokenType::RIGHT_PAREN) && !isAtEnd()) {
       if (check(TokenType::IDENTIFIER)) {
         advance(); // Consume the identifier
-        arguments.push_back(std::make_shared<VariableExpr>(previous()));
+        pending.push_back(arena.make<VariableExpr>(token(current - 1)));
       } else if (check(TokenType::LEFT_PAREN)) {
-        arguments.push_back(expression());
+        pending.push_back(expression());
       } else if (check(TokenType::TRUE) || check(TokenType::FALSE) ||
                  check(TokenType::BOOL) || check(TokenType::BIT_VECTOR)) {
         advance(); // Consume token
-        arguments.push_back(literal());
+        pending.push_back(literal());
       } else {
         // Skip invalid tokens
         advance();
@@ -483,13 +584,13 @@ std::shared_ptr<Expr> Parser::variableRef() {
     consume(TokenType::RIGHT_PAREN, "Expected ')' after function arguments.");
 
     // Create a call expression
-    return std::make_shared<CallExpr>(name, arguments);
+    return arena.make<CallExpr>(name, takeList(arguments));
   }
 
-  return std::make_shared<VariableExpr>(name);
+  return arena.make<VariableExpr>(name);
 }
 
-std::shared_ptr<Expr> Parser::operation() {
+Expr *Parser::operation() {
   // Operation token is already consumed or is about to be consumed
   if (check(TokenType::NOT)) {
     advance(); // Consume the NOT token
@@ -501,74 +602,74 @@ std::shared_ptr<Expr> Parser::operation() {
   } else if (check(TokenType::AND) || check(TokenType::OR)) {
     advance(); // Consume the operator token
     return multiOp();
-  } else if (previous()->type == TokenType::NOT) {
+  } else if (previous().type == TokenType::NOT) {
     // NOT was already consumed
     return unaryOp();
-  } else if (previous()->type == TokenType::XOR ||
-             previous()->type == TokenType::XNOR ||
-             previous()->type == TokenType::NAND ||
-             previous()->type == TokenType::NOR) {
+  } else if (previous().type == TokenType::XOR ||
+             previous().type == TokenType::XNOR ||
+             previous().type == TokenType::NAND ||
+             previous().type == TokenType::NOR) {
     // Binary operator was already consumed
     return binaryOp();
-  } else if (previous()->type == TokenType::AND ||
-             previous()->type == TokenType::OR) {
+  } else if (previous().type == TokenType::AND ||
+             previous().type == TokenType::OR) {
     // Multi operator was already consumed
     return multiOp();
   }
 
-  throw error(peek(), "Expected operation type (not, and, or, etc.).");
+  throw error(current, "Expected operation type (not, and, or, etc.).");
 }
 
-std::shared_ptr<Expr> Parser::unaryOp() {
+Expr *Parser::unaryOp() {
   // 'not' token already consumed
-  std::shared_ptr<Token> op = previous();
-  std::shared_ptr<Expr> right = expression();
+  const Token *op = token(current - 1);
+  Expr *right = expression();
 
   // Only consume the closing parenthesis if we're inside parentheses
-  if (current > 0 && tokens[current - 1]->type != TokenType::RIGHT_PAREN &&
-      tokens[current - 2]->type != TokenType::RIGHT_PAREN &&
+  if (current > 0 && tokens[current - 1].type != TokenType::RIGHT_PAREN &&
+      tokens[current - 2].type != TokenType::RIGHT_PAREN &&
       current < tokens.size() && check(TokenType::RIGHT_PAREN)) {
     consume(TokenType::RIGHT_PAREN, "Expected ')' after 'not' expression.");
   }
 
-  return std::make_shared<UnaryExpr>(op, right);
+  return arena.make<UnaryExpr>(op, right);
 }
 
-std::shared_ptr<Expr> Parser::binaryOp() {
+Expr *Parser::binaryOp() {
   // Binary operator token already consumed
-  std::shared_ptr<Token> op = previous();
+  const Token *op = token(current - 1);
 
-  std::shared_ptr<Expr> left = expression();
-  std::shared_ptr<Expr> right = expression();
+  Expr *left = expression();
+  Expr *right = expression();
 
   // Only consume the closing parenthesis if we're inside parentheses
-  if (current > 0 && tokens[current - 1]->type != TokenType::RIGHT_PAREN &&
-      tokens[current - 2]->type != TokenType::RIGHT_PAREN &&
+  if (current > 0 && tokens[current - 1].type != TokenType::RIGHT_PAREN &&
+      tokens[current - 2].type != TokenType::RIGHT_PAREN &&
       current < tokens.size() && check(TokenType::RIGHT_PAREN)) {
     consume(TokenType::RIGHT_PAREN, "Expected ')' after binary expression.");
   }
 
-  return std::make_shared<BinaryExpr>(op, left, right);
+  return arena.make<BinaryExpr>(op, left, right);
 }
 
-std::shared_ptr<Expr> Parser::multiOp() {
+Expr *Parser::multiOp() {
   // Multi operator token already consumed
-  std::shared_ptr<Token> op = previous();
+  const Token *op = token(current - 1);
 
-  std::vector<std::shared_ptr<Expr>> operands;
+  size_t operands = pending.size();
 
   // Parse one or more expressions
   do {
-    operands.push_back(expression());
+    pending.push_back(expression());
   } while (!check(TokenType::RIGHT_PAREN) && !isAtEnd());
 
   // Only consume the closing parenthesis if we're inside parentheses
-  if (current > 0 && tokens[current - 1]->type != TokenType::RIGHT_PAREN &&
-      tokens[current - 2]->type != TokenType::RIGHT_PAREN &&
+  if (current > 0 && tokens[current - 1].type != TokenType::RIGHT_PAREN &&
+      tokens[current - 2].type != TokenType::RIGHT_PAREN &&
       current < tokens.size() && check(TokenType::RIGHT_PAREN)) {
     consume(TokenType::RIGHT_PAREN,
             "Expected ')' after multi-operand expression.");
   }
 
-  return std::make_shared<MultiExpr>(op, operands);
+  return arena.make<MultiExpr>(op, takeList(operands));
 }
@@ -18,43 +18,61 @@ public:
 
 class Parser {
 private:
-  std::vector<std::shared_ptr<Token>> tokens;
-  int current = 0;
+  const TokenStream &tokens;
+  Arena &arena; // Owns the nodes and tokens of the syntax tree
+  size_t current = 0;
 
-  // Utility methods
-  std::shared_ptr<Token> peek();
-  std::shared_ptr<Token> previous();
+  // Children of the lists being parsed, shared by every nesting level. A
+  // list collects its children at the top and takes them into the arena
+  // when it closes, so parsing does not allocate a vector per node.
+  std::vector<Expr *> pending;
+
+  // Utility methods. Tokens are referred to by index; token() builds the
+  // standalone Token a syntax tree node keeps.
+  const TokenStream::Entry &peek() const { return tokens[current]; }
+  const TokenStream::Entry &previous() const { return tokens[current - 1]; }
+  const Token *token(size_t index) const {
+    return tokens.token(index, arena);
+  }
   bool isAtEnd();
-  std::shared_ptr<Token> advance();
+  size_t advance();
   bool check(TokenType type);
   bool match(TokenType type);
   bool match(std::initializer_list<TokenType> types);
-  std::shared_ptr<Token> consume(TokenType type, const std::string &message);
-  ParseError error(std::shared_ptr<Token> token, const std::string &message);
+  size_t consume(TokenType type, const std::string &message);
+  ParseError error(size_t index, const std::string &message);
   void synchronize();
+  ArenaList<Expr *> takeList(size_t first);
 
   // Grammar rules
-  std::vector<std::shared_ptr<Stmt>> program();
-  std::shared_ptr<Stmt> statement();
-  std::shared_ptr<Stmt> definition();
-  std::shared_ptr<Stmt> circuitDef();
-  std::shared_ptr<Stmt> bitDef();
-  std::shared_ptr<Stmt> bitVectorDef();
-  std::shared_ptr<Stmt> expressionStatement();
-  std::shared_ptr<Stmt> printStatement();
-  std::shared_ptr<Stmt> returnStatement();
-
-  std::shared_ptr<Expr> expression();
-  std::shared_ptr<Expr> literal();
-  std::shared_ptr<Expr> variableRef();
-  std::shared_ptr<Expr> functionCall();
-  std::shared_ptr<Expr> operation();
-  std::shared_ptr<Expr> unaryOp();
-  std::shared_ptr<Expr> binaryOp();
-  std::shared_ptr<Expr> multiOp();
-  std::shared_ptr<Expr> primary();
+  std::vector<Stmt *> program();
+  Stmt *statement();
+  Stmt *definition();
+  Stmt *circuitDef();
+  Stmt *bitDef();
+  Stmt *bitVectorDef();
+  Stmt *expressionStatement();
+  Stmt *printStatement();
+  Stmt *returnStatement();
+  Stmt *truthTableStatement();
+  Stmt *simulateStatement();
+  Stmt *bddStatement();
+  Stmt *equivStatement();
+  Stmt *minimizeStatement();
+  Register registerDecl();
+
+  Expr *expression();
+  Expr *literal();
+  Expr *variableRef();
+  Expr *functionCall();
+  Expr *operation();
+  Expr *unaryOp();
+  Expr *binaryOp();
+  Expr *multiOp();
+  Expr *primary();
 
 public:
-  Parser(const std::vector<std::shared_ptr<Token>> &tok);
-  std::vector<std::shared_ptr<Stmt>> parse();
+  // The stream must outlive the parser, and the arena the syntax tree
+  Parser(const TokenStream &tokens, Arena &arena);
+  std::vector<Stmt *> parse();
 };
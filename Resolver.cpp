@@ -0,0 +1,120 @@
+#include "Resolver.h"
+
+void Resolver::resolve(const std::vector<Stmt *> &statements) {
+  for (const auto &stmt : statements) {
+    stmt->accept(this);
+  }
+}
+
+// ExprVisitor implementation
+void *Resolver::visitLiteralExpr(LiteralExpr *) { return nullptr; }
+
+void *Resolver::visitVariableExpr(VariableExpr *expr) {
+  const std::string &name = expr->name->lexeme;
+
+  // A repeated parameter name binds the last argument, like define did
+  expr->parameter = Expr::NO_SLOT;
+  if (circuit != nullptr) {
+    for (size_t i = circuit->parameters.size(); i-- > 0;) {
+      if (circuit->parameters[i]->lexeme == name) {
+        expr->parameter = i;
+        break;
+      }
+    }
+  }
+
+  expr->valueSlot = environment.valueSlot(name);
+  expr->circuitSlot = environment.circuitSlot(name);
+  return nullptr;
+}
+
+void *Resolver::visitUnaryExpr(UnaryExpr *expr) {
+  resolve(*expr->right);
+  return nullptr;
+}
+
+void *Resolver::visitBinaryExpr(BinaryExpr *expr) {
+  resolve(*expr->left);
+  resolve(*expr->right);
+  return nullptr;
+}
+
+void *Resolver::visitMultiExpr(MultiExpr *expr) {
+  for (const auto &operand : expr->operands) {
+    resolve(*operand);
+  }
+  return nullptr;
+}
+
+void *Resolver::visitGroupingExpr(GroupingExpr *expr) {
+  resolve(*expr->expression);
+  return nullptr;
+}
+
+void *Resolver::visitCallExpr(CallExpr *expr) {
+  expr->circuitSlot = environment.circuitSlot(expr->callee->lexeme);
+  for (const auto &argument : expr->arguments) {
+    resolve(*argument);
+  }
+  return nullptr;
+}
+
+// StmtVisitor implementation
+void *Resolver::visitExpressionStmt(ExpressionStmt *stmt) {
+  resolve(*stmt->expression);
+  return nullptr;
+}
+
+void *Resolver::visitCircuitDefStmt(CircuitDefStmt *stmt) {
+  stmt->slot = environment.circuitSlot(stmt->name->lexeme);
+  stmt->parameterSlots.clear();
+  for (const auto &parameter : stmt->parameters) {
+    stmt->parameterSlots.push_back(environment.valueSlot(parameter->lexeme));
+  }
+
+  circuit = stmt;
+  for (const auto &expr : stmt->body) {
+    resolve(*expr);
+  }
+  circuit = nullptr;
+  return nullptr;
+}
+
+void *Resolver::visitBitDefStmt(BitDefStmt *stmt) {
+  stmt->slot = environment.valueSlot(stmt->name->lexeme);
+  resolve(*stmt->initializer);
+  return nullptr;
+}
+
+void *Resolver::visitBitVectorDefStmt(BitVectorDefStmt *stmt) {
+  stmt->slot = environment.valueSlot(stmt->name->lexeme);
+  for (const auto &value : stmt->values) {
+    resolve(*value);
+  }
+  return nullptr;
+}
+
+void *Resolver::visitPrintStmt(PrintStmt *stmt) {
+  resolve(*stmt->expression);
+  return nullptr;
+}
+
+void *Resolver::visitReturnStmt(ReturnStmt *stmt) {
+  resolve(*stmt->value);
+  return nullptr;
+}
+
+void *Resolver::visitTruthTableStmt(TruthTableStmt *) {
+  // The truth table looks its circuit up by name when it runs
+  return nullptr;
+}
+
+void *Resolver::visitSimulateStmt(SimulateStmt *) { return nullptr; }
+
+void *Resolver::visitBddStmt(BddStmt *) { return nullptr; }
+
+void *Resolver::visitEquivStmt(EquivStmt *) { return nullptr; }
+
+void *Resolver::visitMinimizeStmt(MinimizeStmt *) { return nullptr; }
+
+void *Resolver::visitEmitCppStmt(EmitCppStmt *) { return nullptr; }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Environment.h"
+#include "Expr.h"
+#include "Stmt.h"
+
+// Binds every name in a program to the slots of an Environment before it is
+// evaluated, so the evaluator never looks a name up by its string.
+//
+// Circuit parameters are bound to their index in the circuit's frame. Any
+// other name in a circuit body is still resolved when the circuit runs,
+// because scoping is dynamic: the evaluator looks for a parameter of that
+// name in the frames of the callers, innermost first, and falls back to the
+// global. Every name therefore also gets its global value slot.
+class Resolver : public ExprVisitor, public StmtVisitor {
+private:
+  Environment &environment;
+  const CircuitDefStmt *circuit = nullptr; // Circuit being resolved
+
+  void resolve(Expr &expr) { expr.accept(this); }
+
+public:
+  Resolver(Environment &environment) : environment(environment) {}
+
+  void resolve(const std::vector<Stmt *> &statements);
+
+  // ExprVisitor implementation
+  void *visitLiteralExpr(LiteralExpr *expr) override;
+  void *visitVariableExpr(VariableExpr *expr) override;
+  void *visitUnaryExpr(UnaryExpr *expr) override;
+  void *visitBinaryExpr(BinaryExpr *expr) override;
+  void *visitMultiExpr(MultiExpr *expr) override;
+  void *visitGroupingExpr(GroupingExpr *expr) override;
+  void *visitCallExpr(CallExpr *expr) override;
+
+  // StmtVisitor implementation
+  void *visitExpressionStmt(ExpressionStmt *stmt) override;
+  void *visitCircuitDefStmt(CircuitDefStmt *stmt) override;
+  void *visitBitDefStmt(BitDefStmt *stmt) override;
+  void *visitBitVectorDefStmt(BitVectorDefStmt *stmt) override;
+  void *visitPrintStmt(PrintStmt *stmt) override;
+  void *visitReturnStmt(ReturnStmt *stmt) override;
+  void *visitTruthTableStmt(TruthTableStmt *stmt) override;
+  void *visitSimulateStmt(SimulateStmt *stmt) override;
+  void *visitBddStmt(BddStmt *stmt) override;
+  void *visitEquivStmt(EquivStmt *stmt) override;
+  void *visitMinimizeStmt(MinimizeStmt *stmt) override;
+  void *visitEmitCppStmt(EmitCppStmt *stmt) override;
+};
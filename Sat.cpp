@@ -0,0 +1,458 @@
+#include "Sat.h"
+
+#include <algorithm>
+
+namespace {
+
+// Element i (from 0) of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+size_t luby(size_t i) {
+  size_t size = 1;
+  size_t power = 0;
+  while (size < i + 1) {
+    power++;
+    size = 2 * size + 1;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    power--;
+    i %= size;
+  }
+  return size_t(1) << power;
+}
+
+} // namespace
+
+uint32_t SatSolver::newVariable() {
+  uint32_t var = assigns.size();
+  assigns.push_back(UNASSIGNED);
+  levels.push_back(0);
+  reasons.push_back(NO_CLAUSE);
+  phases.push_back(false);
+  activity.push_back(0);
+  heapIndex.push_back(-1);
+  seen.push_back(false);
+  watches.emplace_back();
+  watches.emplace_back();
+  heapInsert(var);
+  return var;
+}
+
+uint32_t SatSolver::storeClause(const std::vector<Literal> &clause,
+                                bool learnt, uint32_t lbd) {
+  clauses.push_back(
+      {uint32_t(literals.size()), uint32_t(clause.size()), lbd, learnt});
+  literals.insert(literals.end(), clause.begin(), clause.end());
+  return clauses.size() - 1;
+}
+
+void SatSolver::attach(uint32_t clause) {
+  const Literal *lits = &literals[clauses[clause].start];
+  watches[lits[0]].push_back({clause, lits[1]});
+  watches[lits[1]].push_back({clause, lits[0]});
+}
+
+bool SatSolver::addClause(std::vector<Literal> clause) {
+  if (!ok) {
+    return false;
+  }
+
+  // Literals fixed at level 0 are settled, and so are tautologies
+  std::sort(clause.begin(), clause.end());
+  size_t kept = 0;
+  for (size_t i = 0; i < clause.size(); i++) {
+    Literal literal = clause[i];
+    if (value(literal) == TRUE ||
+        (i > 0 && clause[i - 1] == negate(literal))) {
+      return true;
+    }
+    if (value(literal) == FALSE || (kept > 0 && clause[kept - 1] == literal)) {
+      continue;
+    }
+    clause[kept++] = literal;
+  }
+  clause.resize(kept);
+
+  if (clause.empty()) {
+    ok = false;
+  } else if (clause.size() == 1) {
+    assign(clause[0], NO_CLAUSE);
+    ok = propagate() == NO_CLAUSE;
+  } else {
+    attach(storeClause(clause, false, 0));
+    problemClauses++;
+  }
+  return ok;
+}
+
+void SatSolver::assign(Literal literal, uint32_t reason) {
+  uint32_t var = variableOf(literal);
+  assigns[var] = literal & 1 ? FALSE : TRUE;
+  levels[var] = decisionLevel();
+  reasons[var] = reason;
+  trail.push_back(literal);
+}
+
+// Propagates every unit clause. Returns a clause with all its literals
+// false, or NO_CLAUSE.
+uint32_t SatSolver::propagate() {
+  while (head < trail.size()) {
+    Literal falseLiteral = negate(trail[head++]);
+    std::vector<Watcher> &list = watches[falseLiteral];
+    stats.propagations++;
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < list.size()) {
+      Watcher watcher = list[i++];
+      if (value(watcher.blocker) == TRUE) {
+        list[j++] = watcher;
+        continue;
+      }
+
+      // Keep the false literal second
+      const Clause &clause = clauses[watcher.clause];
+      Literal *lits = &literals[clause.start];
+      if (lits[0] == falseLiteral) {
+        std::swap(lits[0], lits[1]);
+      }
+      Literal first = lits[0];
+      if (first != watcher.blocker && value(first) == TRUE) {
+        list[j++] = {watcher.clause, first};
+        continue;
+      }
+
+      // Move the watch to any literal that is not false
+      bool moved = false;
+      for (uint32_t k = 2; k < clause.size; k++) {
+        if (value(lits[k]) != FALSE) {
+          std::swap(lits[1], lits[k]);
+          watches[lits[1]].push_back({watcher.clause, first});
+          moved = true;
+          break;
+        }
+      }
+      if (moved) {
+        continue;
+      }
+
+      list[j++] = {watcher.clause, first};
+      if (value(first) == FALSE) {
+        while (i < list.size()) {
+          list[j++] = list[i++];
+        }
+        list.resize(j);
+        head = trail.size();
+        return watcher.clause;
+      }
+      assign(first, watcher.clause);
+    }
+    list.resize(j);
+  }
+  return NO_CLAUSE;
+}
+
+// Learns the first unique implication point of a conflict. learnt[0] is the
+// literal the clause asserts after backtracking to `backLevel`, and
+// learnt[1] is one assigned at that level, so both can be watched.
+void SatSolver::analyze(uint32_t conflict, std::vector<Literal> &learnt,
+                        uint32_t &backLevel, uint32_t &lbd) {
+  learnt.assign(1, NO_LITERAL);
+  size_t pending = 0; // Seen literals of the current level not yet resolved
+  Literal implied = NO_LITERAL;
+  size_t index = trail.size();
+
+  do {
+    const Clause &clause = clauses[conflict];
+    // A reason clause starts with the literal it implied
+    for (uint32_t k = implied == NO_LITERAL ? 0 : 1; k < clause.size; k++) {
+      Literal literal = literals[clause.start + k];
+      uint32_t var = variableOf(literal);
+      if (seen[var] || levels[var] == 0) {
+        continue;
+      }
+      seen[var] = true;
+      bump(var);
+      if (levels[var] == decisionLevel()) {
+        pending++;
+      } else {
+        learnt.push_back(literal);
+      }
+    }
+
+    while (!seen[variableOf(trail[--index])]) {
+    }
+    implied = trail[index];
+    conflict = reasons[variableOf(implied)];
+    seen[variableOf(implied)] = false;
+  } while (--pending > 0);
+  learnt[0] = negate(implied);
+
+  // Drop literals whose reason only has literals already in the clause
+  analyzed.assign(learnt.begin() + 1, learnt.end());
+  size_t kept = 1;
+  for (size_t i = 1; i < learnt.size(); i++) {
+    uint32_t reason = reasons[variableOf(learnt[i])];
+    bool redundant = reason != NO_CLAUSE;
+    if (redundant) {
+      const Clause &clause = clauses[reason];
+      for (uint32_t k = 1; k < clause.size; k++) {
+        uint32_t var = variableOf(literals[clause.start + k]);
+        if (!seen[var] && levels[var] > 0) {
+          redundant = false;
+          break;
+        }
+      }
+    }
+    if (!redundant) {
+      learnt[kept++] = learnt[i];
+    }
+  }
+  learnt.resize(kept);
+  for (Literal literal : analyzed) {
+    seen[variableOf(literal)] = false;
+  }
+
+  backLevel = 0;
+  for (size_t i = 1; i < learnt.size(); i++) {
+    uint32_t level = levels[variableOf(learnt[i])];
+    if (level > backLevel) {
+      backLevel = level;
+      std::swap(learnt[1], learnt[i]);
+    }
+  }
+
+  stamp++;
+  lbd = 0;
+  for (Literal literal : learnt) {
+    uint32_t level = levels[variableOf(literal)];
+    if (levelStamps[level] != stamp) {
+      levelStamps[level] = stamp;
+      lbd++;
+    }
+  }
+}
+
+void SatSolver::backtrack(uint32_t level) {
+  if (decisionLevel() <= level) {
+    return;
+  }
+  for (size_t i = trail.size(); i-- > trailLimits[level];) {
+    uint32_t var = variableOf(trail[i]);
+    phases[var] = assigns[var] == TRUE;
+    assigns[var] = UNASSIGNED;
+    reasons[var] = NO_CLAUSE;
+    if (heapIndex[var] < 0) {
+      heapInsert(var);
+    }
+  }
+  trail.resize(trailLimits[level]);
+  trailLimits.resize(level);
+  head = trail.size();
+}
+
+SatSolver::Literal SatSolver::pickBranch() {
+  while (!heap.empty()) {
+    uint32_t var = heapPop();
+    if (assigns[var] == UNASSIGNED) {
+      return phases[var] ? positive(var) : negative(var);
+    }
+  }
+  return NO_LITERAL;
+}
+
+// Searches until the clauses are solved or `conflictBudget` conflicts have
+// passed, then restarts from level 0
+SatSolver::Status SatSolver::search(size_t conflictBudget) {
+  std::vector<Literal> learnt;
+  size_t conflicts = 0;
+
+  for (;;) {
+    uint32_t conflict = propagate();
+    if (conflict != NO_CLAUSE) {
+      stats.conflicts++;
+      conflicts++;
+      if (decisionLevel() == 0) {
+        return Status::UNSATISFIABLE;
+      }
+
+      uint32_t backLevel;
+      uint32_t lbd;
+      analyze(conflict, learnt, backLevel, lbd);
+      backtrack(backLevel);
+      if (learnt.size() == 1) {
+        assign(learnt[0], NO_CLAUSE);
+      } else {
+        uint32_t clause = storeClause(learnt, true, lbd);
+        attach(clause);
+        assign(learnt[0], clause);
+        learntCount++;
+        stats.learntClauses++;
+      }
+      varIncrement /= VAR_DECAY;
+      continue;
+    }
+
+    if (conflicts >= conflictBudget) {
+      backtrack(0);
+      return Status::UNKNOWN;
+    }
+    if (learntCount >= maxLearnts) {
+      backtrack(0);
+      reduceLearnts();
+    }
+
+    Literal next = pickBranch();
+    if (next == NO_LITERAL) {
+      return Status::SATISFIABLE;
+    }
+    stats.decisions++;
+    trailLimits.push_back(trail.size());
+    assign(next, NO_CLAUSE);
+  }
+}
+
+// Deletes the learnt clauses with the most decision levels, keeping at
+// least half of them and every one that links only two levels. Runs at
+// level 0, where no reason clause is needed any more, so the remaining
+// clauses can be packed and renumbered.
+void SatSolver::reduceLearnts() {
+  std::vector<uint32_t> learnts;
+  for (uint32_t c = 0; c < clauses.size(); c++) {
+    if (clauses[c].learnt) {
+      learnts.push_back(c);
+    }
+  }
+  // Newer clauses win ties
+  std::stable_sort(learnts.begin(), learnts.end(),
+                   [&](uint32_t a, uint32_t b) {
+                     return clauses[a].lbd < clauses[b].lbd ||
+                            (clauses[a].lbd == clauses[b].lbd && a > b);
+                   });
+  std::vector<bool> deleted(clauses.size(), false);
+  for (size_t i = learnts.size() / 2; i < learnts.size(); i++) {
+    if (clauses[learnts[i]].lbd > 2) {
+      deleted[learnts[i]] = true;
+      learntCount--;
+      stats.deletedClauses++;
+    }
+  }
+
+  std::vector<Clause> packed;
+  std::vector<Literal> packedLiterals;
+  for (uint32_t c = 0; c < clauses.size(); c++) {
+    if (!deleted[c]) {
+      Clause clause = clauses[c];
+      auto first = literals.begin() + clause.start;
+      clause.start = packedLiterals.size();
+      packedLiterals.insert(packedLiterals.end(), first, first + clause.size);
+      packed.push_back(clause);
+    }
+  }
+  clauses.swap(packed);
+  literals.swap(packedLiterals);
+
+  for (std::vector<Watcher> &list : watches) {
+    list.clear();
+  }
+  for (uint32_t c = 0; c < clauses.size(); c++) {
+    attach(c);
+  }
+  for (Literal literal : trail) {
+    reasons[variableOf(literal)] = NO_CLAUSE;
+  }
+
+  maxLearnts += maxLearnts / 10;
+}
+
+SatSolver::Result SatSolver::solve() {
+  if (!ok) {
+    return Result::UNSATISFIABLE;
+  }
+  levelStamps.assign(variableCount() + 1, 0);
+  stamp = 0;
+
+  Status status = Status::UNKNOWN;
+  for (size_t restart = 0; status == Status::UNKNOWN; restart++) {
+    if (restart > 0) {
+      stats.restarts++;
+    }
+    status = search(luby(restart) * RESTART_UNIT);
+  }
+
+  if (status == Status::SATISFIABLE) {
+    model.resize(variableCount());
+    for (uint32_t var = 0; var < variableCount(); var++) {
+      model[var] = assigns[var] == TRUE;
+    }
+  } else {
+    ok = false;
+  }
+  backtrack(0);
+  return status == Status::SATISFIABLE ? Result::SATISFIABLE
+                                       : Result::UNSATISFIABLE;
+}
+
+void SatSolver::bump(uint32_t var) {
+  activity[var] += varIncrement;
+  if (activity[var] > 1e100) {
+    for (double &a : activity) {
+      a *= 1e-100;
+    }
+    varIncrement *= 1e-100;
+  }
+  if (heapIndex[var] >= 0) {
+    heapUp(heapIndex[var]);
+  }
+}
+
+void SatSolver::heapInsert(uint32_t var) {
+  heapIndex[var] = heap.size();
+  heap.push_back(var);
+  heapUp(heap.size() - 1);
+}
+
+void SatSolver::heapUp(size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!heapLess(parent, i)) {
+      break;
+    }
+    std::swap(heap[parent], heap[i]);
+    heapIndex[heap[parent]] = parent;
+    heapIndex[heap[i]] = i;
+    i = parent;
+  }
+}
+
+void SatSolver::heapDown(size_t i) {
+  for (;;) {
+    size_t largest = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < heap.size() && heapLess(largest, left)) {
+      largest = left;
+    }
+    if (right < heap.size() && heapLess(largest, right)) {
+      largest = right;
+    }
+    if (largest == i) {
+      break;
+    }
+    std::swap(heap[largest], heap[i]);
+    heapIndex[heap[largest]] = largest;
+    heapIndex[heap[i]] = i;
+    i = largest;
+  }
+}
+
+uint32_t SatSolver::heapPop() {
+  uint32_t top = heap[0];
+  heapIndex[top] = -1;
+  heap[0] = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    heapIndex[heap[0]] = 0;
+    heapDown(0);
+  }
+  return top;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Conflict-driven clause learning SAT solver.
+//
+// A literal is 2 * variable + negated. Every clause watches its first two
+// literals, and each watch remembers a blocker literal of the clause that,
+// while true, lets propagation skip the clause without touching it. On a
+// conflict the first unique implication point is learnt, with literals
+// implied by the rest of the clause removed, and the search jumps back to
+// the level where the learnt clause becomes unit.
+//
+// Decisions take the unassigned variable with the highest VSIDS activity,
+// which grows for the variables of recent conflicts, with the polarity it
+// last had. Searches restart on the Luby sequence, and learnt clauses are
+// thinned by their literal block distance whenever there are too many.
+class SatSolver {
+public:
+  using Literal = uint32_t;
+
+  static Literal positive(uint32_t var) { return var * 2; }
+  static Literal negative(uint32_t var) { return var * 2 + 1; }
+  static Literal negate(Literal literal) { return literal ^ 1; }
+  static uint32_t variableOf(Literal literal) { return literal >> 1; }
+
+  enum class Result { SATISFIABLE, UNSATISFIABLE };
+
+  struct Stats {
+    size_t decisions = 0;
+    size_t propagations = 0;
+    size_t conflicts = 0;
+    size_t restarts = 0;
+    size_t learntClauses = 0;
+    size_t deletedClauses = 0;
+  };
+
+private:
+  static constexpr uint32_t NO_CLAUSE = UINT32_MAX;
+  static constexpr Literal NO_LITERAL = UINT32_MAX;
+  static constexpr size_t RESTART_UNIT = 100;    // Conflicts
+  static constexpr size_t FIRST_REDUCTION = 2000; // Learnt clauses
+  static constexpr double VAR_DECAY = 0.95;
+
+  // Variable values, also used for literals once the sign is applied
+  static constexpr int8_t TRUE = 1;
+  static constexpr int8_t FALSE = -1;
+  static constexpr int8_t UNASSIGNED = 0;
+
+  struct Clause {
+    uint32_t start; // First literal in `literals`
+    uint32_t size;
+    uint32_t lbd; // Decision levels among the literals when learnt
+    bool learnt;
+  };
+
+  struct Watcher {
+    uint32_t clause;
+    Literal blocker;
+  };
+
+  enum class Status { SATISFIABLE, UNSATISFIABLE, UNKNOWN };
+
+  bool ok = true; // False once the clauses are known to be unsatisfiable
+  std::vector<Clause> clauses;
+  std::vector<Literal> literals;
+  std::vector<std::vector<Watcher>> watches; // By the literal they watch
+  size_t problemClauses = 0;
+  size_t learntCount = 0;
+  size_t maxLearnts = FIRST_REDUCTION;
+
+  // Per variable
+  std::vector<int8_t> assigns;
+  std::vector<uint32_t> levels;
+  std::vector<uint32_t> reasons; // Clause that implied it, or NO_CLAUSE
+  std::vector<bool> phases;      // Last value, tried first
+  std::vector<double> activity;
+  std::vector<bool> model;
+
+  std::vector<Literal> trail; // Assigned literals in assignment order
+  std::vector<size_t> trailLimits; // Start of each decision level
+  size_t head = 0;                 // Next trail literal to propagate
+  double varIncrement = 1;
+
+  // Unassigned variables by activity, a binary max-heap
+  std::vector<uint32_t> heap;
+  std::vector<int32_t> heapIndex; // -1 when not in the heap
+
+  // Scratch space of conflict analysis
+  std::vector<bool> seen;
+  std::vector<Literal> analyzed; // Literals whose variables are seen
+  std::vector<uint32_t> levelStamps;
+  uint32_t stamp = 0;
+
+  Stats stats;
+
+  int8_t value(Literal literal) const {
+    int8_t v = assigns[variableOf(literal)];
+    return literal & 1 ? -v : v;
+  }
+  uint32_t decisionLevel() const { return trailLimits.size(); }
+
+  uint32_t storeClause(const std::vector<Literal> &clause, bool learnt,
+                       uint32_t lbd);
+  void attach(uint32_t clause);
+  void assign(Literal literal, uint32_t reason);
+  uint32_t propagate();
+  void analyze(uint32_t conflict, std::vector<Literal> &learnt,
+               uint32_t &backLevel, uint32_t &lbd);
+  void backtrack(uint32_t level);
+  Literal pickBranch();
+  Status search(size_t conflictBudget);
+  void reduceLearnts();
+
+  void bump(uint32_t var);
+  bool heapLess(uint32_t a, uint32_t b) const {
+    return activity[heap[a]] < activity[heap[b]];
+  }
+  void heapInsert(uint32_t var);
+  void heapUp(size_t i);
+  void heapDown(size_t i);
+  uint32_t heapPop();
+
+public:
+  uint32_t newVariable();
+  size_t variableCount() const { return assigns.size(); }
+  size_t clauseCount() const { return problemClauses; }
+
+  // Adds a clause between calls to solve(). Returns false once the clauses
+  // can no longer be satisfied.
+  bool addClause(std::vector<Literal> clause);
+
+  Result solve();
+
+  // A variable's value in the assignment found by the last satisfiable solve
+  bool modelValue(uint32_t var) const { return model[var]; }
+
+  const Stats &statistics() const { return stats; }
+};
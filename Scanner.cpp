@@ -1,42 +1,181 @@
 #include "Scanner.h"
 
+#include <array>
+#include <iterator>
+
+namespace {
+
+// What each byte can start or continue. Identifiers are letters, '_', '0'
+// and '1'; every other byte without a class is an error.
+enum CharClass : uint8_t {
+  OTHER,
+  BLANK,     // ' ', '\r', '\t' and ';', which starts a one-character comment
+  NEWLINE,
+  LEFT_PAREN,
+  RIGHT_PAREN,
+  ZERO,
+  ONE,
+  LETTER,
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+  std::array<uint8_t, 256> classes{};
+  for (int c = 'a'; c <= 'z'; c++) {
+    classes[c] = LETTER;
+  }
+  for (int c = 'A'; c <= 'Z'; c++) {
+    classes[c] = LETTER;
+  }
+  classes['_'] = LETTER;
+  classes['0'] = ZERO;
+  classes['1'] = ONE;
+  classes[' '] = BLANK;
+  classes['\r'] = BLANK;
+  classes['\t'] = BLANK;
+  classes[';'] = BLANK;
+  classes['\n'] = NEWLINE;
+  classes['('] = LEFT_PAREN;
+  classes[')'] = RIGHT_PAREN;
+  return classes;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = makeCharClasses();
+
+CharClass classOf(char c) {
+  return static_cast<CharClass>(CHAR_CLASSES[static_cast<unsigned char>(c)]);
+}
+
+bool isIdentifierChar(char c) { return classOf(c) >= ZERO; }
+
+struct Keyword {
+  const char *spelling;
+  TokenType type;
+};
+
+const Keyword KEYWORDS[] = {
+    {"not", TokenType::NOT},          {"and", TokenType::AND},
+    {"nand", TokenType::NAND},        {"or", TokenType::OR},
+    {"nor", TokenType::NOR},          {"xor", TokenType::XOR},
+    {"xnor", TokenType::XNOR},        {"false", TokenType::FALSE},
+    {"False", TokenType::FALSE},      {"print", TokenType::PRINT},
+    {"return", TokenType::RETURN},    {"circuit", TokenType::CIRCUIT},
+    {"truth_table", TokenType::TRUTH_TABLE},
+    {"true", TokenType::TRUE},        {"True", TokenType::TRUE},
+    {"bit", TokenType::BIT},          {"bit_vector", TokenType::BIT_VECTOR},
+    {"register", TokenType::REGISTER}, {"simulate", TokenType::SIMULATE},
+    {"bdd", TokenType::BDD},          {"equiv", TokenType::EQUIV},
+    {"minimize", TokenType::MINIMIZE},
+};
+
+constexpr int NOT_KEYWORD = -1;
+
+// Index into KEYWORDS of a spelling, or NOT_KEYWORD. The length and first
+// character (and one more for not/nor and bit/bdd) narrow every keyword down
+// to a single candidate, so this is a perfect hash with one comparison.
+int keywordIndex(std::string_view text) {
+  int candidate = NOT_KEYWORD;
+  switch (text.size()) {
+  case 2:
+    candidate = 3; // or
+    break;
+  case 3:
+    switch (text[0]) {
+    case 'n':
+      // not and nor share their length and first letter
+      candidate = text[2] == 't' ? 0 : 4;
+      break;
+    case 'a': candidate = 1; break;  // and
+    case 'x': candidate = 5; break;  // xor
+    case 'b':
+      // bit and bdd share their length and first letter
+      candidate = text[1] == 'i' ? 15 : 19;
+      break;
+    }
+    break;
+  case 4:
+    switch (text[0]) {
+    case 'n': candidate = 2; break;  // nand
+    case 'x': candidate = 6; break;  // xnor
+    case 't': candidate = 13; break; // true
+    case 'T': candidate = 14; break; // True
+    }
+    break;
+  case 5:
+    switch (text[0]) {
+    case 'f': candidate = 7; break;  // false
+    case 'F': candidate = 8; break;  // False
+    case 'p': candidate = 9; break;  // print
+    case 'e': candidate = 20; break; // equiv
+    }
+    break;
+  case 6:
+    candidate = 10; // return
+    break;
+  case 7:
+    candidate = 11; // circuit
+    break;
+  case 8:
+    switch (text[0]) {
+    case 'r': candidate = 17; break; // register
+    case 's': candidate = 18; break; // simulate
+    case 'm': candidate = 21; break; // minimize
+    }
+    break;
+  case 10:
+    candidate = 16; // bit_vector
+    break;
+  case 11:
+    candidate = 12; // truth_table
+    break;
+  }
+
+  if (candidate != NOT_KEYWORD && text == KEYWORDS[candidate].spelling) {
+    return candidate;
+  }
+  return NOT_KEYWORD;
+}
+
+} // namespace
+
 bool Scanner::isAtEnd() { return this->current >= this->end; }
 
-std::vector<std::shared_ptr<Token>> Scanner::scanTokens() {
+TokenStream Scanner::scanTokens() {
+  // Tokens average about four bytes of source each, parentheses and blanks
+  // included, so reserving one per four bytes rarely regrows and costs about
+  // three times the source size at most
+  tokens.tokens.reserve(this->source.size() / 4 + 1);
   while (!isAtEnd()) {
     start = current;
     scanToken();
   }
 
-  this->tokens.push_back(
-      std::make_shared<Token>(TokenType::ENDOFFILE, "", literal{}, line));
+  addToken(TokenType::ENDOFFILE, Interner::global().intern(""));
   return std::move(this->tokens);
 }
 
-bool Scanner::isDigit(char c) { return '0' == c || c == '1'; }
-bool Scanner::isAlpha(char c) {
-  return 'a' <= c && c <= 'z' || 'A' <= c && c <= 'Z' || c == '_';
+void Scanner::addToken(TokenType type, uint32_t value) {
+  this->tokens.tokens.push_back({type, line, value});
 }
 
-bool Scanner::isAldigit(char c) { return isAlpha(c) || isDigit(c); }
+std::string_view Scanner::lexeme() const {
+  return this->source.substr(this->start, this->current - this->start);
+}
 
 void Scanner::handleIdentifier() {
-  while (!isAtEnd() && isAldigit(peek())) {
+  while (!isAtEnd() && isIdentifierChar(this->source[this->current])) {
     this->current++;
   }
 
-  std::string tmp =
-      this->source.substr(this->start, this->current - this->start);
-
-  auto iter = this->keyword_table.find(tmp);
-  if (iter != this->keyword_table.end()) {
-    iter->second.updateLine(this->line);
+  std::string_view text = lexeme();
 
-    this->tokens.push_back(std::make_shared<Token>(iter->second.type, tmp,
-                                                   iter->second.lit, line));
+  int keyword = keywordIndex(text);
+  if (keyword == NOT_KEYWORD) {
+    addToken(TokenType::IDENTIFIER, Interner::global().intern(text));
+  } else if (KEYWORDS[keyword].type == TokenType::BIT_VECTOR) {
+    // Shares its type with bit vector literals, so it needs a literal too
+    addToken(TokenType::BIT_VECTOR, TokenStream::EMPTY_LITERAL);
   } else {
-    this->tokens.push_back(
-        std::make_shared<Token>(TokenType::IDENTIFIER, tmp, literal{}, line));
+    addToken(KEYWORDS[keyword].type, keywordSymbols[keyword]);
   }
 }
 
@@ -47,35 +186,25 @@ void Scanner::handleBitLiteral() {
     advance(); // Skip 'b'
   }
 
-  std::vector<bool> bits;
-  // Read all 0s and 1s
+  // Create the token, reading all 0s and 1s
+  literal lit;
+  lit.is_bitvector = true;
   while (!isAtEnd() && (peek() == '0' || peek() == '1')) {
     char bit = advance();
-    bits.push_back(bit == '1');
+    lit.pushBit(bit == '1');
   }
 
-  // Create the token
-  literal lit;
-  lit.is_bitvector = true;
-  lit.bits = bits;
-
-  // If it's a single bit, we can also set the boolean value
-  if (bits.size() == 1) {
-    lit.boolean = bits[0];
-    this->tokens.push_back(std::make_shared<Token>(
-        TokenType::BOOL,
-        this->source.substr(this->start, this->current - this->start), lit,
-        line));
-  } else {
-    this->tokens.push_back(std::make_shared<Token>(
-        TokenType::BIT_VECTOR,
-        this->source.substr(this->start, this->current - this->start), lit,
-        line));
-  }
+  uint32_t index = this->tokens.literals.size();
+  this->tokens.literals.push_back(
+      {std::move(lit), Interner::global().intern(lexeme())});
+  addToken(this->tokens.literals[index].value.size() == 1
+               ? TokenType::BOOL
+               : TokenType::BIT_VECTOR,
+           index);
 }
 
 char Scanner::peek() {
-  if (this->current > this->source.length())
+  if (this->current >= this->source.length())
     return '\0';
 
   return this->source[this->current];
@@ -101,109 +230,53 @@ char Scanner::advance() { return this->source[this->current++]; }
 
 void Scanner::scanToken() {
   char c = advance();
-  switch (c) {
-  case '(':
-    this->tokens.push_back(
-        std::make_shared<Token>(TokenType::LEFT_PAREN, "(", literal{}, line));
-    break;
-  case ')':
-    this->tokens.push_back(
-        std::make_shared<Token>(TokenType::RIGHT_PAREN, ")", literal{}, line));
+  switch (classOf(c)) {
+  case LEFT_PAREN:
+    addToken(TokenType::LEFT_PAREN, leftParen);
     break;
-  case ' ':
-  case '\r':
-  case '\t':
-    // Ignore whitespace
+  case RIGHT_PAREN:
+    addToken(TokenType::RIGHT_PAREN, rightParen);
     break;
-  case ';':
-    // Ignore comments ;
+  case BLANK:
+    // Ignore whitespace and comments, a whole run at a time
+    while (!isAtEnd() && classOf(this->source[this->current]) == BLANK) {
+      this->current++;
+    }
     break;
-  case '\n':
+  case NEWLINE:
     line++; // Increment line number
     break;
-  case '0':
+  case ZERO:
     if (peek() == 'b') {
       current--; // Move back to include the '0' in the token
       handleBitLiteral();
     } else {
-      literal lit;
-      lit.boolean = false;
-      lit.is_bitvector = true;
-      lit.bits = {false};
-      this->tokens.push_back(
-          std::make_shared<Token>(TokenType::BOOL, "0", lit, line));
+      addToken(TokenType::BOOL, TokenStream::FALSE_LITERAL);
     }
     break;
-  case '1': {
+  case ONE:
     // Just a single '1'
-    literal lit;
-    lit.boolean = true;
-    lit.is_bitvector = true;
-    lit.bits = {true};
-    this->tokens.push_back(
-        std::make_shared<Token>(TokenType::BOOL, "1", lit, line));
+    addToken(TokenType::BOOL, TokenStream::TRUE_LITERAL);
+    break;
+  case LETTER:
+    handleIdentifier();
     break;
-  }
   default:
-    if (isAlpha(c)) {
-      handleIdentifier();
-      break;
-    }
     std::cout << "Error: Unexpected character '" << c << "' at line " << line
               << std::endl;
     break;
   }
 }
 
-Scanner::Scanner(std::string source)
-    : source(source), start(0), current(0), line(1) {
-  this->end = source.length();
-
-  this->keyword_table.insert(
-      std::make_pair("not", Token(TokenType::NOT, "not", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("and", Token(TokenType::AND, "and", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("nand", Token(TokenType::NAND, "nand", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("or", Token(TokenType::OR, "or", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("nor", Token(TokenType::NOR, "nor", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("xor", Token(TokenType::XOR, "xor", literal{}, 0)));
-  this->keyword_table.insert(
-      std::make_pair("xnor", Token(TokenType::XNOR, "xnor", literal{}, 0)));
-
-  literal lit{};
-  lit.boolean = false;
-  lit.is_bitvector = true;
-  lit.bits = {false};
-  this->keyword_table.insert(
-      std::make_pair("0", Token(TokenType::BOOL, "0", lit, 0)));
-  this->keyword_table.insert(
-      std::make_pair("false", Token(TokenType::FALSE, "false", lit, 0)));
-  this->keyword_table.insert(
-      std::make_pair("False", Token(TokenType::FALSE, "False", lit, 0)));
-
-  this->keyword_table.insert(
-      std::make_pair("print", Token(TokenType::PRINT, "print", literal{}, 0)));
-  this->keyword_table.insert(std::make_pair(
-      "return", Token(TokenType::RETURN, "return", literal{}, 0)));
-  this->keyword_table.insert(std::make_pair(
-      "circuit", Token(TokenType::CIRCUIT, "circuit", literal{}, 0)));
-
-  lit.boolean = true;
-  lit.is_bitvector = true;
-  lit.bits = {true};
-  this->keyword_table.insert(
-      std::make_pair("1", Token(TokenType::BOOL, "1", lit, 0)));
-  this->keyword_table.insert(
-      std::make_pair("true", Token(TokenType::TRUE, "true", lit, 0)));
-  this->keyword_table.insert(
-      std::make_pair("True", Token(TokenType::TRUE, "True", lit, 0)));
-
-  this->keyword_table.insert(
-      std::make_pair("bit", Token(TokenType::BIT, "bit", literal{}, 0)));
-  this->keyword_table.insert(std::make_pair(
-      "bit_vector", Token(TokenType::BIT_VECTOR, "bit_vector", literal{}, 0)));
+Scanner::Scanner(std::string_view source, int line)
+    : source(source), start(0), current(0), line(line) {
+  this->end = this->source.length();
+
+  static_assert(std::size(KEYWORDS) == KEYWORD_COUNT);
+  Interner &interner = Interner::global();
+  leftParen = interner.intern("(");
+  rightParen = interner.intern(")");
+  for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+    keywordSymbols[i] = interner.intern(KEYWORDS[i].spelling);
+  }
 }
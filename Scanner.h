@@ -1,36 +1,38 @@
 #pragma once
 
-#include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <map>
-#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include "Token.h"
 
 class Scanner {
 private:
-  std::string source;
-  std::vector<std::shared_ptr<Token>> tokens;
-  std::map<std::string, Token> keyword_table;
-  int start, end, current, line;
+  std::string_view source; // Not owned, must outlive the scanner
+  TokenStream tokens;
+  size_t start, end, current;
+  int line;
+
+  // Interned spellings of punctuation and keywords
+  static constexpr size_t KEYWORD_COUNT = 22;
+  uint32_t leftParen, rightParen;
+  uint32_t keywordSymbols[KEYWORD_COUNT];
 
   bool isAtEnd();
   bool match(char c);
-  bool isDigit(char c);
   char peek();
   char peekNext();
-  bool isAlpha(char c);
-  bool isAldigit(char c);
   void handleIdentifier();
   void handleBitLiteral();
   void scanToken();
   char advance();
-  void addToken(TokenType type);
-  void addToken(TokenType type, literal lit);
+  void addToken(TokenType type, uint32_t value);
+  std::string_view lexeme() const;
 
 public:
-  std::vector<std::shared_ptr<Token>> scanTokens();
-  Scanner(std::string source);
+  TokenStream scanTokens();
+  // `line` is the line the source starts on, for scripts read in pieces
+  Scanner(std::string_view source, int line = 1);
 };
@@ -0,0 +1,56 @@
+#include "Session.h"
+
+#include "HashConser.h"
+#include "Parser.h"
+#include "Scanner.h"
+#include "Utils.h"
+
+Session::Session(const Options &opt) : opt(opt) {
+  evaluator.setMemoConfig(opt.getMemoConfig());
+  vm.setDebugMode(opt.isDebugMode());
+  evaluator.setSimulationMode(opt.getSimulationMode());
+  vm.setSimulationMode(opt.getSimulationMode());
+}
+
+bool Session::execute(const std::vector<Stmt *> &statements) {
+  return opt.getEngine() == Engine::VM ? vm.interpret(statements)
+                                       : evaluator.evaluate(statements);
+}
+
+bool Session::run(std::string_view source, int line) {
+  Scanner scanner(source, line);
+  auto tokens = scanner.scanTokens();
+
+  if (opt.isDebugMode()) {
+    printTokenStream(tokens);
+  }
+
+  auto arena = std::make_unique<Arena>();
+  Parser parser(tokens, *arena);
+  auto statements = parser.parse();
+  if (statements.empty()) {
+    return true;
+  }
+
+  if (opt.isDebugMode()) {
+    printParseResults(statements);
+  }
+
+  // Constant folding needs the whole program, so only hash-consing runs
+  HashConser conser;
+  auto merged = conser.run(statements);
+
+  if (opt.isDebugMode() && !merged.empty()) {
+    printHashConsResults(merged);
+  }
+
+  bool ok = execute(statements);
+
+  for (Stmt *stmt : statements) {
+    if (dynamic_cast<CircuitDefStmt *>(stmt)) {
+      circuitArenas.push_back(std::move(arena));
+      break;
+    }
+  }
+  return ok;
+}
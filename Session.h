@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Arena.h"
+#include "Evaluator.h"
+#include "Options.h"
+#include "VM.h"
+
+// Interpreter state that outlives a single statement: the engines with their
+// globals, memo caches and compiled circuits, and the syntax trees of the
+// circuits they can call.
+//
+// The prompt and streamed scripts feed a session one piece of source at a
+// time. Only the new statements are parsed and compiled; everything defined
+// before is reused as it is.
+class Session {
+private:
+  const Options &opt;
+
+  // The engines keep pointers to circuit definitions, so the arenas of
+  // statements that define circuits are kept; every other statement is freed
+  // as soon as it has run
+  std::vector<std::unique_ptr<Arena>> circuitArenas;
+
+  Evaluator evaluator;
+  VM vm;
+
+public:
+  explicit Session(const Options &opt);
+
+  // Runs source whose first line is `line`. Returns false if a statement
+  // failed; the session stays usable either way.
+  bool run(std::string_view source, int line = 1);
+
+  // Runs statements that were not parsed from source, such as the ones the
+  // command line asks for. Returns false if one failed.
+  bool execute(const std::vector<Stmt *> &statements);
+
+  std::vector<MemoCache::Stats> memoStats() const {
+    return evaluator.memoStats();
+  }
+};
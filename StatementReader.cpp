@@ -0,0 +1,73 @@
+#include "StatementReader.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+StatementReader::~StatementReader() {
+  if (ownsFd) {
+    close(fd);
+  }
+}
+
+bool StatementReader::open(const std::string &fileName) {
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  ownsFd = fd >= 0;
+  return ownsFd;
+}
+
+void StatementReader::openStdin() { fd = STDIN_FILENO; }
+
+// Drops the forms already handed out and appends the next chunk. Returns
+// false at end of input.
+bool StatementReader::fill() {
+  buffer.erase(0, start);
+  scanned -= start;
+  start = 0;
+
+  size_t size = buffer.size();
+  buffer.resize(size + CHUNK_SIZE);
+  ssize_t count;
+  do {
+    count = read(fd, &buffer[size], CHUNK_SIZE);
+  } while (count < 0 && errno == EINTR);
+  buffer.resize(size + (count > 0 ? count : 0));
+  return count > 0;
+}
+
+bool StatementReader::next(std::string_view &form, int &line) {
+  while (true) {
+    for (; scanned < buffer.size(); scanned++) {
+      char c = buffer[scanned];
+      if (c == '\n') {
+        scanLine++;
+      } else if (c == '(') {
+        depth++;
+      } else if (c == ')' && depth > 0 && --depth == 0) {
+        // Stray closing parentheses stay with the text around them
+        scanned++;
+        form = std::string_view(buffer).substr(start, scanned - start);
+        line = startLine;
+        start = scanned;
+        startLine = scanLine;
+        return true;
+      }
+    }
+
+    if (atEnd || !fill()) {
+      atEnd = true;
+      break;
+    }
+  }
+
+  // Whatever is left is an unfinished form, or blanks after the last one
+  std::string_view rest = std::string_view(buffer).substr(start);
+  start = buffer.size();
+  if (rest.find_first_not_of(" \t\r\n;") == std::string_view::npos) {
+    return false;
+  }
+  form = rest;
+  line = startLine;
+  return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Reads a script from a file or stdin a chunk at a time and splits it into
+// top-level forms, so each statement can be parsed and run before the next
+// one is read. Only the form being assembled is kept in memory.
+//
+// Forms are found by counting parentheses. The language has no strings and
+// its only comments are single ';' characters, so a parenthesis always
+// opens or closes a form.
+class StatementReader {
+private:
+  int fd = -1;
+  bool ownsFd = false;
+  bool atEnd = false;
+
+  std::string buffer;
+  size_t start = 0;   // Start of the form being assembled
+  size_t scanned = 0; // Bytes whose parentheses have been counted
+  int depth = 0;
+  int startLine = 1; // Line of `start`
+  int scanLine = 1;  // Line of `scanned`
+
+  bool fill();
+
+public:
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  StatementReader() = default;
+  ~StatementReader();
+
+  StatementReader(const StatementReader &) = delete;
+  StatementReader &operator=(const StatementReader &) = delete;
+
+  // Returns false if the file cannot be opened
+  bool open(const std::string &fileName);
+  void openStdin();
+
+  // Sets `form` to the next top-level form, including the text between it
+  // and the previous one, and `line` to the line that text starts on. The
+  // view stays valid until the next call. Returns false at end of input.
+  bool next(std::string_view &form, int &line);
+};
@@ -15,6 +15,12 @@ class BitDefStmt;
 class BitVectorDefStmt;
 class PrintStmt;
 class ReturnStmt;
+class TruthTableStmt;
+class SimulateStmt;
+class BddStmt;
+class EquivStmt;
+class MinimizeStmt;
+class EmitCppStmt;
 
 // Visitor pattern for statements
 class StmtVisitor {
@@ -27,39 +33,65 @@ public:
   virtual void *visitBitVectorDefStmt(BitVectorDefStmt *stmt) = 0;
   virtual void *visitPrintStmt(PrintStmt *stmt) = 0;
   virtual void *visitReturnStmt(ReturnStmt *stmt) = 0;
+  virtual void *visitTruthTableStmt(TruthTableStmt *stmt) = 0;
+  virtual void *visitSimulateStmt(SimulateStmt *stmt) = 0;
+  virtual void *visitBddStmt(BddStmt *stmt) = 0;
+  virtual void *visitEquivStmt(EquivStmt *stmt) = 0;
+  virtual void *visitMinimizeStmt(MinimizeStmt *stmt) = 0;
+  virtual void *visitEmitCppStmt(EmitCppStmt *stmt) = 0;
 };
 
 // Base statement class
 class Stmt {
 public:
-  virtual ~Stmt() = default;
   virtual void *accept(StmtVisitor *visitor) = 0;
+
+protected:
+  // Nodes live in an Arena and are never deleted through a base pointer
+  ~Stmt() = default;
 };
 
 // Expression statement (just an expression)
 class ExpressionStmt : public Stmt {
 public:
-  std::shared_ptr<Expr> expression;
+  Expr *expression;
 
-  ExpressionStmt(std::shared_ptr<Expr> expression) : expression(expression) {}
+  ExpressionStmt(Expr *expression) : expression(expression) {}
 
   void *accept(StmtVisitor *visitor) override {
     return visitor->visitExpressionStmt(this);
   }
 };
 
+// Register declared in a circuit body: a bit of state that starts out as
+// `initial` and takes the value of `next` at every clock edge. Both are
+// evaluated in the circuit, where the register's name reads its state.
+struct Register {
+  const Token *name;
+  Expr *initial;
+  Expr *next;
+};
+
 // Circuit definition statement
 class CircuitDefStmt : public Stmt {
 public:
-  std::shared_ptr<Token> name;
-  std::vector<std::shared_ptr<Token>> parameters; // Added parameters vector
-  std::vector<std::shared_ptr<Expr>> body;
-
-  CircuitDefStmt(
-      std::shared_ptr<Token> name,
-      std::vector<std::shared_ptr<Token>> parameters, // Added parameters
-      std::vector<std::shared_ptr<Expr>> body)
-      : name(name), parameters(parameters), body(body) {}
+  const Token *name;
+  ArenaList<const Token *> parameters; // Added parameters vector
+  ArenaList<Expr *> body;
+  ArenaList<Register> registers; // Only simulation can run these circuits
+  uint32_t sharedCount = 0; // Number of shared body nodes (see Expr)
+
+  // Filled in by the Resolver: the circuit slot of the name, and the value
+  // slot of each parameter's name, which callees that read a name they do
+  // not bind themselves look for in the frames of their callers
+  uint32_t slot = Expr::NO_SLOT;
+  std::vector<uint32_t> parameterSlots;
+
+  CircuitDefStmt(const Token *name,
+                 ArenaList<const Token *> parameters, // Added parameters
+                 ArenaList<Expr *> body,
+                 ArenaList<Register> registers = ArenaList<Register>())
+      : name(name), parameters(parameters), body(body), registers(registers) {}
 
   void *accept(StmtVisitor *visitor) override {
     return visitor->visitCircuitDefStmt(this);
@@ -69,10 +101,11 @@ public:
 // Bit definition statement
 class BitDefStmt : public Stmt {
 public:
-  std::shared_ptr<Token> name;
-  std::shared_ptr<Expr> initializer;
+  const Token *name;
+  Expr *initializer;
+  uint32_t slot = Expr::NO_SLOT; // Filled in by the Resolver
 
-  BitDefStmt(std::shared_ptr<Token> name, std::shared_ptr<Expr> initializer)
+  BitDefStmt(const Token *name, Expr *initializer)
       : name(name), initializer(initializer) {}
 
   void *accept(StmtVisitor *visitor) override {
@@ -83,11 +116,11 @@ public:
 // Bit vector definition statement
 class BitVectorDefStmt : public Stmt {
 public:
-  std::shared_ptr<Token> name;
-  std::vector<std::shared_ptr<Expr>> values;
+  const Token *name;
+  ArenaList<Expr *> values;
+  uint32_t slot = Expr::NO_SLOT; // Filled in by the Resolver
 
-  BitVectorDefStmt(std::shared_ptr<Token> name,
-                   std::vector<std::shared_ptr<Expr>> values)
+  BitVectorDefStmt(const Token *name, ArenaList<Expr *> values)
       : name(name), values(values) {}
 
   void *accept(StmtVisitor *visitor) override {
@@ -98,9 +131,9 @@ public:
 // Print statement
 class PrintStmt : public Stmt {
 public:
-  std::shared_ptr<Expr> expression;
+  Expr *expression;
 
-  PrintStmt(std::shared_ptr<Expr> expression) : expression(expression) {}
+  PrintStmt(Expr *expression) : expression(expression) {}
 
   void *accept(StmtVisitor *visitor) override {
     return visitor->visitPrintStmt(this);
@@ -110,11 +143,100 @@ public:
 // Return statement
 class ReturnStmt : public Stmt {
 public:
-  std::shared_ptr<Expr> value;
+  Expr *value;
 
-  ReturnStmt(std::shared_ptr<Expr> value) : value(value) {}
+  ReturnStmt(Expr *value) : value(value) {}
 
   void *accept(StmtVisitor *visitor) override {
     return visitor->visitReturnStmt(this);
   }
 };
+
+// Truth table statement: enumerates every input combination of a circuit
+class TruthTableStmt : public Stmt {
+public:
+  const Token *circuit;
+  bool bitmap; // Packed words instead of text rows
+
+  TruthTableStmt(const Token *circuit, bool bitmap = false)
+      : circuit(circuit), bitmap(bitmap) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitTruthTableStmt(this);
+  }
+};
+
+// Simulation statement. `(simulate CIRCUIT cycles)` clocks a circuit for a
+// number of cycles; the command line's --simulate runs a circuit on every
+// input vector of a file instead.
+class SimulateStmt : public Stmt {
+public:
+  const Token *circuit;
+  uint64_t cycles = 0;
+  std::string vectors; // File name, "-" for stdin, or empty to run `cycles`
+  bool bitmap = false; // Packed words instead of text lines
+  size_t jobs = 1;     // Threads to simulate on, 0 for one per core
+
+  SimulateStmt(const Token *circuit, uint64_t cycles)
+      : circuit(circuit), cycles(cycles) {}
+  SimulateStmt(const Token *circuit, std::string vectors, bool bitmap,
+               size_t jobs)
+      : circuit(circuit), vectors(std::move(vectors)), bitmap(bitmap),
+        jobs(jobs) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitSimulateStmt(this);
+  }
+};
+
+// BDD statement: builds the binary decision diagram of each circuit output
+class BddStmt : public Stmt {
+public:
+  const Token *circuit;
+
+  BddStmt(const Token *circuit) : circuit(circuit) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitBddStmt(this);
+  }
+};
+
+// Equivalence statement: proves two circuits equal or finds an input vector
+// on which they differ
+class EquivStmt : public Stmt {
+public:
+  const Token *first;
+  const Token *second;
+
+  EquivStmt(const Token *first, const Token *second)
+      : first(first), second(second) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitEquivStmt(this);
+  }
+};
+
+// Minimize statement: writes a circuit back as minimized sums of products
+class MinimizeStmt : public Stmt {
+public:
+  const Token *circuit;
+
+  MinimizeStmt(const Token *circuit) : circuit(circuit) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitMinimizeStmt(this);
+  }
+};
+
+// Emit statement, made by the command line's --emit-cpp: writes a circuit as
+// a bit-sliced C++ function
+class EmitCppStmt : public Stmt {
+public:
+  const Token *circuit;
+
+  EmitCppStmt(const Token *circuit) : circuit(circuit) {}
+
+  void *accept(StmtVisitor *visitor) override {
+    return visitor->visitEmitCppStmt(this);
+  }
+};
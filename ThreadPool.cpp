@@ -0,0 +1,116 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < threadCount; i++) {
+    workers.push_back(std::make_unique<Worker>());
+  }
+  for (size_t i = 0; i < threadCount; i++) {
+    threads.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stopping = true;
+  }
+  workAvailable.notify_all();
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  // Spread external submissions round-robin over the worker deques
+  size_t worker = nextWorker++ % workers.size();
+  {
+    std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+    workers[worker]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    queued++;
+    pending++;
+  }
+  workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(stateMutex);
+  allDone.wait(lock, [this] { return pending == 0; });
+
+  if (failure) {
+    std::exception_ptr error = failure;
+    failure = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+bool ThreadPool::popLocal(size_t worker, Task &task) {
+  Worker &self = *workers[worker];
+  std::lock_guard<std::mutex> lock(self.mutex);
+  if (self.tasks.empty()) {
+    return false;
+  }
+
+  task = std::move(self.tasks.back());
+  self.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal(size_t worker, Task &task) {
+  for (size_t i = 1; i < workers.size(); i++) {
+    Worker &victim = *workers[(worker + i) % workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(stateMutex);
+      workAvailable.wait(lock, [this] { return stopping || queued > 0; });
+      if (stopping && queued == 0) {
+        return;
+      }
+    }
+
+    Task task;
+    if (!popLocal(worker, task) && !steal(worker, task)) {
+      // Another worker got there first
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      queued--;
+    }
+
+    try {
+      task(worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(stateMutex);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (--pending == 0) {
+      allDone.notify_all();
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with one task deque per worker. A worker
+// pops its own newest task first and, when its deque runs dry, steals the
+// oldest task from another worker, so uneven chunks still keep every core
+// busy. Tasks receive the index of the worker running them, which callers
+// use to keep per-worker scratch state.
+class ThreadPool {
+public:
+  using Task = std::function<void(size_t worker)>;
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+
+  std::mutex stateMutex;
+  std::condition_variable workAvailable;
+  std::condition_variable allDone;
+  size_t queued = 0;  // Tasks sitting in some deque
+  size_t pending = 0; // Tasks submitted and not yet finished
+  bool stopping = false;
+  std::exception_ptr failure;
+
+  std::atomic<size_t> nextWorker{0};
+
+  bool popLocal(size_t worker, Task &task);
+  bool steal(size_t worker, Task &task);
+  void workerLoop(size_t worker);
+
+public:
+  // threads == 0 uses one thread per hardware thread
+  explicit ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return workers.size(); }
+
+  void submit(Task task);
+
+  // Blocks until every submitted task has finished, then rethrows the first
+  // exception a task threw, if any
+  void wait();
+};
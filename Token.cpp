@@ -1,7 +1,117 @@
 #include "Token.h"
 
-Token::Token(TokenType type, std::string lexeme, literal lit, int line)
-    : type(type), lexeme(std::move(lexeme)), lit(std::move(lit)), line(line) {}
+literal literal::fromBit(bool value) {
+  literal lit;
+  lit.is_bitvector = true;
+  lit.width = 1;
+  lit.words.assign(1, value ? 1 : 0);
+  return lit;
+}
+
+literal literal::filled(size_t width, bool value) {
+  literal lit;
+  lit.is_bitvector = true;
+  lit.width = width;
+  lit.words.assign((width + WORD_BITS - 1) / WORD_BITS, value ? ~0ULL : 0);
+  lit.maskTail();
+  return lit;
+}
+
+void literal::setBit(size_t i, bool value) {
+  uint64_t mask = 1ULL << (i % WORD_BITS);
+  if (value) {
+    words[i / WORD_BITS] |= mask;
+  } else {
+    words[i / WORD_BITS] &= ~mask;
+  }
+}
+
+void literal::pushBit(bool value) {
+  if (width % WORD_BITS == 0) {
+    words.push_back(0);
+  }
+  width++;
+  setBit(width - 1, value);
+}
+
+void literal::append(const literal &other) {
+  size_t shift = width % WORD_BITS;
+  size_t oldWidth = width;
+  resize(width + other.width);
+
+  if (shift == 0) {
+    // Word aligned, copy the words straight across
+    for (size_t i = 0; i < other.words.size(); i++) {
+      words[oldWidth / WORD_BITS + i] = other.words[i];
+    }
+    return;
+  }
+
+  size_t base = oldWidth / WORD_BITS;
+  for (size_t i = 0; i < other.words.size(); i++) {
+    words[base + i] |= other.words[i] << shift;
+    if (base + i + 1 < words.size()) {
+      words[base + i + 1] |= other.words[i] >> (WORD_BITS - shift);
+    }
+  }
+}
+
+void literal::resize(size_t newWidth) {
+  width = newWidth;
+  words.resize((newWidth + WORD_BITS - 1) / WORD_BITS, 0);
+  maskTail();
+}
+
+void literal::maskTail() {
+  size_t tail = width % WORD_BITS;
+  if (tail != 0 && !words.empty()) {
+    words.back() &= (1ULL << tail) - 1;
+  }
+}
+
+Token::Token(TokenType type, const std::string &lexeme, int line)
+    : type(type), lexeme(lexeme), line(line) {}
+
+Interner &Interner::global() {
+  static Interner interner;
+  return interner;
+}
+
+uint32_t Interner::intern(std::string_view text) {
+  auto found = ids.find(text);
+  if (found != ids.end()) {
+    return found->second;
+  }
+
+  uint32_t id = texts.size();
+  texts.emplace_back(text);
+  ids.emplace(texts.back(), id);
+  return id;
+}
+
+TokenStream::TokenStream() {
+  Interner &interner = Interner::global();
+  literals.push_back({literal::fromBit(false), interner.intern("0")});
+  literals.push_back({literal::fromBit(true), interner.intern("1")});
+  literals.push_back({literal{}, interner.intern("bit_vector")});
+}
+
+const std::string &TokenStream::lexeme(size_t i) const {
+  const Entry &entry = tokens[i];
+  uint32_t id = hasLiteral(entry.type) ? literals[entry.value].lexeme
+                                       : entry.value;
+  return Interner::global().text(id);
+}
+
+const literal &TokenStream::value(size_t i) const {
+  static const literal none;
+  const Entry &entry = tokens[i];
+  return hasLiteral(entry.type) ? literals[entry.value].value : none;
+}
+
+const Token *TokenStream::token(size_t i, Arena &arena) const {
+  return arena.make<Token>(tokens[i].type, lexeme(i), tokens[i].line);
+}
 
 std::string tokenTypeToString(TokenType type) {
   switch (type) {
@@ -29,6 +139,18 @@ std::string tokenTypeToString(TokenType type) {
     return "XNOR";
   case TokenType::PRINT:
     return "PRINT";
+  case TokenType::TRUTH_TABLE:
+    return "TRUTH_TABLE";
+  case TokenType::REGISTER:
+    return "REGISTER";
+  case TokenType::SIMULATE:
+    return "SIMULATE";
+  case TokenType::BDD:
+    return "BDD";
+  case TokenType::EQUIV:
+    return "EQUIV";
+  case TokenType::MINIMIZE:
+    return "MINIMIZE";
   case TokenType::RETURN:
     return "RETURN";
   case TokenType::BIT:
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "Arena.h"
+#include "WordBuffer.h"
+
 enum class TokenType {
   // Single-character tok.
   LEFT_PAREN,
@@ -25,6 +34,12 @@ enum class TokenType {
   BIT,
   BIT_VECTOR,
   CIRCUIT,
+  TRUTH_TABLE,
+  REGISTER,
+  SIMULATE,
+  BDD,
+  EQUIV,
+  MINIMIZE,
   TRUE,
   FALSE,
 
@@ -33,20 +48,100 @@ enum class TokenType {
 
 std::ostream &operator<<(std::ostream &os, const TokenType &type);
 
+// Bits are packed 64 to a word: bit i lives at (words[i / 64] >> (i % 64)).
+// Bits past `width` in the last word are always kept at zero. Values of up to
+// 64 bits are stored inline and never allocate.
 struct literal {
-  bool boolean;
-  std::vector<bool> bits; // For bit vectors
-  bool is_bitvector;      // Flag to indicate if this is a bit vector
+  WordBuffer words;            // Packed bit storage
+  size_t width = 0;            // Number of valid bits
+  bool is_bitvector = false;   // Flag to indicate if this is a bit vector
+
+  static constexpr size_t WORD_BITS = 64;
+
+  static literal fromBit(bool value);
+  static literal filled(size_t width, bool value);
+
+  size_t size() const { return width; }
+  size_t wordCount() const { return words.size(); }
+  bool getBit(size_t i) const {
+    return (words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+  }
+  void setBit(size_t i, bool value);
+  void pushBit(bool value);
+  void append(const literal &other);
+  void resize(size_t newWidth);
+  void maskTail();
+
+  // Value of a single-bit literal (first bit, or false when empty)
+  bool asBool() const { return width > 0 && (words[0] & 1); }
 };
 
+// Token kept by the syntax tree. The lexeme is an Interner entry, which
+// lives as long as the process, so tokens can sit in an Arena without ever
+// being destroyed.
 class Token {
 public:
   TokenType type;
-  std::string lexeme;
-  literal lit;
+  const std::string &lexeme;
   int line;
 
   std::string toString();
   void updateLine(int l);
-  Token(TokenType type, std::string lexeme, literal lit, int line);
+  Token(TokenType type, const std::string &lexeme, int line);
+};
+
+// Process-wide table of token spellings. Each distinct spelling is stored
+// once and named by a dense ID, so tokens carry the ID instead of a string.
+class Interner {
+private:
+  std::deque<std::string> texts; // Deque, so views of them stay valid
+  std::unordered_map<std::string_view, uint32_t> ids;
+
+public:
+  static Interner &global();
+
+  uint32_t intern(std::string_view text);
+  const std::string &text(uint32_t id) const { return texts[id]; }
+};
+
+// Scanner output: one flat array of 12-byte tokens. For BOOL and
+// BIT_VECTOR tokens `value` indexes `literals`, which also holds their
+// spelling; for every other token it is the interned lexeme.
+//
+// The parser walks the array by index and only builds a Token for the
+// tokens the syntax tree keeps, such as names and operators.
+struct TokenStream {
+  struct Entry {
+    TokenType type;
+    int line;
+    uint32_t value;
+  };
+
+  struct LiteralEntry {
+    literal value;
+    uint32_t lexeme;
+  };
+
+  // Literals every stream starts with, so the common spellings share them
+  static constexpr uint32_t FALSE_LITERAL = 0; // 0
+  static constexpr uint32_t TRUE_LITERAL = 1;  // 1
+  static constexpr uint32_t EMPTY_LITERAL = 2; // The bit_vector keyword
+
+  std::vector<Entry> tokens;
+  std::vector<LiteralEntry> literals;
+
+  TokenStream();
+
+  static bool hasLiteral(TokenType type) {
+    return type == TokenType::BOOL || type == TokenType::BIT_VECTOR;
+  }
+
+  size_t size() const { return tokens.size(); }
+  const Entry &operator[](size_t i) const { return tokens[i]; }
+
+  const std::string &lexeme(size_t i) const;
+  const literal &value(size_t i) const;
+
+  // Builds a standalone Token in the arena, for the syntax tree to keep
+  const Token *token(size_t i, Arena &arena) const;
 };
@@ -0,0 +1,166 @@
+#include "TruthTable.h"
+
+#include <algorithm>
+
+#include "Elaborator.h"
+
+namespace {
+
+// Bit j of the pattern index within a 64-bit word, for j < 6
+const uint64_t PATTERN_MASKS[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+} // namespace
+
+TruthTable::TruthTable(const Netlist &netlist, ThreadPool &pool)
+    : netlist(netlist), pool(pool), simulators(pool.size()) {}
+
+// Fills `words` with the chunk's outputs: for every group of 64 rows, one
+// word per output
+void TruthTable::evaluateChunk(size_t worker, uint64_t firstRow,
+                               uint64_t rows, std::vector<uint64_t> &words) {
+  if (!simulators[worker]) {
+    simulators[worker] = std::make_unique<BatchSimulator>(netlist, 8);
+  }
+  BatchSimulator &sim = *simulators[worker];
+
+  size_t inputCount = netlist.inputs.size();
+  size_t outputCount = netlist.outputs.size();
+  size_t lanes = sim.laneCount();
+  uint64_t groups = (rows + 63) / 64;
+  words.assign(groups * outputCount, 0);
+
+  for (uint64_t group = 0; group < groups; group += lanes) {
+    uint64_t runRow = firstRow + group * 64;
+
+    for (size_t i = 0; i < inputCount; i++) {
+      size_t bit = inputCount - 1 - i;
+      uint64_t *in = sim.input(i);
+      for (size_t l = 0; l < lanes; l++) {
+        if (bit < 6) {
+          in[l] = PATTERN_MASKS[bit];
+        } else {
+          in[l] = ((runRow + l * 64) >> bit) & 1 ? ~0ULL : 0;
+        }
+      }
+    }
+
+    sim.run();
+
+    size_t lanesUsed = std::min<uint64_t>(lanes, groups - group);
+    for (size_t o = 0; o < outputCount; o++) {
+      const uint64_t *out = sim.output(o);
+      for (size_t l = 0; l < lanesUsed; l++) {
+        words[(group + l) * outputCount + o] = out[l];
+      }
+    }
+  }
+
+  // Fewer than 64 rows in total leaves junk in the top bits
+  if (rows < 64) {
+    for (auto &word : words) {
+      word &= (1ULL << rows) - 1;
+    }
+  }
+}
+
+void TruthTable::writeChunk(std::ostream &os, TableFormat format,
+                            uint64_t firstRow, uint64_t rows,
+                            const std::vector<uint64_t> &words,
+                            std::string &buffer) {
+  if (format == TableFormat::BITMAP) {
+    os.write(reinterpret_cast<const char *>(words.data()),
+             words.size() * sizeof(uint64_t));
+    return;
+  }
+
+  size_t inputCount = netlist.inputs.size();
+  size_t outputCount = netlist.outputs.size();
+
+  buffer.clear();
+  for (uint64_t r = 0; r < rows; r++) {
+    uint64_t row = firstRow + r;
+    for (size_t i = 0; i < inputCount; i++) {
+      buffer += ((row >> (inputCount - 1 - i)) & 1) ? '1' : '0';
+      buffer += ' ';
+    }
+    buffer += '|';
+    for (size_t o = 0; o < outputCount; o++) {
+      uint64_t word = words[(r / 64) * outputCount + o];
+      buffer += ' ';
+      buffer += ((word >> (r % 64)) & 1) ? '1' : '0';
+    }
+    buffer += '\n';
+  }
+  os.write(buffer.data(), buffer.size());
+}
+
+void TruthTable::write(std::ostream &os, TableFormat format) {
+  if (format == TableFormat::TEXT) {
+    std::string header;
+    for (const auto &name : netlist.inputNames) {
+      header += name + " ";
+    }
+    header += "|";
+    for (size_t o = 0; o < netlist.outputs.size(); o++) {
+      header += " out" + std::to_string(o);
+    }
+    os << header << '\n';
+  }
+
+  uint64_t total = rowCount();
+  uint64_t chunkRows = std::min<uint64_t>(total, 1ULL << CHUNK_BITS);
+  uint64_t chunkCount = total / chunkRows;
+
+  // Chunks are computed a wave at a time and written in order, so memory
+  // stays bounded no matter how many rows there are
+  size_t wave = pool.size() * 4;
+  std::vector<std::vector<uint64_t>> results(wave);
+  std::string buffer;
+
+  for (uint64_t first = 0; first < chunkCount; first += wave) {
+    uint64_t count = std::min<uint64_t>(wave, chunkCount - first);
+
+    for (uint64_t c = 0; c < count; c++) {
+      uint64_t firstRow = (first + c) * chunkRows;
+      std::vector<uint64_t> &words = results[c];
+      pool.submit([this, firstRow, chunkRows, &words](size_t worker) {
+        evaluateChunk(worker, firstRow, chunkRows, words);
+      });
+    }
+    pool.wait();
+
+    for (uint64_t c = 0; c < count; c++) {
+      writeChunk(os, format, (first + c) * chunkRows, chunkRows, results[c],
+                 buffer);
+    }
+  }
+
+  os.flush();
+}
+
+void writeTruthTable(const SymbolSource &symbols, const Token *name,
+                     TableFormat format, std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = elaborator.elaborate(name);
+
+  if (netlist.isSequential()) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                 "' has registers, so it has no truth table.");
+  }
+  if (netlist.inputs.size() > TruthTable::MAX_INPUTS) {
+    throw RuntimeError(name, "Circuit '" + name->lexeme + "' has " +
+                                 std::to_string(netlist.inputs.size()) +
+                                 " inputs, truth tables support at most " +
+                                 std::to_string(TruthTable::MAX_INPUTS) +
+                                 ".");
+  }
+
+  netlist = cheapestNetlist(std::move(netlist));
+
+  ThreadPool pool;
+  TruthTable table(netlist, pool);
+  table.write(os, format);
+}
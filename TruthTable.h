@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BatchSimulator.h"
+#include "Environment.h"
+#include "Netlist.h"
+#include "ThreadPool.h"
+
+enum class TableFormat {
+  TEXT,   // One line per row: input bits | output bits
+  BITMAP, // Packed words: for every group of 64 rows, one word per output
+};
+
+// Enumerates all 2^n input combinations of a netlist. Rows are numbered with
+// the first input as the most significant bit. The input space is split into
+// chunks that run on the thread pool with the bit-sliced simulator, and
+// finished chunks are written out in row order.
+class TruthTable {
+private:
+  static constexpr unsigned CHUNK_BITS = 16; // Rows per chunk, as a power of 2
+
+  const Netlist &netlist;
+  ThreadPool &pool;
+  std::vector<std::unique_ptr<BatchSimulator>> simulators; // One per worker
+
+  uint64_t rowCount() const { return 1ULL << netlist.inputs.size(); }
+  void evaluateChunk(size_t worker, uint64_t firstRow, uint64_t rows,
+                     std::vector<uint64_t> &words);
+  void writeChunk(std::ostream &os, TableFormat format, uint64_t firstRow,
+                  uint64_t rows, const std::vector<uint64_t> &words,
+                  std::string &buffer);
+
+public:
+  static constexpr unsigned MAX_INPUTS = 48;
+
+  TruthTable(const Netlist &netlist, ThreadPool &pool);
+
+  void write(std::ostream &os, TableFormat format);
+};
+
+// Elaborates the named circuit and writes its truth table
+void writeTruthTable(const SymbolSource &symbols, const Token *name,
+                     TableFormat format, std::ostream &os);
@@ -1,5 +1,6 @@
 
 #include "Utils.h"
+#include <algorithm>
 #include <iostream>
 
 // A helper function to convert TokenType to string for debugging
@@ -29,6 +30,18 @@ std::string debugTokenTypeToString(TokenType type) {
     return "XNOR";
   case TokenType::PRINT:
     return "PRINT";
+  case TokenType::TRUTH_TABLE:
+    return "TRUTH_TABLE";
+  case TokenType::REGISTER:
+    return "REGISTER";
+  case TokenType::SIMULATE:
+    return "SIMULATE";
+  case TokenType::BDD:
+    return "BDD";
+  case TokenType::EQUIV:
+    return "EQUIV";
+  case TokenType::MINIMIZE:
+    return "MINIMIZE";
   case TokenType::RETURN:
     return "RETURN";
   case TokenType::BIT:
@@ -49,18 +62,17 @@ std::string debugTokenTypeToString(TokenType type) {
 }
 
 // Function to print the token stream after scanning
-void printTokenStream(const std::vector<std::shared_ptr<Token>> &tokens) {
+void printTokenStream(const TokenStream &tokens) {
   std::cout << "=== TOKEN STREAM ===" << '\n';
   for (size_t i = 0; i < tokens.size(); i++) {
-    auto token = tokens[i];
-    std::cout << i << ": [" << token->line << "] "
-              << debugTokenTypeToString(token->type) << " '" << token->lexeme
-              << "'" << '\n';
+    std::cout << i << ": [" << tokens[i].line << "] "
+              << debugTokenTypeToString(tokens[i].type) << " '"
+              << tokens.lexeme(i) << "'" << '\n';
   }
   std::cout << "====================" << std::endl;
 }
 
-void printParseResults(const std::vector<std::shared_ptr<Stmt>> &statements) {
+void printParseResults(const std::vector<Stmt *> &statements) {
   std::cout << "=== PARSE STREAM ===" << '\n'
             << statements.size() << " statements" << std::endl;
 
@@ -71,3 +83,74 @@ void printParseResults(const std::vector<std::shared_ptr<Stmt>> &statements) {
   }
   std::cout << "====================" << std::endl;
 }
+
+void printBytecode(const Function &function) {
+  std::cout << "=== BYTECODE " << function.name << " ===" << '\n'
+            << function.arity << " params, " << function.registerCount
+            << " registers" << '\n';
+  for (size_t i = 0; i < function.code.size(); i++) {
+    const Instruction &in = function.code[i];
+    std::cout << i << ": " << in.op << " " << in.a << " " << in.b << " "
+              << in.c << " " << in.n << '\n';
+  }
+  std::cout << "====================" << std::endl;
+}
+
+void printConstantFoldingResults(const ConstantFolder::Stats &stats) {
+  std::cout << "=== CONSTANT FOLDING ===" << '\n';
+  std::cout << "nodes: " << stats.nodesBefore << " -> " << stats.nodesAfter
+            << '\n';
+  std::cout << "statements: " << stats.statementsBefore << " -> "
+            << stats.statementsAfter << '\n';
+  std::cout << "====================" << std::endl;
+}
+
+void printHashConsResults(const std::vector<HashConser::Stats> &stats) {
+  size_t nodes = 0;
+  size_t merged = 0;
+
+  std::cout << "=== HASH-CONSING ===" << '\n';
+  for (const auto &circuit : stats) {
+    std::cout << circuit.circuit << ": merged " << circuit.merged << " of "
+              << circuit.nodes << " nodes" << '\n';
+    nodes += circuit.nodes;
+    merged += circuit.merged;
+  }
+  std::cout << "total: merged " << merged << " of " << nodes << " nodes"
+            << '\n';
+  std::cout << "====================" << std::endl;
+}
+
+void printMemoResults(const std::vector<MemoCache::Stats> &stats) {
+  // A circuit can have several caches, one per definition and evaluator
+  std::vector<MemoCache::Stats> circuits;
+  for (const auto &cache : stats) {
+    auto found = std::find_if(
+        circuits.begin(), circuits.end(),
+        [&](const MemoCache::Stats &c) { return c.circuit == cache.circuit; });
+    if (found == circuits.end()) {
+      circuits.push_back(cache);
+    } else {
+      found->hits += cache.hits;
+      found->misses += cache.misses;
+      found->evictions += cache.evictions;
+    }
+  }
+  std::sort(circuits.begin(), circuits.end(),
+            [](const MemoCache::Stats &a, const MemoCache::Stats &b) {
+              return a.circuit < b.circuit;
+            });
+
+  std::cout << "=== MEMOIZATION ===" << '\n';
+  for (const auto &circuit : circuits) {
+    uint64_t calls = circuit.hits + circuit.misses;
+    std::cout << circuit.circuit << ": " << circuit.hits << " hits, "
+              << circuit.misses << " misses, " << circuit.evictions
+              << " evictions";
+    if (calls > 0) {
+      std::cout << " (" << circuit.hits * 100 / calls << "% hit rate)";
+    }
+    std::cout << '\n';
+  }
+  std::cout << "====================" << std::endl;
+}
@@ -2,6 +2,10 @@
 #pragma once
 
 #include "AstPrinter.h"
+#include "Bytecode.h"
+#include "ConstantFolder.h"
+#include "HashConser.h"
+#include "MemoCache.h"
 #include "Stmt.h"
 #include "Token.h"
 #include <memory>
@@ -10,5 +14,9 @@
 
 // Function declarations
 std::string debugTokenTypeToString(TokenType type);
-void printTokenStream(const std::vector<std::shared_ptr<Token>> &tok);
-void printParseResults(const std::vector<std::shared_ptr<Stmt>> &statements);
+void printTokenStream(const TokenStream &tokens);
+void printParseResults(const std::vector<Stmt *> &statements);
+void printBytecode(const Function &function);
+void printConstantFoldingResults(const ConstantFolder::Stats &stats);
+void printHashConsResults(const std::vector<HashConser::Stats> &stats);
+void printMemoResults(const std::vector<MemoCache::Stats> &stats);
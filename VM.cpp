@@ -0,0 +1,238 @@
+#include "VM.h"
+
+#include <iostream>
+
+#include "Environment.h"
+#include "LiteralOps.h"
+#include "Bdd.h"
+#include "CppEmitter.h"
+#include "CycleSimulator.h"
+#include "Equivalence.h"
+#include "Minimizer.h"
+#include "TruthTable.h"
+#include "VectorSimulator.h"
+#include "Utils.h"
+
+VM::VM() : compiler(module) {}
+
+bool VM::interpret(const std::vector<Stmt *> &statements) {
+  try {
+    for (const auto &stmt : statements) {
+      std::unique_ptr<Function> script = compiler.compileScript(stmt);
+      if (debug && !script->code.empty()) {
+        printBytecode(*script);
+      }
+      execute(*script, 0);
+    }
+  } catch (RuntimeError &error) {
+    frames.clear();
+    std::cerr << "[line " << error.token->line
+              << "] Runtime Error: " << error.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void VM::executeStmt(Stmt *stmt) {
+  frames.clear();
+  std::unique_ptr<Function> script = compiler.compileScript(stmt);
+  execute(*script, 0);
+}
+
+literal VM::evaluateExpr(Expr *expr) {
+  frames.clear();
+  std::unique_ptr<Function> script = compiler.compileExpression(expr);
+  return stack[execute(*script, 0)];
+}
+
+const Function &VM::circuitFunction(uint32_t slot) {
+  if (!module.circuits[slot].function) {
+    // Compiling may add circuit slots, so look the entry up again afterwards
+    std::unique_ptr<Function> compiled =
+        compiler.compileCircuit(*module.circuits[slot].definition);
+    if (debug) {
+      printBytecode(*compiled);
+    }
+    module.circuits[slot].function = std::move(compiled);
+  }
+  return *module.circuits[slot].function;
+}
+
+// Value of a name that is not a parameter of the circuit reading it: the
+// innermost caller's parameter of that name, else the global
+const literal &VM::lookup(const Function &function, size_t pc,
+                          uint32_t slot) const {
+  for (size_t f = frames.size(); f-- > 0;) {
+    const std::vector<uint32_t> &slots = frames[f].function->parameterSlots;
+    for (size_t i = slots.size(); i-- > 0;) {
+      if (slots[i] == slot) {
+        return stack[frames[f].base + i];
+      }
+    }
+  }
+
+  if (!module.defined[slot]) {
+    const auto &name = function.tokens[pc];
+    throw RuntimeError(name, "Undefined variable '" + name->lexeme + "'.");
+  }
+  return module.globals[slot];
+}
+
+// Runs a function whose frame starts at `base` and returns the absolute
+// stack index of its result register
+size_t VM::execute(const Function &function, size_t base) {
+  if (stack.size() < base + function.registerCount) {
+    stack.resize(base + function.registerCount);
+  }
+
+  literal *R = stack.data() + base;
+  const Instruction *code = function.code.data();
+  size_t count = function.code.size();
+
+  for (size_t pc = 0; pc < count; pc++) {
+    const Instruction &in = code[pc];
+
+    switch (in.op) {
+    case OpCode::CONST:
+      R[in.a] = function.constants[in.b];
+      break;
+
+    case OpCode::LOAD_GLOBAL:
+      R[in.a] = lookup(function, pc, in.b);
+      break;
+
+    case OpCode::MOVE:
+      R[in.a] = R[in.b];
+      break;
+
+    case OpCode::NOT:
+      R[in.a] = performNot(R[in.b]);
+      break;
+
+    case OpCode::AND:
+      R[in.a] = performAnd(R + in.b, in.n);
+      break;
+
+    case OpCode::OR:
+      R[in.a] = performOr(R + in.b, in.n);
+      break;
+
+    case OpCode::XOR:
+      R[in.a] = performXor(R[in.b], R[in.c]);
+      break;
+
+    case OpCode::XNOR:
+      R[in.a] = performXnor(R[in.b], R[in.c]);
+      break;
+
+    case OpCode::NAND:
+      R[in.a] = performNand(R[in.b], R[in.c]);
+      break;
+
+    case OpCode::NOR:
+      R[in.a] = performNor(R[in.b], R[in.c]);
+      break;
+
+    case OpCode::CONCAT: {
+      literal value;
+      value.is_bitvector = true;
+      for (uint32_t i = 0; i < in.n; i++) {
+        const literal &part = R[in.b + i];
+        if (!part.is_bitvector || part.size() == 0) {
+          throw RuntimeError(function.tokens[pc],
+                             "Invalid value in bit vector definition.");
+        }
+        value.append(part);
+      }
+      R[in.a] = std::move(value);
+      break;
+    }
+
+    case OpCode::CALL: {
+      const CircuitEntry &entry = module.circuits[in.c];
+      const auto &name = function.tokens[pc];
+      if (entry.definition == nullptr) {
+        throw RuntimeError(name, "Undefined circuit '" + name->lexeme + "'.");
+      }
+      if (!entry.definition->registers.empty()) {
+        throw RuntimeError(name, "Circuit '" + name->lexeme +
+                                     "' has registers and can only be "
+                                     "simulated.");
+      }
+      if (entry.definition->parameters.size() != in.n) {
+        throw RuntimeError(
+            name, "Expected " +
+                      std::to_string(entry.definition->parameters.size()) +
+                      " arguments but got " + std::to_string(in.n) + ".");
+      }
+
+      const Function &callee = circuitFunction(in.c);
+      frames.push_back(Frame{&callee, base + in.b});
+      size_t resultIndex = execute(callee, base + in.b);
+      frames.pop_back();
+
+      // The callee may have grown the stack
+      R = stack.data() + base;
+      R[in.a] = stack[resultIndex];
+      break;
+    }
+
+    case OpCode::DEFINE_BIT:
+      if (!R[in.b].is_bitvector || R[in.b].size() != 1) {
+        throw RuntimeError(function.tokens[pc],
+                           "Bit definition requires a bit value.");
+      }
+      module.globals[in.a] = R[in.b];
+      module.defined[in.a] = true;
+      break;
+
+    case OpCode::DEFINE_VECTOR:
+      module.globals[in.a] = R[in.b];
+      module.defined[in.a] = true;
+      break;
+
+    case OpCode::PRINT:
+      std::cout << R[in.a] << std::endl;
+      break;
+
+    case OpCode::TRUTH_TABLE:
+      writeTruthTable(module, function.tokens[pc],
+                      in.a ? TableFormat::BITMAP : TableFormat::TEXT,
+                      std::cout);
+      break;
+
+    case OpCode::SIMULATE_CYCLES:
+      simulateCycles(module, function.tokens[pc],
+                     uint64_t(in.b) << 32 | in.a, simulationMode, std::cout);
+      break;
+
+    case OpCode::SIMULATE:
+      simulateVectors(module, function.tokens[pc], function.files[in.b],
+                      in.a ? TableFormat::BITMAP : TableFormat::TEXT, in.c,
+                      simulationMode, std::cout);
+      break;
+
+    case OpCode::BDD:
+      writeBddReport(module, function.tokens[pc], std::cout);
+      break;
+
+    case OpCode::EQUIV:
+      writeEquivalenceReport(module, function.tokens[pc],
+                             function.circuits[in.a], std::cout);
+      break;
+
+    case OpCode::MINIMIZE:
+      writeMinimizedCircuit(module, function.tokens[pc], std::cout);
+      break;
+
+    case OpCode::EMIT_CPP:
+      writeCppFunction(module, function.tokens[pc], std::cout);
+      break;
+
+    case OpCode::RETURN:
+      return base + in.a;
+    }
+  }
+
+  return base;
+}
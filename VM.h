@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Bytecode.h"
+#include "Compiler.h"
+#include "EventSimulator.h"
+#include "Stmt.h"
+
+// Executes compiled bytecode. Top-level statements are compiled and run one
+// at a time so output and errors appear in the same order as with the
+// tree-walking Evaluator; circuits are compiled once, on their first call.
+class VM {
+private:
+  Module module;
+  Compiler compiler;
+  bool debug = false;
+  SimulationMode simulationMode = SimulationMode::LEVELIZED;
+
+  // Register file shared by all frames. A callee's frame starts at its
+  // first argument register in the caller's frame.
+  std::vector<literal> stack;
+
+  // Circuits being called, innermost last. A name a circuit does not bind
+  // is looked up in its callers' parameters before the globals.
+  struct Frame {
+    const Function *function;
+    size_t base;
+  };
+  std::vector<Frame> frames;
+
+  const literal &lookup(const Function &function, size_t pc,
+                        uint32_t slot) const;
+
+  size_t execute(const Function &function, size_t base);
+  const Function &circuitFunction(uint32_t slot);
+
+public:
+  VM();
+
+  void setDebugMode(bool value) { debug = value; }
+  void setSimulationMode(SimulationMode mode) { simulationMode = mode; }
+  bool interpret(const std::vector<Stmt *> &statements); // False on error
+
+  // Run a single top-level statement or expression, throwing RuntimeError
+  // instead of reporting it
+  void executeStmt(Stmt *stmt);
+  literal evaluateExpr(Expr *expr);
+
+  // Global values and circuits defined so far
+  const SymbolSource &symbols() const { return module; }
+};
@@ -0,0 +1,367 @@
+#include "VectorSimulator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Elaborator.h"
+#include "ThreadPool.h"
+
+VectorSimulator::VectorSimulator(const Netlist &netlist, const Token *name,
+                                 TableFormat format, size_t threads,
+                                 SimulationMode mode)
+    : netlist(netlist), name(name), format(format), threads(threads),
+      prototype(netlist, netlist.isSequential() ||
+                                 mode == SimulationMode::EVENT_DRIVEN
+                             ? 1
+                             : 8),
+      pendingWords(netlist.outputs.size(), 0) {
+  if (mode == SimulationMode::EVENT_DRIVEN) {
+    events = std::make_unique<EventSimulator>(netlist);
+  }
+  if (netlist.isSequential() || events) {
+    this->threads = 1;
+  } else if (this->threads == 0) {
+    this->threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+// Fills `input` with whole lines, starting with the partial line left in
+// `carry` by the previous call and leaving a new one there. Returns false
+// once there is nothing left to read.
+bool VectorSimulator::readChunk(int fd, std::string &input, std::string &carry,
+                                bool &atEnd) const {
+  input.assign(carry);
+  carry.clear();
+
+  size_t lineEnd = input.rfind('\n');
+  while (!atEnd && (input.size() < CHUNK_SIZE || lineEnd == std::string::npos)) {
+    size_t size = input.size();
+    input.resize(size + READ_SIZE);
+    ssize_t count;
+    do {
+      count = read(fd, &input[size], READ_SIZE);
+    } while (count < 0 && errno == EINTR);
+    input.resize(size + (count > 0 ? count : 0));
+
+    if (count <= 0) {
+      atEnd = true;
+    } else {
+      size_t last = input.rfind('\n', input.size() - 1);
+      if (last != std::string::npos && last >= size) {
+        lineEnd = last;
+      }
+    }
+  }
+
+  if (!atEnd) {
+    carry.assign(input, lineEnd + 1, std::string::npos);
+    input.resize(lineEnd + 1);
+  }
+  return !input.empty();
+}
+
+// Parses and simulates one chunk, filling in everything but `ready`
+void VectorSimulator::simulate(BatchSimulator &sim, Chunk &chunk) const {
+  chunk.output.clear();
+  chunk.error.clear();
+  chunk.vectors = 0;
+  chunk.lines = 0;
+
+  size_t inputCount = netlist.inputs.size();
+  std::vector<uint64_t *> inputs(inputCount);
+  for (size_t i = 0; i < inputCount; i++) {
+    inputs[i] = sim.input(i);
+    std::fill(inputs[i], inputs[i] + sim.laneCount(), 0);
+  }
+
+  size_t perRun =
+      netlist.isSequential() || events ? 1 : sim.patternsPerRun();
+  size_t vector = 0; // Vectors in the batch being filled
+  size_t bit = 0;    // Bits read of the current vector
+
+  auto bitCountError = [&]() {
+    return "expected " + std::to_string(inputCount) + " input bits for '" +
+           name->lexeme + "' but got " + std::to_string(bit) + ".";
+  };
+
+  for (char c : chunk.input) {
+    if (c == '0' || c == '1') {
+      if (bit == inputCount) {
+        bit++;
+        chunk.error = bitCountError();
+        break;
+      }
+      inputs[bit][vector / 64] |= uint64_t(c - '0') << (vector % 64);
+      bit++;
+    } else if (c == '\n') {
+      if (bit != 0) {
+        if (bit != inputCount) {
+          chunk.error = bitCountError();
+          break;
+        }
+        bit = 0;
+        if (++vector == perRun) {
+          runBatch(sim, vector, chunk);
+          vector = 0;
+        }
+      }
+      chunk.lines++;
+    } else if (c != ' ' && c != '\t' && c != '\r') {
+      chunk.error = "unexpected character '" + std::string(1, c) + "'.";
+      break;
+    }
+  }
+
+  // The last vector of the input may not end with a newline
+  if (chunk.error.empty() && bit != 0) {
+    if (bit != inputCount) {
+      chunk.error = bitCountError();
+    } else {
+      vector++;
+    }
+  }
+
+  // Bits of a rejected vector sit past `vector` and are never written
+  if (vector > 0) {
+    runBatch(sim, vector, chunk);
+  }
+}
+
+// Simulates the first `count` vectors of the batch, appends their outputs to
+// the chunk and clears the inputs for the next batch
+void VectorSimulator::runBatch(BatchSimulator &sim, size_t count,
+                               Chunk &chunk) const {
+  size_t inputCount = netlist.inputs.size();
+  if (events) {
+    for (size_t i = 0; i < inputCount; i++) {
+      events->setInput(i, sim.input(i)[0] & 1);
+    }
+    events->run();
+  } else {
+    sim.run();
+  }
+  auto output = [&](size_t o) {
+    return events ? events->output(o) : sim.output(o);
+  };
+
+  size_t outputCount = netlist.outputs.size();
+  std::string &buffer = chunk.output;
+  size_t start = buffer.size();
+
+  if (format == TableFormat::BITMAP) {
+    // The batch's bits continue right after the chunk's earlier vectors,
+    // which end part way into a group when batches are shorter than 64
+    size_t groupSize = outputCount * sizeof(uint64_t);
+    size_t groups = (count + 63) / 64;
+    buffer.resize((chunk.vectors + count + 63) / 64 * groupSize);
+    auto merge = [&](size_t group, size_t o, uint64_t bits) {
+      char *at = &buffer[group * groupSize + o * sizeof(uint64_t)];
+      uint64_t word;
+      std::memcpy(&word, at, sizeof(word));
+      word |= bits;
+      std::memcpy(at, &word, sizeof(word));
+    };
+    size_t shift = chunk.vectors % 64;
+    for (size_t g = 0; g < groups; g++) {
+      size_t rows = std::min<size_t>(count - g * 64, 64);
+      uint64_t mask = rows == 64 ? ~0ULL : (1ULL << rows) - 1;
+      size_t group = chunk.vectors / 64 + g;
+      for (size_t o = 0; o < outputCount; o++) {
+        uint64_t word = output(o)[g] & mask;
+        merge(group, o, word << shift);
+        if (shift > 0 && shift + rows > 64) {
+          merge(group + 1, o, word >> (64 - shift));
+        }
+      }
+    }
+  } else {
+    buffer.resize(start + count * (outputCount + 1));
+    char *out = &buffer[start];
+    for (size_t v = 0; v < count; v++) {
+      size_t word = v / 64;
+      size_t shift = v % 64;
+      for (size_t o = 0; o < outputCount; o++) {
+        *out++ = '0' + ((output(o)[word] >> shift) & 1);
+      }
+      *out++ = '\n';
+    }
+  }
+  chunk.vectors += count;
+
+  if (events && netlist.isSequential()) {
+    events->clock();
+  } else if (netlist.isSequential()) {
+    sim.clock();
+  }
+  for (size_t i = 0; i < inputCount; i++) {
+    std::fill(sim.input(i), sim.input(i) + sim.laneCount(), 0);
+  }
+}
+
+// Writes a finished chunk. Returns false if it ends in malformed input.
+bool VectorSimulator::write(const Chunk &chunk) {
+  if (format == TableFormat::TEXT) {
+    os->write(chunk.output.data(), chunk.output.size());
+  } else {
+    // Only the last group of a chunk can be short, so the chunk's groups are
+    // shifted onto whatever the previous chunks left incomplete
+    size_t outputCount = pendingWords.size();
+    const char *words = chunk.output.data();
+    for (size_t first = 0; first < chunk.vectors; first += 64) {
+      size_t bits = std::min<size_t>(chunk.vectors - first, 64);
+      for (size_t o = 0; o < outputCount; o++) {
+        uint64_t word;
+        std::memcpy(&word, words + o * sizeof(word), sizeof(word));
+        pendingWords[o] |= word << pendingBits;
+      }
+
+      if (pendingBits + bits >= 64) {
+        os->write(reinterpret_cast<const char *>(pendingWords.data()),
+                  outputCount * sizeof(uint64_t));
+        for (size_t o = 0; o < outputCount; o++) {
+          uint64_t word;
+          std::memcpy(&word, words + o * sizeof(word), sizeof(word));
+          pendingWords[o] = pendingBits ? word >> (64 - pendingBits) : 0;
+        }
+        pendingBits = pendingBits + bits - 64;
+      } else {
+        pendingBits += bits;
+      }
+      words += outputCount * sizeof(uint64_t);
+    }
+  }
+
+  if (!chunk.error.empty()) {
+    error = "Line " + std::to_string(linesWritten + chunk.lines + 1) +
+            " of the vectors: " + chunk.error;
+    return false;
+  }
+  linesWritten += chunk.lines;
+  return true;
+}
+
+void VectorSimulator::finish() {
+  if (pendingBits > 0) {
+    os->write(reinterpret_cast<const char *>(pendingWords.data()),
+              pendingWords.size() * sizeof(uint64_t));
+  }
+  os->flush();
+
+  if (!error.empty()) {
+    throw RuntimeError(name, error);
+  }
+}
+
+void VectorSimulator::runSerial(int fd) {
+  Chunk chunk;
+  std::string carry;
+  bool atEnd = false;
+  while (readChunk(fd, chunk.input, carry, atEnd)) {
+    simulate(prototype, chunk);
+    if (!write(chunk)) {
+      break;
+    }
+  }
+}
+
+void VectorSimulator::runParallel(int fd) {
+  // Enough slots to keep every worker busy while the oldest chunk finishes.
+  // They are declared before the pool so no worker outlives them.
+  std::vector<Chunk> slots(threads * 4);
+  std::vector<std::unique_ptr<BatchSimulator>> simulators(threads);
+  ThreadPool pool(threads);
+  uint64_t submitted = 0;
+  uint64_t written = 0;
+  bool ok = true;
+
+  // Writes the oldest chunk in flight, waiting for it if `block` is set.
+  // Returns false if it is not finished yet.
+  auto writeOldest = [&](bool block) {
+    Chunk &chunk = slots[written % slots.size()];
+    while (!chunk.ready.load(std::memory_order_acquire)) {
+      if (!block) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    chunk.ready.store(false, std::memory_order_relaxed);
+    ok = write(chunk);
+    written++;
+    return true;
+  };
+
+  std::string carry;
+  bool atEnd = false;
+  while (ok) {
+    if (submitted - written == slots.size()) {
+      writeOldest(true);
+      continue;
+    }
+
+    Chunk &chunk = slots[submitted % slots.size()];
+    if (!readChunk(fd, chunk.input, carry, atEnd)) {
+      break;
+    }
+    pool.submit([this, &chunk, &simulators](size_t worker) {
+      if (!simulators[worker]) {
+        simulators[worker] = std::make_unique<BatchSimulator>(prototype);
+      }
+      simulate(*simulators[worker], chunk);
+      chunk.ready.store(true, std::memory_order_release);
+    });
+    submitted++;
+
+    while (ok && written < submitted && writeOldest(false)) {
+    }
+  }
+
+  while (ok && written < submitted) {
+    writeOldest(true);
+  }
+
+  // After malformed input, chunks still in flight are simulated and dropped
+  pool.wait();
+}
+
+void VectorSimulator::run(int fd, std::ostream &os) {
+  this->os = &os;
+  if (threads == 1) {
+    runSerial(fd);
+  } else {
+    runParallel(fd);
+  }
+  finish();
+}
+
+void simulateVectors(const SymbolSource &symbols, const Token *name,
+                     const std::string &vectors, TableFormat format,
+                     size_t threads, SimulationMode mode, std::ostream &os) {
+  Elaborator elaborator(symbols);
+  Netlist netlist = cheapestNetlist(elaborator.elaborate(name));
+
+  bool isStdin = vectors == "-";
+  int fd = isStdin ? STDIN_FILENO : open(vectors.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw RuntimeError(name,
+                       "Unable to open vector file '" + vectors + "'.");
+  }
+
+  VectorSimulator simulator(netlist, name, format, threads, mode);
+  try {
+    simulator.run(fd, os);
+  } catch (...) {
+    if (!isStdin) {
+      close(fd);
+    }
+    throw;
+  }
+  if (!isStdin) {
+    close(fd);
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BatchSimulator.h"
+#include "Environment.h"
+#include "EventSimulator.h"
+#include "Netlist.h"
+#include "TruthTable.h"
+
+// Runs a netlist on input vectors streamed from a file descriptor.
+//
+// A vector is one line holding a '0' or '1' per input, in parameter order;
+// blanks between the bits and empty lines are ignored. Vectors are packed
+// straight into the bit-sliced simulator as they are parsed, so the netlist
+// is evaluated once per batch of patternsPerRun() vectors, and the outputs
+// are written through a buffer:
+//
+// - TEXT: one line per vector with a '0' or '1' per output
+// - BITMAP: for every group of 64 vectors, one word per output, where bit i
+//   of a word is vector 64 * group + i (the last group is padded with zeros)
+//
+// The input is cut at line ends into chunks that are simulated
+// independently. With more than one thread the chunks run on a thread pool,
+// each worker on its own copy of one compiled simulator, and a ring of slots
+// puts the results back in input order: a worker publishes a finished chunk
+// by setting its slot's flag, and the reading thread writes slots out in
+// sequence as their flags come up.
+//
+// A netlist with registers is clocked once per vector instead, so its
+// vectors run one at a time, in order, on a single thread. So do all vectors
+// in EVENT_DRIVEN mode, where each vector only re-evaluates the gates reached
+// by the inputs that differ from the previous vector.
+class VectorSimulator {
+private:
+  static constexpr size_t CHUNK_SIZE = 1024 * 1024;
+  static constexpr size_t READ_SIZE = 64 * 1024;
+
+  struct Chunk {
+    std::string input; // Whole lines
+    std::string output;
+    size_t vectors = 0; // Vectors in `output`
+    int lines = 0;      // Lines before the end of the chunk or the error
+    std::string error;  // What is wrong with the line after `lines`
+    std::atomic<bool> ready{false};
+  };
+
+  const Netlist &netlist;
+  const Token *name; // Reported with malformed input
+  TableFormat format;
+  size_t threads;
+  BatchSimulator prototype;
+  // With EVENT_DRIVEN, the prototype only holds the parsed input bits
+  std::unique_ptr<EventSimulator> events;
+
+  // Output state, only touched by the thread that reads the input
+  std::ostream *os = nullptr;
+  int linesWritten = 0;
+  std::vector<uint64_t> pendingWords; // BITMAP group not yet complete
+  size_t pendingBits = 0;
+  std::string error;
+
+  bool readChunk(int fd, std::string &input, std::string &carry,
+                 bool &atEnd) const;
+  void simulate(BatchSimulator &sim, Chunk &chunk) const;
+  void runBatch(BatchSimulator &sim, size_t count, Chunk &chunk) const;
+  bool write(const Chunk &chunk);
+  void finish();
+
+  void runSerial(int fd);
+  void runParallel(int fd);
+
+public:
+  // threads == 0 uses one thread per hardware thread
+  VectorSimulator(const Netlist &netlist, const Token *name,
+                  TableFormat format, size_t threads = 1,
+                  SimulationMode mode = SimulationMode::LEVELIZED);
+
+  // Reads vectors until end of input and writes the outputs of each. On
+  // malformed input the vectors before it are still written, then a
+  // RuntimeError is thrown.
+  void run(int fd, std::ostream &os);
+};
+
+// Elaborates the named circuit and simulates it on the vectors in a file,
+// or on stdin when the file name is "-"
+void simulateVectors(const SymbolSource &symbols, const Token *name,
+                     const std::string &vectors, TableFormat format,
+                     size_t threads, SimulationMode mode, std::ostream &os);
@@ -0,0 +1,95 @@
+#include "WordBuffer.h"
+
+#include <algorithm>
+
+WordBuffer::WordBuffer(const WordBuffer &other) : inlineWords{0} {
+  reserve(other.count);
+  std::copy(other.data(), other.data() + other.count, data());
+  count = other.count;
+}
+
+WordBuffer::WordBuffer(WordBuffer &&other) noexcept
+    : count(other.count), capacity(other.capacity) {
+  if (other.isInline()) {
+    std::copy(other.inlineWords, other.inlineWords + INLINE_WORDS,
+              inlineWords);
+  } else {
+    // Steal the heap block and leave the source empty
+    heap = other.heap;
+    other.capacity = INLINE_WORDS;
+    other.inlineWords[0] = 0;
+  }
+  other.count = 0;
+}
+
+WordBuffer &WordBuffer::operator=(const WordBuffer &other) {
+  if (this != &other) {
+    // Reuse the existing block when it is big enough
+    reserve(other.count);
+    std::copy(other.data(), other.data() + other.count, data());
+    count = other.count;
+  }
+  return *this;
+}
+
+WordBuffer &WordBuffer::operator=(WordBuffer &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  if (other.isInline()) {
+    // Copying one inline word is cheaper than giving up our heap block
+    std::copy(other.inlineWords, other.inlineWords + INLINE_WORDS, data());
+  } else {
+    release();
+    heap = other.heap;
+    capacity = other.capacity;
+    other.capacity = INLINE_WORDS;
+    other.inlineWords[0] = 0;
+  }
+  count = other.count;
+  other.count = 0;
+  return *this;
+}
+
+void WordBuffer::reserve(size_t n) {
+  if (n <= capacity) {
+    return;
+  }
+
+  size_t newCapacity = std::max(n, capacity * 2);
+  uint64_t *block = new uint64_t[newCapacity];
+  std::copy(data(), data() + count, block);
+  release();
+  heap = block;
+  capacity = newCapacity;
+}
+
+void WordBuffer::release() {
+  if (!isInline()) {
+    delete[] heap;
+    capacity = INLINE_WORDS;
+    inlineWords[0] = 0;
+  }
+}
+
+void WordBuffer::resize(size_t n, uint64_t value) {
+  reserve(n);
+  if (n > count) {
+    std::fill(data() + count, data() + n, value);
+  }
+  count = n;
+}
+
+void WordBuffer::assign(size_t n, uint64_t value) {
+  reserve(n);
+  std::fill(data(), data() + n, value);
+  count = n;
+}
+
+void WordBuffer::push_back(uint64_t value) {
+  if (count == capacity) {
+    reserve(count + 1);
+  }
+  data()[count++] = value;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Growable array of 64-bit words that keeps a single word inline, so
+// literals of up to 64 bits never touch the heap when they are created,
+// copied or moved.
+class WordBuffer {
+private:
+  static constexpr size_t INLINE_WORDS = 1;
+
+  size_t count = 0;
+  size_t capacity = INLINE_WORDS;
+  union {
+    uint64_t inlineWords[INLINE_WORDS];
+    uint64_t *heap;
+  };
+
+  bool isInline() const { return capacity == INLINE_WORDS; }
+  void reserve(size_t n);
+  void release();
+
+public:
+  WordBuffer() : inlineWords{0} {}
+  WordBuffer(const WordBuffer &other);
+  WordBuffer(WordBuffer &&other) noexcept;
+  WordBuffer &operator=(const WordBuffer &other);
+  WordBuffer &operator=(WordBuffer &&other) noexcept;
+  ~WordBuffer() { release(); }
+
+  uint64_t *data() { return isInline() ? inlineWords : heap; }
+  const uint64_t *data() const { return isInline() ? inlineWords : heap; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  uint64_t &operator[](size_t i) { return data()[i]; }
+  uint64_t operator[](size_t i) const { return data()[i]; }
+  uint64_t &back() { return data()[count - 1]; }
+
+  void resize(size_t n, uint64_t value = 0);
+  void assign(size_t n, uint64_t value);
+  void push_back(uint64_t value);
+};
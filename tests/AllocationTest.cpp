@@ -0,0 +1,90 @@
+// Checks that evaluating circuit calls does not touch the heap once the
+// evaluator has warmed up: one million calls of FULL_ADDER must not make a
+// single allocation beyond those of the first round.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "Evaluator.h"
+#include "Parser.h"
+#include "Scanner.h"
+
+namespace {
+
+size_t allocations = 0;
+
+constexpr size_t EVALUATIONS = 1000000;
+
+const char *SOURCE = R"(
+(circuit FULL_ADDER (a b cin)
+  (xor (xor a b) cin)
+  (or (and a b) (and (xor a b) cin)))
+(FULL_ADDER false false false)
+(FULL_ADDER false false true)
+(FULL_ADDER false true false)
+(FULL_ADDER false true true)
+(FULL_ADDER true false false)
+(FULL_ADDER true false true)
+(FULL_ADDER true true false)
+(FULL_ADDER true true true)
+)";
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, size_t) noexcept { std::free(memory); }
+
+int main() {
+  Scanner scanner(SOURCE);
+  auto tokens = scanner.scanTokens();
+  Arena arena;
+  Parser parser(tokens, arena);
+  std::vector<Stmt *> statements = parser.parse();
+
+  // Defines the circuit and makes every call once
+  Evaluator evaluator;
+  if (!evaluator.evaluate(statements)) {
+    std::cerr << "FAIL: the script did not evaluate\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Expr *> calls;
+  for (Stmt *stmt : statements) {
+    if (auto *expression = dynamic_cast<ExpressionStmt *>(stmt)) {
+      calls.push_back(expression->expression);
+    }
+  }
+
+  literal result;
+  size_t before = allocations;
+  for (size_t i = 0; i < EVALUATIONS; i++) {
+    evaluator.evaluateExpr(calls[i % calls.size()], result);
+  }
+  size_t grown = allocations - before;
+
+  // The last call adds 1 + 1 + 1, and a call returns its last output, the carry
+  if (result.size() != 1 || !result.asBool()) {
+    std::cerr << "FAIL: FULL_ADDER 1 1 1 returned " << result << "\n";
+    return EXIT_FAILURE;
+  }
+  if (grown != 0) {
+    std::cerr << "FAIL: " << grown << " allocations in " << EVALUATIONS
+              << " evaluations of FULL_ADDER\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "PASS: no allocations in " << EVALUATIONS
+            << " evaluations of FULL_ADDER\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,10 @@
+# Writes the C++ function `bex --emit-cpp CIRCUIT SCRIPT` prints to OUTPUT.
+# bex reports runtime errors on stderr, so anything there fails the build.
+execute_process(COMMAND ${BEX} --emit-cpp ${CIRCUIT} ${SCRIPT}
+                OUTPUT_FILE ${OUTPUT}
+                ERROR_VARIABLE errors
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0 OR NOT errors STREQUAL "")
+  file(REMOVE ${OUTPUT})
+  message(FATAL_ERROR "bex --emit-cpp ${CIRCUIT} failed: ${errors}")
+endif()
@@ -0,0 +1,152 @@
+// Checks the C++ that bex --emit-cpp generated for the circuits of
+// emit_cpp.bx, which the build compiled into this program. Every input
+// combination goes through the generated function at once, one per bit of
+// each word, and each output is compared with the circuit's truth table.
+// The last output, which is what a call of the circuit returns, is also
+// compared with the tree-walking Evaluator.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Evaluator.h"
+#include "Parser.h"
+#include "Scanner.h"
+#include "TruthTable.h"
+
+void FULL_ADDER(const uint64_t *in, uint64_t *out);
+void MUX(const uint64_t *in, uint64_t *out);
+void TWO_BIT_ADDER(const uint64_t *in, uint64_t *out);
+
+namespace {
+
+struct Case {
+  const char *name;
+  size_t inputs;
+  size_t outputs;
+  void (*function)(const uint64_t *, uint64_t *);
+};
+
+const Case CASES[] = {
+    {"FULL_ADDER", 3, 2, FULL_ADDER},
+    {"MUX", 3, 3, MUX},
+    {"TWO_BIT_ADDER", 4, 3, TWO_BIT_ADDER},
+};
+
+std::vector<Stmt *> parse(const std::string &source, Arena &arena) {
+  Scanner scanner(source);
+  auto tokens = scanner.scanTokens();
+  Parser parser(tokens, arena);
+  return parser.parse();
+}
+
+// Output bits of every row of the circuit's truth table, in row order
+std::vector<std::string> truthTable(const Evaluator &evaluator,
+                                    const Case &test) {
+  Interner &interner = Interner::global();
+  Token name(TokenType::IDENTIFIER, interner.text(interner.intern(test.name)),
+             0);
+  std::ostringstream table;
+  writeTruthTable(evaluator.symbols(), &name, TableFormat::TEXT, table);
+
+  std::vector<std::string> rows;
+  std::istringstream lines(table.str());
+  std::string line;
+  std::getline(lines, line); // Column names
+  while (std::getline(lines, line)) {
+    std::string bits;
+    for (char c : line.substr(line.find('|') + 1)) {
+      if (c == '0' || c == '1') {
+        bits += c;
+      }
+    }
+    rows.push_back(bits);
+  }
+  return rows;
+}
+
+// Value of a call of the circuit on the given row, on the Evaluator
+bool evaluateCall(Evaluator &evaluator, const Case &test, uint64_t row) {
+  std::string source = "(" + std::string(test.name);
+  for (size_t i = 0; i < test.inputs; i++) {
+    bool bit = (row >> (test.inputs - 1 - i)) & 1;
+    source += bit ? " true" : " false";
+  }
+  source += ")";
+
+  Arena arena;
+  std::vector<Stmt *> statements = parse(source, arena);
+  evaluator.resolve(statements);
+  auto *call = dynamic_cast<ExpressionStmt *>(statements.at(0));
+  return evaluator.evaluateExpr(call->expression).asBool();
+}
+
+bool check(Evaluator &evaluator, const Case &test) {
+  uint64_t rows = 1ULL << test.inputs;
+  std::vector<std::string> table = truthTable(evaluator, test);
+  if (table.size() != rows) {
+    std::cerr << test.name << ": truth table has " << table.size()
+              << " rows\n";
+    return false;
+  }
+
+  // Pattern k is row k, with the first input as the most significant bit
+  std::vector<uint64_t> in(test.inputs, 0);
+  std::vector<uint64_t> out(test.outputs, 0);
+  for (size_t i = 0; i < test.inputs; i++) {
+    for (uint64_t row = 0; row < rows; row++) {
+      in[i] |= ((row >> (test.inputs - 1 - i)) & 1) << row;
+    }
+  }
+  test.function(in.data(), out.data());
+
+  bool ok = true;
+  for (uint64_t row = 0; row < rows; row++) {
+    std::string generated;
+    for (size_t o = 0; o < test.outputs; o++) {
+      generated += char('0' + ((out[o] >> row) & 1));
+    }
+    if (generated != table[row]) {
+      std::cerr << test.name << ": row " << row << " gives " << generated
+                << ", truth table " << table[row] << "\n";
+      ok = false;
+    }
+    if ((generated.back() == '1') != evaluateCall(evaluator, test, row)) {
+      std::cerr << test.name << ": row " << row
+                << " differs from the Evaluator\n";
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  std::ifstream file(EMIT_CPP_SCRIPT);
+  std::stringstream source;
+  source << file.rdbuf();
+
+  Arena arena;
+  std::vector<Stmt *> statements = parse(source.str(), arena);
+  Evaluator evaluator;
+  if (statements.empty() || !evaluator.evaluate(statements)) {
+    std::cerr << "FAIL: " << EMIT_CPP_SCRIPT << " did not evaluate\n";
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+  for (const Case &test : CASES) {
+    ok = check(evaluator, test) && ok;
+  }
+  if (!ok) {
+    std::cerr << "FAIL: generated C++ differs from the interpreter\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "PASS: generated C++ matches the interpreter\n";
+  return EXIT_SUCCESS;
+}